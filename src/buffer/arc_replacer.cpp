@@ -0,0 +1,176 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+#include <string>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_frames)
+    : capacity_(num_frames),
+      position_(num_frames),
+      location_(num_frames, Location::None),
+      page_of_(num_frames, INVALID_PAGE_ID),
+      evictable_(num_frames, false) {}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+
+  if (location_[frame_id] != Location::None) {
+    if (access_type == AccessType::Scan) {
+      // A sequential scan touching a page again says nothing about its reuse; do not promote it.
+      return;
+    }
+    // Cache hit: the page has now been seen at least twice.
+    Unlink(frame_id);
+    position_[frame_id] = t2_.insert(t2_.end(), frame_id);
+    location_[frame_id] = Location::T2;
+    return;
+  }
+
+  // The frame has just been filled, i.e. this is a miss for page_id.
+  page_of_[frame_id] = page_id;
+  bool adapt = page_id != INVALID_PAGE_ID && access_type != AccessType::Scan;
+  size_t b1_size = b1_.Size();
+  size_t b2_size = b2_.Size();
+  if (adapt && b1_.Erase(page_id)) {
+    // Evicted from T1 too early: favour recency.
+    target_t1_ = std::min(capacity_, target_t1_ + std::max<size_t>(1, b2_size / b1_size));
+    position_[frame_id] = t2_.insert(t2_.end(), frame_id);
+    location_[frame_id] = Location::T2;
+  } else if (adapt && b2_.Erase(page_id)) {
+    // Evicted from T2 too early: favour frequency.
+    size_t delta = std::max<size_t>(1, b1_size / b2_size);
+    target_t1_ = target_t1_ > delta ? target_t1_ - delta : 0;
+    position_[frame_id] = t2_.insert(t2_.end(), frame_id);
+    location_[frame_id] = Location::T2;
+  } else {
+    position_[frame_id] = t1_.insert(t1_.end(), frame_id);
+    location_[frame_id] = Location::T1;
+  }
+
+  TrimGhosts();
+}
+
+void ARCReplacer::TrimGhosts() {
+  // Keep the directory bounded: |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c.
+  while (!b1_.Empty() && t1_.size() + b1_.Size() > capacity_) {
+    b1_.PopFront();
+  }
+  while (!b2_.Empty() && t1_.size() + t2_.size() + b1_.Size() + b2_.Size() > 2 * capacity_) {
+    b2_.PopFront();
+  }
+}
+
+void ARCReplacer::SetCapacity(size_t num_frames) {
+  std::unique_lock<std::mutex> lock(latch_);
+  capacity_ = std::min(num_frames, location_.size());
+  target_t1_ = std::min(target_t1_, capacity_);
+  TrimGhosts();
+}
+
+void ARCReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  if (location_[frame_id] == Location::None || evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    num_evictable_++;
+  } else {
+    num_evictable_--;
+  }
+}
+
+auto ARCReplacer::Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &claim) -> bool {
+  std::unique_lock<std::mutex> lock(latch_);
+  if (num_evictable_ == 0) {
+    return false;
+  }
+  // REPLACE(p): take from T1 while it exceeds its target. When the preferred list only holds pinned frames, fall back
+  // to the other one.
+  bool prefer_t1 = !t1_.empty() && t1_.size() > target_t1_;
+  auto *first = prefer_t1 ? &t1_ : &t2_;
+  auto *second = prefer_t1 ? &t2_ : &t1_;
+  if (!EvictFrom(first, frame_id, claim) && !EvictFrom(second, frame_id, claim)) {
+    return false;
+  }
+
+  page_id_t page_id = page_of_[*frame_id];
+  if (page_id != INVALID_PAGE_ID) {
+    (location_[*frame_id] == Location::T1 ? b1_ : b2_).PushBack(page_id);
+  }
+  location_[*frame_id] = Location::None;
+  page_of_[*frame_id] = INVALID_PAGE_ID;
+  return true;
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  if (location_[frame_id] == Location::None) {
+    return;
+  }
+  if (!evictable_[frame_id]) {
+    throw Exception("ARCReplacer: cannot remove a non-evictable frame");
+  }
+  Unlink(frame_id);
+  evictable_[frame_id] = false;
+  num_evictable_--;
+  location_[frame_id] = Location::None;
+  page_of_[frame_id] = INVALID_PAGE_ID;
+}
+
+auto ARCReplacer::Size() -> size_t {
+  std::unique_lock<std::mutex> lock(latch_);
+  return num_evictable_;
+}
+
+auto ARCReplacer::GetTargetT1Size() -> size_t {
+  std::unique_lock<std::mutex> lock(latch_);
+  return target_t1_;
+}
+
+auto ARCReplacer::EvictFrom(std::list<frame_id_t> *list, frame_id_t *frame_id,
+                            const std::function<bool(frame_id_t)> &claim) -> bool {
+  for (frame_id_t fid : *list) {
+    if (!evictable_[fid]) {
+      continue;
+    }
+    evictable_[fid] = false;
+    num_evictable_--;
+    if (claim(fid)) {
+      *frame_id = fid;
+      list->erase(position_[fid]);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ARCReplacer::Unlink(frame_id_t frame_id) {
+  (location_[frame_id] == Location::T1 ? t1_ : t2_).erase(position_[frame_id]);
+}
+
+void ARCReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= location_.size()) {
+    throw Exception("ARCReplacer: invalid frame id " + std::to_string(frame_id));
+  }
+}
+
+}  // namespace bustub
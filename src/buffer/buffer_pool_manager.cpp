@@ -12,8 +12,18 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager.h"
+#include <sys/mman.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
 #include <cstddef>
-#include <mutex>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <new>
 
 #include "common/config.h"
 #include "common/exception.h"
@@ -26,191 +36,890 @@
 
 namespace bustub {
 
+namespace {
+
+using Counter = BufferPoolStatsCollector::Counter;
+using Histogram = BufferPoolStatsCollector::Histogram;
+
+/** Sidecar file of SaveHotPages(): the magic number, the entry count, then the entries. */
+constexpr uint32_t HOT_PAGES_MAGIC = 0x54484250;  // "PBHT"
+
+struct HotPage {
+  page_id_t page_id_;
+  uint32_t num_accesses_;
+};
+
+}  // namespace
+
 BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+                                     LogManager *log_manager, size_t num_shards, size_t max_pool_size)
+    : BufferPoolManager(
+          pool_size, disk_manager,
+          [replacer_k](size_t num_frames) { return std::make_unique<LRUKReplacer>(num_frames, replacer_k); },
+          log_manager, num_shards, max_pool_size) {}
+
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager,
+                                     const ReplacerFactory &replacer_factory, LogManager *log_manager,
+                                     size_t num_shards, size_t max_pool_size)
+    : pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, max_pool_size)),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager) {
   // TODO(students): remove this line after you have implemented the buffer pool manager
   // throw NotImplementedException(
-  //     "BufferPoolManager is not implemented yet. If you have finished implementing BPM, please remove the throw "
-  //     "exception line in `buffer_pool_manager.cpp`.");
+  //     "BufferPoolManager is not implemented yet. If you have implemented it, please remove the throw exception line"
+  //     "in `buffer_pool_manager.cpp`.");
+
+  // we allocate a consecutive memory space for the buffer pool. The data of all frames lives in one page-aligned slab,
+  // so that frames can be the targets of direct I/O; a large slab is also offered to the kernel for huge pages. Room
+  // is made for the largest size the pool may grow to, but the kernel only backs the frames that get touched.
+  frame_data_size_ = std::max<size_t>(1, max_pool_size_) * BUSTUB_PAGE_SIZE;
+  void *slab =
+      mmap(nullptr, frame_data_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (slab == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't allocate the buffer pool");
+  }
+#ifdef MADV_HUGEPAGE
+  if (frame_data_size_ >= HUGE_PAGE_SIZE) {
+    madvise(slab, frame_data_size_, MADV_HUGEPAGE);
+  }
+#endif
+  frame_data_ = static_cast<char *>(slab);
+  pages_ = static_cast<Page *>(::operator new(sizeof(Page) * max_pool_size_));
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    new (&pages_[i]) Page(frame_data_ + i * BUSTUB_PAGE_SIZE);
+  }
+
+  num_shards = std::max<size_t>(1, std::min<size_t>(num_shards, pool_size_));
+  shards_.reserve(num_shards);
+  for (size_t i = 0; i < num_shards; ++i) {
+    shards_.emplace_back(std::make_unique<Shard>());
+  }
+
+  // Frames are dealt out to the shards round-robin. Initially, every frame in use is in the free list of its shard,
+  // and a free (or unused) frame carries a pin count of -1 so that a stale latch-free lookup can never pin it.
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    auto &shard = *shards_[i % num_shards];
+    if (i < pool_size_) {
+      shard.free_list_.emplace_back(static_cast<frame_id_t>(shard.frames_.size()));
+      shard.num_active_++;
+    }
+    shard.frames_.push_back(&pages_[i]);
+    pages_[i].pin_count_ = -1;
+  }
+  for (auto &shard : shards_) {
+    size_t num_frames = shard->frames_.size();
+    shard->page_table_ = std::make_unique<ConcurrentPageTable>(num_frames);
+    shard->replacer_ = replacer_factory(num_frames);
+    if (shard->num_active_ < num_frames) {
+      shard->replacer_->SetCapacity(shard->num_active_);
+    }
+    shard->in_scan_ring_ = std::make_unique<std::atomic<bool>[]>(num_frames);
+    shard->reading_ = std::make_unique<std::atomic<bool>[]>(num_frames);
+    shard->evictable_latches_ = std::make_unique<std::mutex[]>(num_frames);
+    for (size_t i = 0; i < num_frames; ++i) {
+      shard->in_scan_ring_[i] = false;
+      shard->reading_[i] = false;
+    }
+    ResetScanRing(*shard);
+  }
+}
 
-  // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];
-  replacer_ = std::make_unique<LRUKReplacer>(pool_size, replacer_k);
+BufferPoolManager::~BufferPoolManager() {
+  StopPageCleaner();
+  {
+    std::unique_lock<std::mutex> lock(prefetch_latch_);
+    stop_prefetch_ = true;
+  }
+  prefetch_cv_.notify_one();
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.join();
+  }
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    pages_[i].~Page();
+  }
+  ::operator delete(pages_);
+  munmap(frame_data_, frame_data_size_);
+}
 
-  // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_.emplace_back(static_cast<int>(i));
+auto BufferPoolManager::LockShard(Shard &shard) -> std::unique_lock<std::mutex> {
+  std::unique_lock<std::mutex> l(shard.latch_, std::try_to_lock);
+  if (l.owns_lock()) {
+    stats_.Record(Histogram::LATCH_WAIT, 0);
+    return l;
   }
+  auto start = BufferPoolStatsCollector::Clock::now();
+  l.lock();
+  stats_.RecordSince(Histogram::LATCH_WAIT, start);
+  return l;
 }
 
-BufferPoolManager::~BufferPoolManager() { delete[] pages_; }
+void BufferPoolManager::ReadPage(page_id_t page_id, char *page_data) {
+  auto start = BufferPoolStatsCollector::Clock::now();
+  disk_manager_->ReadPage(page_id, page_data);
+  stats_.RecordSince(Histogram::READ, start);
+}
 
-auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
-  std::unique_lock<std::mutex> l(latch_);
-  if (!free_list_.empty()) {
-    // debug(free_list_.size());
-    auto fr = free_list_.front();
-    free_list_.pop_front();
-    *page_id = AllocatePage();
-    page_table_[*page_id] = fr;
-    pages_[fr].pin_count_++;
-    pages_[fr].page_id_ = *page_id;
-    replacer_->RecordAccess(fr);
-    replacer_->SetEvictable(fr, false);
-    return &pages_[fr];
+auto BufferPoolManager::AcquireFrame(Shard &shard, frame_id_t *frame_id, AccessType access_type) -> bool {
+  bool scan = access_type == AccessType::Scan && shard.scan_ring_capacity_ > 0;
+  if (scan && ReuseScanRingFrame(shard, frame_id)) {
+    return true;
   }
+
+  bool acquired = false;
+  if (!shard.free_list_.empty()) {
+    *frame_id = shard.free_list_.front();
+    shard.free_list_.pop_front();
+    acquired = true;
+  }
+  // A latch-free fetch may pin a victim after it became evictable. The replacer then keeps that frame, untouched and
+  // non-evictable until the fetch unpins it, and offers the next victim.
+  auto claim = [&shard](frame_id_t fr) {
+    int expected = 0;
+    return shard.frames_[fr]->pin_count_.compare_exchange_strong(expected, -1);
+  };
+  if (!acquired && shard.replacer_->Evict(frame_id, claim)) {
+    // The frame is ours now: no latch-free fetch can pin it until the pin count is set again.
+    Page *page = shard.frames_[*frame_id];
+    stats_.Add(page->is_dirty_ ? Counter::DIRTY_EVICTION : Counter::CLEAN_EVICTION);
+    ResetFrame(shard, page);
+    acquired = true;
+  }
+  if (!acquired) {
+    return false;
+  }
+
+  shard.in_scan_ring_[*frame_id] = scan;
+  if (scan) {
+    // The ring is either still filling up, or its next frame is pinned or was taken over by point accesses: the new
+    // frame takes that slot.
+    if (shard.scan_ring_.size() < shard.scan_ring_capacity_) {
+      shard.scan_ring_.push_back(*frame_id);
+    } else {
+      frame_id_t replaced = shard.scan_ring_[shard.scan_ring_next_];
+      if (replaced != *frame_id) {
+        shard.in_scan_ring_[replaced] = false;
+      }
+      shard.scan_ring_[shard.scan_ring_next_] = *frame_id;
+      shard.scan_ring_next_ = (shard.scan_ring_next_ + 1) % shard.scan_ring_capacity_;
+    }
+  }
+  return true;
+}
+
+auto BufferPoolManager::ReuseScanRingFrame(Shard &shard, frame_id_t *frame_id) -> bool {
+  if (shard.scan_ring_.size() < shard.scan_ring_capacity_) {
+    return false;
+  }
+  frame_id_t fr = shard.scan_ring_[shard.scan_ring_next_];
+  Page *page = shard.frames_[fr];
+  int expected = 0;
+  if (!shard.in_scan_ring_[fr] || !page->pin_count_.compare_exchange_strong(expected, -1)) {
+    return false;
+  }
+  RemoveFromReplacer(shard, fr);
+  stats_.Add(page->is_dirty_ ? Counter::DIRTY_EVICTION : Counter::CLEAN_EVICTION);
+  ResetFrame(shard, page);
+  shard.scan_ring_next_ = (shard.scan_ring_next_ + 1) % shard.scan_ring_capacity_;
+  *frame_id = fr;
+  return true;
+}
+
+void BufferPoolManager::ResetFrame(Shard &shard, Page *page) {
+  if (page->is_dirty_) {
+    InternalFlushPages(shard, page->page_id_);
+    foreground_writes_++;
+  }
+  shard.page_table_->Erase(page->page_id_);
+  page->ResetMemory();
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+}
+
+void BufferPoolManager::ResetScanRing(Shard &shard) {
+  for (frame_id_t fr : shard.scan_ring_) {
+    shard.in_scan_ring_[fr] = false;
+  }
+  shard.scan_ring_.clear();
+  shard.scan_ring_next_ = 0;
+  // Scans must leave most of the shard to everyone else; tiny shards get no ring at all.
+  size_t ring_per_shard = std::max<size_t>(1, SCAN_RING_SIZE / shards_.size());
+  shard.scan_ring_capacity_ = std::min(ring_per_shard, shard.num_active_ / 4);
+  shard.scan_ring_.reserve(shard.scan_ring_capacity_);
+}
+
+auto BufferPoolManager::Resize(size_t new_size) -> bool {
+  std::scoped_lock resize_lock(resize_latch_);
+  if (new_size < shards_.size() || new_size > max_pool_size_) {
+    return false;
+  }
+  size_t num_shards = shards_.size();
+  bool complete = true;
+  size_t pool_size = 0;
+  for (size_t s = 0; s < num_shards; ++s) {
+    auto &shard = *shards_[s];
+    // The shard owns frames s, s + num_shards, ... of the pool.
+    size_t new_active = (new_size + num_shards - 1 - s) / num_shards;
+    size_t old_active;
+    {
+      auto l = LockShard(shard);
+      old_active = shard.num_active_;
+      if (new_active > old_active) {
+        shard.replacer_->SetCapacity(new_active);
+        for (size_t fr = old_active; fr < new_active; ++fr) {
+          shard.free_list_.emplace_back(static_cast<frame_id_t>(fr));
+        }
+        shard.num_active_ = new_active;
+        ResetScanRing(shard);
+      }
+    }
+    while (shard.num_active_ > new_active) {
+      if (!RetireFrames(shard, new_active)) {
+        complete = false;
+        break;
+      }
+    }
+    if (shard.num_active_ < old_active) {
+      auto l = LockShard(shard);
+      shard.replacer_->SetCapacity(shard.num_active_);
+      ResetScanRing(shard);
+    }
+    pool_size += shard.num_active_;
+  }
+  pool_size_ = pool_size;
+  return complete;
+}
+
+auto BufferPoolManager::RetireFrames(Shard &shard, size_t new_active) -> bool {
+  auto l = LockShard(shard);
+  size_t top = shard.num_active_;
+  size_t bottom = std::max(new_active, top > BUFFER_POOL_RESIZE_BATCH ? top - BUFFER_POOL_RESIZE_BATCH : 0);
+  // Under the latch, a frame with a pin count of -1 is in the free list.
+  size_t fr = top;
+  while (fr > bottom) {
+    Page *page = shard.frames_[fr - 1];
+    int expected = 0;
+    if (page->pin_count_ != -1 && !page->pin_count_.compare_exchange_strong(expected, -1)) {
+      break;
+    }
+    if (page->page_id_ != INVALID_PAGE_ID) {
+      RemoveFromReplacer(shard, static_cast<frame_id_t>(fr - 1));
+      shard.in_scan_ring_[fr - 1] = false;
+      ResetFrame(shard, page);
+    }
+    fr--;
+  }
+  shard.free_list_.remove_if([fr](frame_id_t free_fr) { return static_cast<size_t>(free_fr) >= fr; });
+  shard.num_active_ = fr;
+  l.unlock();
+
+  // Give the memory of the retired frames back; it is zero again whenever the frames come back into use.
+  for (size_t retired = fr; retired < top; ++retired) {
+    madvise(shard.frames_[retired]->GetData(), BUSTUB_PAGE_SIZE, MADV_DONTNEED);
+  }
+  return fr == bottom;
+}
+
+auto BufferPoolManager::TryPinFrame(Shard &shard, frame_id_t frame_id, page_id_t page_id, AccessType access_type)
+    -> bool {
+  Page *page = shard.frames_[frame_id];
+  int pins = page->pin_count_.load();
+  do {
+    if (pins < 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pins, pins + 1));
+
+  // The page table entry may have been stale; the frame is only good if it still holds the page we looked for.
+  if (page->page_id_ != page_id) {
+    UnpinFrame(shard, frame_id, false);
+    return false;
+  }
+  shard.replacer_->RecordAccess(frame_id, access_type, page_id);
+  if (pins == 0) {
+    SyncEvictable(shard, frame_id);
+  }
+  if (access_type != AccessType::Scan && shard.in_scan_ring_[frame_id]) {
+    shard.in_scan_ring_[frame_id] = false;
+  }
+  WaitForRead(shard, frame_id);
+  return true;
+}
+
+void BufferPoolManager::WaitForRead(Shard &shard, frame_id_t frame_id) {
+  // StartRead() takes the write latch before it publishes the frame, and FinishRead() drops it once the page is in.
+  if (shard.reading_[frame_id]) {
+    Page *page = shard.frames_[frame_id];
+    page->RLatch();
+    page->RUnlatch();
+  }
+}
+
+auto BufferPoolManager::UnpinFrame(Shard &shard, frame_id_t frame_id, bool is_dirty) -> bool {
+  Page *page = shard.frames_[frame_id];
+  // Set the dirty flag before dropping the pin so that an evictor that claims the frame sees it.
+  if (is_dirty) {
+    page->is_dirty_ = true;
+  }
+  int pins = page->pin_count_.load();
+  do {
+    if (pins <= 0) {
+      LOG_ERROR("不应该pin count 为0的时候UnpinPage");
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pins, pins - 1));
+
+  if (pins == 1) {
+    SyncEvictable(shard, frame_id);
+  }
+  return true;
+}
+
+void BufferPoolManager::SyncEvictable(Shard &shard, frame_id_t frame_id) {
+  // Pins come and go without any latch, so the updates of two threads can reach the replacer in either order. Each
+  // one sets the flag from the pin count as it is now rather than as it was after its own change: the last update
+  // then always leaves the flag right. A frame that gets a new page goes through here as well, so a late update left
+  // over from its old page cannot make the new one evictable.
+  std::scoped_lock lock(shard.evictable_latches_[frame_id]);
+  int pins = shard.frames_[frame_id]->pin_count_;
+  if (pins >= 0) {
+    shard.replacer_->SetEvictable(frame_id, pins == 0);
+  }
+}
+
+void BufferPoolManager::RemoveFromReplacer(Shard &shard, frame_id_t frame_id) {
+  std::scoped_lock lock(shard.evictable_latches_[frame_id]);
+  // The evictable flag may lag behind the pin count, and the replacer refuses to remove non-evictable frames.
+  shard.replacer_->SetEvictable(frame_id, true);
+  shard.replacer_->Remove(frame_id);
+}
+
+auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
+  // The shard is chosen by page id, so the id has to be allocated before we know which latch to take.
+  page_id_t new_page_id = AllocatePage();
+  auto &shard = ShardOf(new_page_id);
+  auto l = LockShard(shard);
+
   frame_id_t fr = -1;
-  bool res = replacer_->Evict(&fr);
-  if (!res || fr == -1) {
+  if (!AcquireFrame(shard, &fr, AccessType::Unknown)) {
+    stats_.Add(Counter::PIN_WAIT_FAILURE);
+    DeallocatePage(new_page_id);
     *page_id = INVALID_PAGE_ID;
     return nullptr;
   }
 
-  // debug(free_list_.size());
-  // debug(fr);
-  // debug(res);
+  *page_id = new_page_id;
+  Page *page = shard.frames_[fr];
+  page->page_id_ = *page_id;
+  page->pin_count_ = 1;
+  shard.page_table_->Insert(*page_id, fr);
+  shard.replacer_->RecordAccess(fr, AccessType::Unknown, *page_id);
+  SyncEvictable(shard, fr);
+  return page;
+}
+
+auto BufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type) -> Page * {
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  auto &shard = ShardOf(page_id);
+
+  // Hit path: no latch.
+  frame_id_t fr = shard.page_table_->Find(page_id);
+  if (fr != -1 && TryPinFrame(shard, fr, page_id, access_type)) {
+    stats_.Add(Counter::HIT);
+    return shard.frames_[fr];
+  }
 
-  if (pages_[fr].page_id_ != INVALID_PAGE_ID && pages_[fr].is_dirty_) {
-    InternalFlushPages(pages_[fr].page_id_);
+  auto l = LockShard(shard);
+  // Under the latch the page table is exact, and every frame in it has a non-negative pin count.
+  fr = shard.page_table_->Find(page_id);
+  if (fr != -1) {
+    Page *page = shard.frames_[fr];
+    if (page->pin_count_++ == 0) {
+      SyncEvictable(shard, fr);
+    }
+    shard.replacer_->RecordAccess(fr, access_type, page_id);
+    if (access_type != AccessType::Scan) {
+      shard.in_scan_ring_[fr] = false;
+    }
+    stats_.Add(Counter::HIT);
+    // A prefetch may be reading the page, and wants the shard latch for its next page before it finishes this one.
+    l.unlock();
+    WaitForRead(shard, fr);
+    return page;
   }
-  pages_[fr].ResetMemory();
-  pages_[fr].is_dirty_ = false;
-  pages_[fr].pin_count_ = 0;
-  page_table_.erase(pages_[fr].page_id_);
 
-  *page_id = AllocatePage();
-  page_table_[*page_id] = fr;
-  pages_[fr].pin_count_++;
-  pages_[fr].page_id_ = *page_id;
-  replacer_->RecordAccess(fr);
-  replacer_->SetEvictable(fr, false);
-  return &pages_[fr];
+  if (!AcquireFrame(shard, &fr, access_type)) {
+    stats_.Add(Counter::PIN_WAIT_FAILURE);
+    return nullptr;
+  }
+  stats_.Add(Counter::MISS);
+  Page *page = shard.frames_[fr];
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  disk_manager_->AdviseAccess(page_id, access_type);
+  ReadPage(page_id, page->data_);
+  // Publish the frame only once its content is in place: it is not marked as reading_, so the hit path may pin and
+  // return it right after the insert.
+  page->pin_count_ = 1;
+  shard.page_table_->Insert(page_id, fr);
+  shard.replacer_->RecordAccess(fr, access_type, page_id);
+  SyncEvictable(shard, fr);
+  return page;
 }
 
-auto BufferPoolManager::FetchPage(page_id_t page_id, [[maybe_unused]] AccessType access_type) -> Page * {
-  std::unique_lock<std::mutex> l(latch_);
+auto BufferPoolManager::FetchPageIfResident(page_id_t page_id, AccessType access_type) -> Page * {
   if (page_id == INVALID_PAGE_ID) {
     return nullptr;
   }
-  if (page_table_.find(page_id) == page_table_.end()) {
-    // debug(page_id);
-    frame_id_t fr;
-    if (!free_list_.empty()) {
-      fr = free_list_.front();
-      free_list_.pop_front();
-    } else {
-      bool res = replacer_->Evict(&fr);
-      if (!res) {
-        return nullptr;
-      }
+  auto &shard = ShardOf(page_id);
+  frame_id_t fr = shard.page_table_->Find(page_id);
+  if (fr != -1 && TryPinFrame(shard, fr, page_id, access_type)) {
+    return shard.frames_[fr];
+  }
+  return nullptr;
+}
 
-      // debug(free_list_.size());
-      // debug(fr);
-      // debug(res);
+void BufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type) {
+  std::unique_lock<std::mutex> lock(prefetch_latch_);
+  for (page_id_t page_id : page_ids) {
+    if (prefetch_queue_.size() >= pool_size_.load()) {
+      break;
     }
+    if (page_id != INVALID_PAGE_ID && ShardOf(page_id).page_table_->Find(page_id) == -1) {
+      prefetch_queue_.emplace_back(page_id, access_type);
+    }
+  }
+  if (prefetch_queue_.empty()) {
+    return;
+  }
+  if (!prefetch_thread_.joinable()) {
+    prefetch_thread_ = std::thread(&BufferPoolManager::RunPrefetcher, this);
+  }
+  lock.unlock();
+  prefetch_cv_.notify_one();
+}
 
-    if (pages_[fr].is_dirty_) {
-      InternalFlushPages(pages_[fr].page_id_);
+void BufferPoolManager::RunPrefetcher() {
+  std::vector<std::pair<page_id_t, AccessType>> batch;
+  std::unique_lock<std::mutex> lock(prefetch_latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [&] { return stop_prefetch_ || !prefetch_queue_.empty(); });
+    if (stop_prefetch_) {
+      return;
     }
-    page_table_.erase(pages_[fr].page_id_);
-    pages_[fr].ResetMemory();
-    pages_[fr].page_id_ = page_id;
-    pages_[fr].pin_count_ = 1;
-    pages_[fr].is_dirty_ = false;
-    page_table_[page_id] = fr;
-    replacer_->RecordAccess(fr);
-    replacer_->SetEvictable(fr, false);
-    disk_manager_->ReadPage(page_id, pages_[fr].data_);
-    return &pages_[page_table_[page_id]];
+    // Every page of a batch holds a pinned frame until its read is done; leave most of the pool to everyone else.
+    size_t batch_size = std::clamp<size_t>(pool_size_ / 4, 1, PREFETCH_BATCH_SIZE);
+    auto batch_end = prefetch_queue_.begin() + std::min(prefetch_queue_.size(), batch_size);
+    batch.assign(prefetch_queue_.begin(), batch_end);
+    prefetch_queue_.erase(prefetch_queue_.begin(), batch_end);
+    lock.unlock();
+    PrefetchBatch(batch);
+    lock.lock();
   }
-  // debug(page_table_[page_id]);
-  replacer_->RecordAccess(page_table_[page_id]);
-  replacer_->SetEvictable(page_table_[page_id], false);
-  pages_[page_table_[page_id]].pin_count_++;
-  return &pages_[page_table_[page_id]];
 }
 
-auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type) -> bool {
-  std::unique_lock<std::mutex> l(latch_);
-  if (page_table_.find(page_id) != page_table_.end()) {
-    frame_id_t frame_id = page_table_[page_id];
-    if (pages_[frame_id].pin_count_ <= 0) {
-      LOG_ERROR("不应该pin count 为0的时候UnpinPage");
+void BufferPoolManager::PrefetchBatch(const std::vector<std::pair<page_id_t, AccessType>> &batch) {
+  struct Read {
+    Shard *shard_;
+    frame_id_t frame_id_;
+    std::future<void> done_;
+    BufferPoolStatsCollector::Clock::time_point start_;
+  };
+  std::vector<Read> reads;
+  reads.reserve(batch.size());
+  size_t finished = 0;
+  // Reads complete in order with a synchronous disk manager; their pages are handed over right away instead of
+  // staying latched until the whole batch is in.
+  auto finish_reads = [&](bool wait) {
+    for (; finished < reads.size(); ++finished) {
+      auto &read = reads[finished];
+      if (!wait && read.done_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        break;
+      }
+      read.done_.wait();
+      stats_.RecordSince(Histogram::READ, read.start_);
+      FinishRead(*read.shard_, read.frame_id_);
+    }
+  };
+
+  // Issue the whole batch before waiting for any of it, so that a disk manager with an I/O queue overlaps the reads.
+  for (auto [page_id, access_type] : batch) {
+    auto &shard = ShardOf(page_id);
+    frame_id_t fr = -1;
+    // Fetches of other pages of the shard must not wait for a read that nobody has asked for yet: the frame is claimed
+    // under the latch and read without it.
+    {
+      auto l = LockShard(shard);
+      if (shard.page_table_->Find(page_id) != -1 || !AcquireFrame(shard, &fr, access_type)) {
+        continue;
+      }
+      StartRead(shard, fr, page_id, access_type);
+    }
+    disk_manager_->AdviseAccess(page_id, access_type);
+    auto start = BufferPoolStatsCollector::Clock::now();
+    reads.push_back({&shard, fr, disk_manager_->ReadPageAsync(page_id, shard.frames_[fr]->data_), start});
+    finish_reads(false);
+  }
+  finish_reads(true);
+}
+
+auto BufferPoolManager::SaveHotPages(const std::string &file_name) -> bool {
+  std::vector<HotPage> hot_pages;
+  for (auto &shard_ptr : shards_) {
+    auto &shard = *shard_ptr;
+    auto l = LockShard(shard);
+    for (size_t fr = 0; fr < shard.num_active_; ++fr) {
+      // Pages are assigned to frames under the latch, so every frame with a pin count of 0 or more holds a page.
+      Page *page = shard.frames_[fr];
+      if (page->pin_count_ < 0 || page->page_id_ == INVALID_PAGE_ID) {
+        continue;
+      }
+      auto num_accesses = shard.replacer_->GetAccessCount(static_cast<frame_id_t>(fr));
+      hot_pages.push_back({page->page_id_, static_cast<uint32_t>(num_accesses)});
+    }
+  }
+  std::stable_sort(hot_pages.begin(), hot_pages.end(),
+                   [](const HotPage &a, const HotPage &b) { return a.num_accesses_ > b.num_accesses_; });
+
+  std::string tmp_name = file_name + ".tmp";
+  {
+    std::ofstream out(tmp_name, std::ios::binary | std::ios::trunc);
+    auto count = static_cast<uint32_t>(hot_pages.size());
+    out.write(reinterpret_cast<const char *>(&HOT_PAGES_MAGIC), sizeof(HOT_PAGES_MAGIC));
+    out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char *>(hot_pages.data()),
+              static_cast<std::streamsize>(hot_pages.size() * sizeof(HotPage)));
+    out.flush();
+    if (!out) {
+      LOG_DEBUG("failed to write hot pages to %s", tmp_name.c_str());
       return false;
     }
-    pages_[frame_id].pin_count_--;
-    if (pages_[frame_id].pin_count_ == 0) {
-      replacer_->SetEvictable(frame_id, true);
+  }
+  return std::rename(tmp_name.c_str(), file_name.c_str()) == 0;
+}
+
+auto BufferPoolManager::LoadHotPages(const std::string &file_name, size_t num_threads) -> size_t {
+  std::ifstream in(file_name, std::ios::binary);
+  uint32_t magic = 0;
+  uint32_t count = 0;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(&count), sizeof(count));
+  if (!in || magic != HOT_PAGES_MAGIC) {
+    return 0;
+  }
+  std::vector<HotPage> hot_pages(std::min<size_t>(count, pool_size_));
+  in.read(reinterpret_cast<char *>(hot_pages.data()), static_cast<std::streamsize>(hot_pages.size() * sizeof(HotPage)));
+  if (!in) {
+    return 0;
+  }
+
+  // Thread t reads pages t, t + num_threads, ..., so all the threads work on the hottest pages first.
+  num_threads = std::clamp<size_t>(num_threads, 1, std::max<size_t>(hot_pages.size(), 1));
+  std::atomic<size_t> loaded{0};
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      for (size_t i = t; i < hot_pages.size(); i += num_threads) {
+        if (PreloadPage(hot_pages[i].page_id_, hot_pages[i].num_accesses_)) {
+          loaded++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return loaded;
+}
+
+auto BufferPoolManager::PreloadPage(page_id_t page_id, size_t num_accesses) -> bool {
+  auto &shard = ShardOf(page_id);
+  auto l = LockShard(shard);
+  if (page_id == INVALID_PAGE_ID || shard.page_table_->Find(page_id) != -1 || shard.free_list_.empty()) {
+    return false;
+  }
+  frame_id_t fr = shard.free_list_.front();
+  shard.free_list_.pop_front();
+  StartRead(shard, fr, page_id, AccessType::Unknown, std::max<size_t>(num_accesses, 1));
+  // The other loader threads, and the fetches, need the shard latch while this one waits on the disk.
+  l.unlock();
+  ReadPage(page_id, shard.frames_[fr]->data_);
+  FinishRead(shard, fr);
+  return true;
+}
+
+void BufferPoolManager::StartRead(Shard &shard, frame_id_t frame_id, page_id_t page_id, AccessType access_type,
+                                  size_t num_accesses) {
+  Page *page = shard.frames_[frame_id];
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  // Nobody else can hold the latch of a frame with a pin count of -1.
+  page->WLatch();
+  shard.reading_[frame_id] = true;
+  for (size_t i = 0; i < num_accesses; ++i) {
+    shard.replacer_->RecordAccess(frame_id, access_type, page_id);
+  }
+  page->pin_count_ = 1;
+  SyncEvictable(shard, frame_id);
+  shard.page_table_->Insert(page_id, frame_id);
+}
+
+void BufferPoolManager::FinishRead(Shard &shard, frame_id_t frame_id) {
+  shard.reading_[frame_id] = false;
+  shard.frames_[frame_id]->WUnlatch();
+  UnpinFrame(shard, frame_id, false);
+}
+
+void BufferPoolManager::StartPageCleaner(double clean_fraction) {
+  std::unique_lock<std::mutex> lock(cleaner_latch_);
+  if (cleaner_thread_.joinable()) {
+    return;
+  }
+  clean_fraction_ = std::clamp(clean_fraction, 0.0, 1.0);
+  stop_cleaner_ = false;
+  cleaner_thread_ = std::thread(&BufferPoolManager::RunPageCleaner, this);
+}
+
+void BufferPoolManager::StopPageCleaner() {
+  std::unique_lock<std::mutex> lock(cleaner_latch_);
+  if (!cleaner_thread_.joinable()) {
+    return;
+  }
+  stop_cleaner_ = true;
+  lock.unlock();
+  cleaner_cv_.notify_one();
+  cleaner_thread_.join();
+}
+
+void BufferPoolManager::RunPageCleaner() {
+  std::unique_lock<std::mutex> lock(cleaner_latch_);
+  while (!cleaner_cv_.wait_for(lock, page_cleaner_interval, [&] { return stop_cleaner_; })) {
+    double clean_fraction = clean_fraction_;
+    lock.unlock();
+    for (auto &shard : shards_) {
+      CleanShard(*shard, clean_fraction);
     }
-    pages_[frame_id].is_dirty_ = is_dirty || pages_[frame_id].is_dirty_;
+    lock.lock();
+  }
+}
 
-    return true;
+void BufferPoolManager::CleanShard(Shard &shard, double clean_fraction) {
+  std::vector<frame_id_t> batch;
+  {
+    auto l = LockShard(shard);
+    size_t unpinned = 0;
+    std::vector<frame_id_t> dirty;
+    for (size_t fr = 0; fr < shard.frames_.size(); ++fr) {
+      Page *page = shard.frames_[fr];
+      if (page->pin_count_ == 0) {
+        unpinned++;
+        if (page->is_dirty_) {
+          dirty.push_back(static_cast<frame_id_t>(fr));
+        }
+      }
+    }
+    auto target_clean = static_cast<size_t>(std::ceil(clean_fraction * static_cast<double>(unpinned)));
+    size_t clean = unpinned - dirty.size();
+    if (clean >= target_clean) {
+      return;
+    }
+    size_t batch_size = std::min({target_clean - clean, dirty.size(), static_cast<size_t>(PAGE_CLEANER_BATCH_SIZE)});
+    // Pin the pages so that they stay put once the latch is dropped. They are not accesses, so the replacer only hears
+    // that the frames are not evictable for now.
+    for (frame_id_t fr : dirty) {
+      if (batch.size() == batch_size) {
+        break;
+      }
+      int expected = 0;
+      if (shard.frames_[fr]->pin_count_.compare_exchange_strong(expected, 1)) {
+        SyncEvictable(shard, fr);
+        batch.push_back(fr);
+      }
+    }
+  }
+
+  // Issue the whole batch before waiting for any of it, so that a disk manager with an I/O queue overlaps the writes.
+  // Each page is written from a copy taken under its read latch: holding the latches of the whole batch until the
+  // writes are done would block writers of those pages for that long, and could deadlock with a writer that latches
+  // two of them in another order.
+  bool check_wal = log_manager_ != nullptr && enable_logging;
+  if (batch.empty()) {
+    return;
+  }
+  // The copies are page-aligned like the frames, so that direct I/O needs no bounce buffers for them.
+  std::unique_ptr<char, decltype(&std::free)> copies(
+      static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, batch.size() * BUSTUB_PAGE_SIZE)), &std::free);
+  std::vector<std::future<void>> writes;
+  for (frame_id_t fr : batch) {
+    Page *page = shard.frames_[fr];
+    char *copy = copies.get() + writes.size() * BUSTUB_PAGE_SIZE;
+    page->RLatch();
+    // The log records describing the page have to reach the disk before the page does.
+    bool write = !check_wal || page->GetLSN() <= log_manager_->GetPersistentLSN();
+    if (write) {
+      // Clear the flag under the latch: a writer that dirties the page again after the copy must not be lost.
+      page->is_dirty_ = false;
+      memcpy(copy, page->GetData(), BUSTUB_PAGE_SIZE);
+    }
+    page->RUnlatch();
+    if (write) {
+      writes.push_back(disk_manager_->WritePageAsync(page->page_id_, copy));
+      background_writes_++;
+    }
+  }
+  for (auto &write : writes) {
+    write.wait();
+  }
+  for (frame_id_t fr : batch) {
+    UnpinFrame(shard, fr, false);
+  }
+}
+
+auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type) -> bool {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  auto &shard = ShardOf(page_id);
+  // The caller holds a pin, so the frame cannot be reassigned under us; only a miss needs the latch.
+  frame_id_t fr = shard.page_table_->Find(page_id);
+  if (fr == -1 || shard.frames_[fr]->page_id_ != page_id) {
+    auto l = LockShard(shard);
+    fr = shard.page_table_->Find(page_id);
+    if (fr == -1) {
+      return false;
+    }
   }
-  return false;
+  return UnpinFrame(shard, fr, is_dirty);
 }
 
 auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
-  std::unique_lock<std::mutex> l(latch_);
-  return InternalFlushPages(page_id);
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  auto &shard = ShardOf(page_id);
+  auto l = LockShard(shard);
+  return InternalFlushPages(shard, page_id);
 }
 
 void BufferPoolManager::FlushAllPages() {
-  std::unique_lock<std::mutex> l(latch_);
-  for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].page_id_ == INVALID_PAGE_ID) {
-      continue;
+  // Pin every resident page so that it stays put once the shard latch is dropped; pages still being read are on disk
+  // already. Consecutive page ids live in different shards, so runs can only be found once all the shards have been
+  // visited.
+  std::vector<std::pair<Shard *, frame_id_t>> resident;
+  for (auto &shard : shards_) {
+    auto l = LockShard(*shard);
+    for (size_t fr = 0; fr < shard->frames_.size(); ++fr) {
+      Page *page = shard->frames_[fr];
+      if (shard->reading_[fr]) {
+        continue;
+      }
+      int pins = page->pin_count_.load();
+      while (pins >= 0 && !page->pin_count_.compare_exchange_weak(pins, pins + 1)) {
+      }
+      if (pins < 0) {
+        continue;
+      }
+      if (pins == 0) {
+        SyncEvictable(*shard, static_cast<frame_id_t>(fr));
+      }
+      resident.emplace_back(shard.get(), static_cast<frame_id_t>(fr));
     }
-    InternalFlushPages(pages_[i].page_id_);
+  }
+  auto page_of = [](const std::pair<Shard *, frame_id_t> &entry) { return entry.first->frames_[entry.second]; };
+  std::sort(resident.begin(), resident.end(),
+            [&](const auto &a, const auto &b) { return page_of(a)->page_id_ < page_of(b)->page_id_; });
+
+  std::vector<const char *> run;
+  for (size_t begin = 0; begin < resident.size(); begin += run.size()) {
+    page_id_t first_page_id = page_of(resident[begin])->page_id_;
+    run.clear();
+    for (size_t i = begin; i < resident.size(); ++i) {
+      Page *page = page_of(resident[i]);
+      if (page->page_id_ != first_page_id + static_cast<page_id_t>(run.size())) {
+        break;
+      }
+      // Clear the flag first: a concurrent unpin that dirties the page again must not be lost.
+      page->is_dirty_ = false;
+      run.push_back(page->GetData());
+    }
+    auto start = BufferPoolStatsCollector::Clock::now();
+    saved_write_calls_ += run.size() - disk_manager_->WritePages(first_page_id, run);
+    stats_.RecordSince(Histogram::WRITE, start);
+  }
+
+  for (auto &[shard, fr] : resident) {
+    UnpinFrame(*shard, fr, false);
   }
 }
-auto BufferPoolManager::InternalFlushPages(page_id_t page_id) -> bool {
-  if (page_table_.find(page_id) != page_table_.end()) {
-    frame_id_t frame_id = page_table_[page_id];
-    disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
-    pages_[frame_id].is_dirty_ = false;
+
+auto BufferPoolManager::InternalFlushPages(Shard &shard, page_id_t page_id) -> bool {
+  frame_id_t fr = shard.page_table_->Find(page_id);
+  if (fr == -1) {
+    return false;
+  }
+  if (shard.reading_[fr]) {
+    // The page is still on its way in from the disk, which holds it already.
     return true;
   }
-  return false;
+  Page *page = shard.frames_[fr];
+  // Clear the flag first: a concurrent unpin that dirties the page again must not be lost.
+  page->is_dirty_ = false;
+  auto start = BufferPoolStatsCollector::Clock::now();
+  disk_manager_->WritePage(page_id, page->GetData());
+  stats_.RecordSince(Histogram::WRITE, start);
+  return true;
 }
 
 auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
-  std::unique_lock<std::mutex> l(latch_);
-  if (page_table_.find(page_id) != page_table_.end()) {
-    frame_id_t frame_id = page_table_[page_id];
-    if (pages_[frame_id].pin_count_ > 0) {
-      LOG_ERROR("删除page时pin不为0 - false!");
-      return false;
-    }
-    replacer_->Remove(frame_id);
-    pages_[frame_id].ResetMemory();
-    pages_[frame_id].page_id_ = INVALID_PAGE_ID;
-    pages_[frame_id].is_dirty_ = false;
-    pages_[frame_id].pin_count_ = 0;
-    free_list_.push_back(frame_id);
+  if (page_id == INVALID_PAGE_ID) {
+    return true;
+  }
+  auto &shard = ShardOf(page_id);
+  auto l = LockShard(shard);
+  frame_id_t fr = shard.page_table_->Find(page_id);
+  if (fr == -1) {
     DeallocatePage(page_id);
-    page_table_.erase(page_id);
     return true;
   }
+  Page *page = shard.frames_[fr];
+  int expected = 0;
+  if (!page->pin_count_.compare_exchange_strong(expected, -1)) {
+    LOG_ERROR("删除page时pin不为0 - false!");
+    return false;
+  }
+  shard.page_table_->Erase(page_id);
+  RemoveFromReplacer(shard, fr);
+  page->ResetMemory();
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  shard.in_scan_ring_[fr] = false;
+  shard.free_list_.push_back(fr);
+  DeallocatePage(page_id);
   return true;
 }
 
-auto BufferPoolManager::AllocatePage() -> page_id_t { return next_page_id_++; }
-
-auto BufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard { return {this, FetchPage(page_id)}; }
+auto BufferPoolManager::FetchPageBasic(page_id_t page_id, AccessType access_type) -> BasicPageGuard {
+  return {this, FetchPage(page_id, access_type)};
+}
 
-auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
-  Page *p = FetchPage(page_id);
+auto BufferPoolManager::FetchPageRead(page_id_t page_id, AccessType access_type) -> ReadPageGuard {
+  Page *p = FetchPage(page_id, access_type);
   p->RLatch();
   return {this, p};
 }
 
-auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
-  Page *p = FetchPage(page_id);
+auto BufferPoolManager::FetchPageWrite(page_id_t page_id, AccessType access_type) -> WritePageGuard {
+  Page *p = FetchPage(page_id, access_type);
   p->WLatch();
   return {this, p};
 }
 
+auto BufferPoolManager::FetchPageOptimistic(page_id_t page_id, AccessType access_type) -> OptimisticReadGuard {
+  return {this, FetchPage(page_id, access_type)};
+}
+
 auto BufferPoolManager::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard { return {this, NewPage(page_id)}; }
 
 }  // namespace bustub
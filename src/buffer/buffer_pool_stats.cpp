@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "fmt/format.h"
+
+namespace bustub {
+
+auto LatencyHistogram::BucketOf(uint64_t value) -> size_t {
+  if (value < SUB_BUCKETS) {
+    return value;
+  }
+  // value lies in [2^msb, 2^(msb+1)), which is split into SUB_BUCKETS buckets by the bits right below the top one.
+  auto msb = static_cast<size_t>(63 - __builtin_clzll(value));
+  size_t shift = msb - SUB_BUCKET_BITS;
+  return (shift + 1) * SUB_BUCKETS + ((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+auto LatencyHistogram::BucketUpperBound(size_t bucket) -> uint64_t {
+  if (bucket < SUB_BUCKETS) {
+    return bucket;
+  }
+  size_t shift = bucket / SUB_BUCKETS - 1;
+  uint64_t lower = static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+  return lower + ((static_cast<uint64_t>(1) << shift) - 1);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram &other) {
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    buckets_[i] += other.buckets_[i];
+  }
+  count_ += other.count_;
+  sum_ += other.sum_;
+}
+
+auto LatencyHistogram::Percentile(double percentile) const -> uint64_t {
+  if (count_ == 0) {
+    return 0;
+  }
+  // The rank of the value we are after, counting from 1.
+  auto rank = static_cast<uint64_t>(std::ceil(percentile / 100 * static_cast<double>(count_)));
+  rank = std::clamp<uint64_t>(rank, 1, count_);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      return BucketUpperBound(i);
+    }
+  }
+  return BucketUpperBound(NUM_BUCKETS - 1);
+}
+
+auto BufferPoolStats::ToString() const -> std::string {
+  auto histogram = [](const char *name, const LatencyHistogram &h) {
+    return fmt::format("{:<13} count={:<10} mean={:<10.3f} p50={:<10.3f} p99={:<10.3f} p99.9={:<10.3f} max={:.3f}\n",
+                       name, h.Count(), h.Mean() / 1000, static_cast<double>(h.Percentile(50)) / 1000,
+                       static_cast<double>(h.Percentile(99)) / 1000, static_cast<double>(h.Percentile(99.9)) / 1000,
+                       static_cast<double>(h.Max()) / 1000);
+  };
+  return fmt::format("hits={} misses={} hit_ratio={:.4f} clean_evictions={} dirty_evictions={} pin_wait_failures={}\n",
+                     hits_, misses_, HitRatio(), clean_evictions_, dirty_evictions_, pin_wait_failures_) +
+         histogram("latch_wait_us", latch_wait_) + histogram("read_us", read_latency_) +
+         histogram("write_us", write_latency_);
+}
+
+BufferPoolStatsCollector::BufferPoolStatsCollector() : stripes_(std::make_unique<Stripe[]>(NUM_STRIPES)) { Reset(); }
+
+auto BufferPoolStatsCollector::CurrentStripe() -> Stripe & {
+  static std::atomic<size_t> next_thread{0};
+  thread_local size_t stripe = next_thread.fetch_add(1, std::memory_order_relaxed) % NUM_STRIPES;
+  return stripes_[stripe];
+}
+
+void BufferPoolStatsCollector::Record(Histogram histogram, uint64_t nanos) {
+  auto &stripe = CurrentStripe();
+  auto h = static_cast<size_t>(histogram);
+  stripe.buckets_[h][LatencyHistogram::BucketOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+  stripe.sums_[h].fetch_add(nanos, std::memory_order_relaxed);
+}
+
+auto BufferPoolStatsCollector::Snapshot() const -> BufferPoolStats {
+  std::array<uint64_t, NUM_COUNTERS> counters{};
+  std::array<LatencyHistogram, NUM_HISTOGRAMS> histograms;
+  for (size_t s = 0; s < NUM_STRIPES; ++s) {
+    const auto &stripe = stripes_[s];
+    for (size_t c = 0; c < NUM_COUNTERS; ++c) {
+      counters[c] += stripe.counters_[c].load(std::memory_order_relaxed);
+    }
+    for (size_t h = 0; h < NUM_HISTOGRAMS; ++h) {
+      auto &histogram = histograms[h];
+      for (size_t b = 0; b < LatencyHistogram::NUM_BUCKETS; ++b) {
+        uint64_t count = stripe.buckets_[h][b].load(std::memory_order_relaxed);
+        histogram.buckets_[b] += count;
+        histogram.count_ += count;
+      }
+      histogram.sum_ += stripe.sums_[h].load(std::memory_order_relaxed);
+    }
+  }
+
+  BufferPoolStats stats;
+  stats.hits_ = counters[static_cast<size_t>(Counter::HIT)];
+  stats.misses_ = counters[static_cast<size_t>(Counter::MISS)];
+  stats.clean_evictions_ = counters[static_cast<size_t>(Counter::CLEAN_EVICTION)];
+  stats.dirty_evictions_ = counters[static_cast<size_t>(Counter::DIRTY_EVICTION)];
+  stats.pin_wait_failures_ = counters[static_cast<size_t>(Counter::PIN_WAIT_FAILURE)];
+  stats.latch_wait_ = histograms[static_cast<size_t>(Histogram::LATCH_WAIT)];
+  stats.read_latency_ = histograms[static_cast<size_t>(Histogram::READ)];
+  stats.write_latency_ = histograms[static_cast<size_t>(Histogram::WRITE)];
+  return stats;
+}
+
+void BufferPoolStatsCollector::Reset() {
+  for (size_t s = 0; s < NUM_STRIPES; ++s) {
+    auto &stripe = stripes_[s];
+    for (auto &counter : stripe.counters_) {
+      counter.store(0, std::memory_order_relaxed);
+    }
+    for (auto &buckets : stripe.buckets_) {
+      for (auto &bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+    }
+    for (auto &sum : stripe.sums_) {
+      sum.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+}  // namespace bustub
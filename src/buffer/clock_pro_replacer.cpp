@@ -0,0 +1,261 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer.cpp
+//
+// Identification: src/buffer/clock_pro_replacer.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/clock_pro_replacer.h"
+
+#include <algorithm>
+#include <string>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+ClockProReplacer::ClockProReplacer(size_t num_frames)
+    : capacity_(num_frames),
+      hand_hot_(clock_.end()),
+      hand_cold_(clock_.end()),
+      hand_test_(clock_.end()),
+      position_(num_frames),
+      tracked_(num_frames, false),
+      evictable_(num_frames, false) {}
+
+void ClockProReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  if (tracked_[frame_id]) {
+    // Scans do not set the reference bit, so a scanned page is never promoted to hot.
+    if (access_type != AccessType::Scan) {
+      position_[frame_id]->referenced_ = true;
+    }
+    return;
+  }
+
+  Entry entry{frame_id, page_id, false, false, true};
+  auto remembered = page_id == INVALID_PAGE_ID || access_type == AccessType::Scan ? non_resident_.end()
+                                                                                   : non_resident_.find(page_id);
+  if (remembered != non_resident_.end()) {
+    // Faulted in again within its test period: the reuse distance is short enough for a hot page.
+    cold_target_ = std::min(cold_target_ + 1, MaxColdTarget());
+    Erase(remembered->second);
+    entry.hot_ = true;
+    entry.in_test_ = false;
+  }
+  position_[frame_id] = InsertAtHead(entry);
+  tracked_[frame_id] = true;
+  if (entry.hot_) {
+    num_hot_++;
+    while (num_hot_ + cold_target_ > capacity_) {
+      RunHandHot();
+    }
+  }
+}
+
+void ClockProReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  if (!tracked_[frame_id] || evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    num_evictable_++;
+  } else {
+    num_evictable_--;
+  }
+}
+
+auto ClockProReplacer::Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &claim) -> bool {
+  std::unique_lock<std::mutex> lock(latch_);
+  if (num_evictable_ == 0) {
+    return false;
+  }
+
+  // Every round in which HAND_cold finds no victim demotes one hot page, so an evictable hot frame turns cold after
+  // at most capacity_ rounds.
+  for (size_t round = 0; round <= capacity_; round++) {
+    size_t limit = 2 * clock_.size();
+    for (size_t step = 0; step < limit; step++) {
+      Iterator cur = hand_cold_;
+      hand_cold_ = Next(cur);
+      if (cur->hot_ || cur->frame_id_ == -1 || !evictable_[cur->frame_id_]) {
+        continue;
+      }
+
+      if (cur->referenced_) {
+        cur->referenced_ = false;
+        if (cur->in_test_) {
+          cur->hot_ = true;
+          cur->in_test_ = false;
+          num_hot_++;
+          cold_target_ = std::min(cold_target_ + 1, MaxColdTarget());
+          while (num_hot_ + cold_target_ > capacity_) {
+            RunHandHot();
+          }
+        } else {
+          cur->in_test_ = true;
+          clock_.splice(hand_hot_, clock_, cur);
+        }
+        continue;
+      }
+
+      frame_id_t victim = cur->frame_id_;
+      evictable_[victim] = false;
+      num_evictable_--;
+      if (!claim(victim)) {
+        if (num_evictable_ == 0) {
+          return false;
+        }
+        continue;
+      }
+      tracked_[victim] = false;
+      if (cur->in_test_ && cur->page_id_ != INVALID_PAGE_ID) {
+        // Keep the page on the clock as a non-resident page until its test period is over.
+        auto stale = non_resident_.find(cur->page_id_);
+        if (stale != non_resident_.end()) {
+          Erase(stale->second);
+        }
+        cur->frame_id_ = -1;
+        non_resident_[cur->page_id_] = cur;
+        while (non_resident_.size() > capacity_) {
+          RunHandTest();
+        }
+      } else {
+        Erase(cur);
+      }
+      *frame_id = victim;
+      return true;
+    }
+    RunHandHot();
+  }
+  return false;
+}
+
+void ClockProReplacer::Remove(frame_id_t frame_id) {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  if (!tracked_[frame_id]) {
+    return;
+  }
+  if (!evictable_[frame_id]) {
+    throw Exception("ClockProReplacer: cannot remove a non-evictable frame");
+  }
+  Erase(position_[frame_id]);
+  tracked_[frame_id] = false;
+  evictable_[frame_id] = false;
+  num_evictable_--;
+}
+
+auto ClockProReplacer::Size() -> size_t {
+  std::unique_lock<std::mutex> lock(latch_);
+  return num_evictable_;
+}
+
+void ClockProReplacer::SetCapacity(size_t num_frames) {
+  std::unique_lock<std::mutex> lock(latch_);
+  capacity_ = std::min(num_frames, tracked_.size());
+  cold_target_ = std::min(cold_target_, MaxColdTarget());
+  while (num_hot_ > 0 && num_hot_ + cold_target_ > capacity_) {
+    RunHandHot();
+  }
+  while (non_resident_.size() > capacity_) {
+    RunHandTest();
+  }
+}
+
+auto ClockProReplacer::GetColdTarget() -> size_t {
+  std::unique_lock<std::mutex> lock(latch_);
+  return cold_target_;
+}
+
+auto ClockProReplacer::Next(Iterator it) -> Iterator {
+  ++it;
+  return it == clock_.end() ? clock_.begin() : it;
+}
+
+auto ClockProReplacer::InsertAtHead(const Entry &entry) -> Iterator {
+  if (clock_.empty()) {
+    Iterator it = clock_.insert(clock_.end(), entry);
+    hand_hot_ = hand_cold_ = hand_test_ = it;
+    return it;
+  }
+  return clock_.insert(hand_hot_, entry);
+}
+
+void ClockProReplacer::Erase(Iterator it) {
+  if (clock_.size() == 1) {
+    hand_hot_ = hand_cold_ = hand_test_ = clock_.end();
+  } else {
+    for (auto *hand : {&hand_hot_, &hand_cold_, &hand_test_}) {
+      if (*hand == it) {
+        *hand = Next(it);
+      }
+    }
+  }
+  if (it->frame_id_ == -1) {
+    non_resident_.erase(it->page_id_);
+  }
+  if (it->hot_) {
+    num_hot_--;
+  }
+  clock_.erase(it);
+}
+
+void ClockProReplacer::EndTest(Iterator it) {
+  it->in_test_ = false;
+  // The page was not reused within its test period, so cold pages need less room.
+  cold_target_ = std::max<size_t>(cold_target_ - 1, 1);
+  if (it->frame_id_ == -1) {
+    Erase(it);
+  }
+}
+
+void ClockProReplacer::RunHandHot() {
+  // Two turns: the first clears every reference bit, so the second demotes a hot page if there is any.
+  size_t limit = 2 * clock_.size() + 1;
+  for (size_t step = 0; step < limit && num_hot_ > 0; step++) {
+    Iterator cur = hand_hot_;
+    hand_hot_ = Next(cur);
+    if (cur->hot_) {
+      if (!cur->referenced_) {
+        cur->hot_ = false;
+        num_hot_--;
+        return;
+      }
+      cur->referenced_ = false;
+    } else if (cur->in_test_) {
+      EndTest(cur);
+    }
+  }
+}
+
+void ClockProReplacer::RunHandTest() {
+  size_t limit = clock_.size();
+  for (size_t step = 0; step < limit; step++) {
+    Iterator cur = hand_test_;
+    hand_test_ = Next(cur);
+    if (!cur->hot_ && cur->in_test_) {
+      bool resident = cur->frame_id_ != -1;
+      EndTest(cur);
+      if (!resident) {
+        return;
+      }
+    }
+  }
+}
+
+void ClockProReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= tracked_.size()) {
+    throw Exception("ClockProReplacer: invalid frame id " + std::to_string(frame_id));
+  }
+}
+
+}  // namespace bustub
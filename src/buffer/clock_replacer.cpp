@@ -12,18 +12,108 @@
 
 #include "buffer/clock_replacer.h"
 
+#include <string>
+
+#include "common/exception.h"
+
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : tracked_(num_pages, false), evictable_(num_pages, false), referenced_(num_pages, false), num_pages_(num_pages) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+void ClockReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  if (tracked_[frame_id] && access_type == AccessType::Scan) {
+    return;
+  }
+  tracked_[frame_id] = true;
+  referenced_[frame_id] = true;
+}
+
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  if (!tracked_[frame_id] || evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    num_evictable_++;
+  } else {
+    num_evictable_--;
+  }
+}
+
+auto ClockReplacer::Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &claim) -> bool {
+  std::unique_lock<std::mutex> lock(latch_);
+  if (num_evictable_ == 0) {
+    return false;
+  }
+  // Two full turns are enough: the first one clears every reference bit it passes.
+  for (size_t step = 0; step < 2 * num_pages_; step++) {
+    size_t fid = hand_;
+    hand_ = (hand_ + 1) % num_pages_;
+    if (!evictable_[fid]) {
+      continue;
+    }
+    if (referenced_[fid]) {
+      referenced_[fid] = false;
+      continue;
+    }
+    evictable_[fid] = false;
+    num_evictable_--;
+    if (claim(static_cast<frame_id_t>(fid))) {
+      *frame_id = static_cast<frame_id_t>(fid);
+      tracked_[fid] = false;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  if (!tracked_[frame_id]) {
+    return;
+  }
+  if (!evictable_[frame_id]) {
+    throw Exception("ClockReplacer: cannot remove a non-evictable frame");
+  }
+  tracked_[frame_id] = false;
+  evictable_[frame_id] = false;
+  referenced_[frame_id] = false;
+  num_evictable_--;
+}
+
+auto ClockReplacer::Size() -> size_t {
+  std::unique_lock<std::mutex> lock(latch_);
+  return num_evictable_;
+}
+
+auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return Evict(frame_id); }
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Pin(frame_id_t frame_id) { SetEvictable(frame_id, false); }
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    CheckFrameId(frame_id);
+    if (evictable_[frame_id]) {
+      return;
+    }
+  }
+  RecordAccess(frame_id);
+  SetEvictable(frame_id, true);
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+void ClockReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    throw Exception("ClockReplacer: invalid frame id " + std::to_string(frame_id));
+  }
+}
 
 }  // namespace bustub
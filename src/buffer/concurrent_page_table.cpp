@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// concurrent_page_table.cpp
+//
+// Identification: src/buffer/concurrent_page_table.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/concurrent_page_table.h"
+
+#include "common/exception.h"
+
+namespace bustub {
+
+ConcurrentPageTable::ConcurrentPageTable(size_t num_frames) : bits_(1) {
+  while ((static_cast<size_t>(1) << bits_) < num_frames * 2) {
+    bits_++;
+  }
+  size_t capacity = static_cast<size_t>(1) << bits_;
+  mask_ = capacity - 1;
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(capacity);
+  for (size_t i = 0; i < capacity; i++) {
+    slots_[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+  }
+}
+
+auto ConcurrentPageTable::Find(page_id_t page_id) const -> frame_id_t {
+  size_t i = HomeOf(page_id);
+  for (size_t probes = 0; probes <= mask_; probes++) {
+    uint64_t slot = slots_[i].load(std::memory_order_acquire);
+    if (slot == EMPTY_SLOT) {
+      return -1;
+    }
+    if (PageOf(slot) == page_id) {
+      return FrameOf(slot);
+    }
+    i = (i + 1) & mask_;
+  }
+  return -1;
+}
+
+void ConcurrentPageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  size_t i = HomeOf(page_id);
+  for (size_t probes = 0; probes <= mask_; probes++) {
+    if (slots_[i].load(std::memory_order_relaxed) == EMPTY_SLOT) {
+      slots_[i].store(Pack(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+    i = (i + 1) & mask_;
+  }
+  throw Exception("page table is full");
+}
+
+void ConcurrentPageTable::Erase(page_id_t page_id) {
+  size_t i = HomeOf(page_id);
+  while (true) {
+    uint64_t slot = slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      return;
+    }
+    if (PageOf(slot) == page_id) {
+      break;
+    }
+    i = (i + 1) & mask_;
+  }
+
+  // Backward-shift deletion: pull later entries of the probe run into the hole as long as that does not move them in
+  // front of their home slot.
+  size_t j = i;
+  while (true) {
+    j = (j + 1) & mask_;
+    uint64_t slot = slots_[j].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      break;
+    }
+    size_t home = HomeOf(PageOf(slot));
+    if (((j - home) & mask_) >= ((j - i) & mask_)) {
+      slots_[i].store(slot, std::memory_order_release);
+      i = j;
+    }
+  }
+  slots_[i].store(EMPTY_SLOT, std::memory_order_release);
+}
+
+}  // namespace bustub
@@ -11,230 +11,187 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/lru_k_replacer.h"
-#include <climits>
-#include <cmath>
 #include <cstddef>
+#include <string>
+#include <utility>
 #include "common/config.h"
 #include "common/exception.h"
 
 namespace bustub {
 
-LRUKNode::LRUKNode(size_t k, frame_id_t fid) : k_(k), fid_(fid) {
-  history_.clear();
-  is_evictable_ = false;
-  left_ = nullptr;
-  right_ = nullptr;
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k)
+    : history_(num_frames * k),
+      history_size_(num_frames, 0),
+      history_next_(num_frames, 0),
+      evictable_(num_frames, false),
+      heap_pos_(num_frames, NOT_IN_HEAP),
+      replacer_size_(num_frames),
+      k_(k) {
+  BUSTUB_ASSERT(k > 0, "k of the LRU-K replacer must be positive");
+  heap_.reserve(num_frames);
 }
 
-void LRUKNode::SetIsEvictable(bool f) { is_evictable_ = f; }
-auto LRUKNode::GetIsEvictable() -> bool { return is_evictable_; }
-auto LRUKNode::PushTime(size_t t) -> void {
-  history_.push_back(t);
-  if (history_.size() > k_) {
-    history_.pop_front();
+LRUKReplacer::~LRUKReplacer() = default;
+
+auto LRUKReplacer::Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &claim) -> bool {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (!heap_.empty()) {
+    frame_id_t victim = heap_.front();
+    HeapErase(victim);
+    if (claim(victim)) {
+      ClearFrame(victim);
+      *frame_id = victim;
+      return true;
+    }
+    evictable_[victim] = false;
   }
+  return false;
 }
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {
-  full_k_head_ = new LRUKNode();
-  full_k_tail_ = new LRUKNode();
-  full_k_head_->right_ = full_k_tail_;
-  full_k_tail_->left_ = full_k_head_;
 
-  unfull_k_head_ = new LRUKNode();
-  unfull_k_tail_ = new LRUKNode();
-  unfull_k_head_->right_ = unfull_k_tail_;
-  unfull_k_tail_->left_ = unfull_k_head_;
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  auto fid = static_cast<size_t>(frame_id);
+  if (access_type == AccessType::Scan && history_size_[fid] != 0) {
+    // Repeated touches by a scan are one logical access; counting them would give the page a finite k-distance.
+    return;
+  }
+  current_timestamp_++;
 
-  full_k_node_store_.clear();
-  unfull_k_node_store_.clear();
+  history_[fid * k_ + history_next_[fid]] = current_timestamp_;
+  history_next_[fid] = (history_next_[fid] + 1) % k_;
+  if (history_size_[fid] < k_) {
+    history_size_[fid]++;
+  }
+  // The eviction key of the frame can only have grown, so it may need to move down in the heap.
+  if (heap_pos_[fid] != NOT_IN_HEAP) {
+    SiftDown(heap_pos_[fid]);
+  }
 }
 
-LRUKReplacer::~LRUKReplacer() {
-  for (auto &it : full_k_node_store_) {
-    delete (it.second);
+void LRUKReplacer::SetEvictable(bustub::frame_id_t frame_id, bool set_evictable) {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  auto fid = static_cast<size_t>(frame_id);
+  if (history_size_[fid] == 0 || evictable_[fid] == set_evictable) {
+    return;
   }
-  for (auto &it : unfull_k_node_store_) {
-    delete (it.second);
+  evictable_[fid] = set_evictable;
+  if (set_evictable) {
+    HeapPush(frame_id);
+  } else {
+    HeapErase(frame_id);
   }
-  delete (unfull_k_head_);
-  delete (unfull_k_tail_);
-  delete (full_k_head_);
-  delete (full_k_tail_);
 }
 
-auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
+void LRUKReplacer::Remove(frame_id_t frame_id) {
   std::unique_lock<std::mutex> lock(latch_);
-  current_timestamp_++;
-
-  if (!unfull_k_node_store_.empty()) {
-    for (auto it = unfull_k_head_->right_; it != unfull_k_tail_; it = it->right_) {
-      if (it->GetIsEvictable()) {
-        *frame_id = it->GetFrameId();
-        unfull_k_size_--;
-        curr_size_--;
-        RemoveNode(it);
-        unfull_k_node_store_.erase(*frame_id);
-        delete it;
-        return true;
-      }
-    }
+  CheckFrameId(frame_id);
+  auto fid = static_cast<size_t>(frame_id);
+  if (history_size_[fid] == 0) {
+    return;
   }
-
-  for (auto it = full_k_head_->right_; it != full_k_tail_; it = it->right_) {
-    if (it->GetIsEvictable()) {
-      *frame_id = it->GetFrameId();
-      full_k_size_--;
-      curr_size_--;
-      RemoveNode(it);
-      full_k_node_store_.erase(*frame_id);
-      delete it;
-      return true;
-    }
+  if (!evictable_[fid]) {
+    throw Exception("不是候选键不可淘汰");
   }
-  return false;
+  HeapErase(frame_id);
+  ClearFrame(frame_id);
 }
 
-auto LRUKReplacer::RemoveNode(LRUKNode *node) -> void {
-  LRUKNode *left = node->left_;
-  LRUKNode *right = node->right_;
-  left->right_ = right;
-  right->left_ = left;
+auto LRUKReplacer::Size() -> size_t {
+  std::unique_lock<std::mutex> lock(latch_);
+  return heap_.size();
 }
 
-auto LRUKReplacer::InsertNode(LRUKNode *node1, LRUKNode *node2) -> void {
-  LRUKNode *nxt = node1->right_;
-  node1->right_ = node2;
-  node2->left_ = node1;
-  node2->right_ = nxt;
-  nxt->left_ = node2;
+auto LRUKReplacer::GetAccessCount(frame_id_t frame_id) -> size_t {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  return history_size_[static_cast<size_t>(frame_id)];
 }
 
-void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
-  std::unique_lock<std::mutex> lock(latch_);
-  current_timestamp_++;
-  if ((static_cast<size_t>(frame_id) > (replacer_size_))) {
-    throw Exception("In function RecordAccess ::: frame_id > replacer_size_");
-  }
+auto LRUKReplacer::OldestSlot(frame_id_t frame_id) const -> size_t {
+  auto fid = static_cast<size_t>(frame_id);
+  // Until the ring wraps around the oldest access is in the first slot; afterwards it is the one about to be
+  // overwritten.
+  return fid * k_ + (history_size_[fid] < k_ ? 0 : history_next_[fid]);
+}
 
-  if (full_k_node_store_.count(frame_id) == 0 && unfull_k_node_store_.count(frame_id) == 0) {
-    auto node = new LRUKNode(k_, frame_id);
-    // todo 新建的设置成ture 从某些Test中看，应该是这样的
-    // node->SetIsEvictable(true);
-    // curr_size_++;
-    unfull_k_node_store_[frame_id] = node;
-    InsertNode(unfull_k_tail_->left_, node);
+auto LRUKReplacer::EvictsBefore(frame_id_t a, frame_id_t b) const -> bool {
+  // Frames with less than k accesses have +inf backward k-distance and go first.
+  bool a_full = history_size_[a] == k_;
+  bool b_full = history_size_[b] == k_;
+  if (a_full != b_full) {
+    return !a_full;
   }
+  return history_[OldestSlot(a)] < history_[OldestSlot(b)];
+}
 
-  if (unfull_k_node_store_.count(frame_id) != 0) {
-    LRUKNode *node = unfull_k_node_store_[frame_id];
-    if (node == nullptr) {
-      throw Exception("unfull_k_node_stroe的node为空");
-    }
-    node->PushTime(current_timestamp_);
-    if (node->GetHistorySize() == k_) {
-      unfull_k_size_--;
-      full_k_size_++;
-      RemoveNode(node);
-      int flag = 1;
-      for (auto it = full_k_head_->right_; it != full_k_tail_; it = it->right_) {
-        if (it->history_.front() > node->history_.front()) {
-          InsertNode(it->left_, node);
-          flag = 0;
-          break;
-        }
-      }
-      if (flag != 0) {
-        InsertNode(full_k_tail_->left_, node);
-      }
-
-      unfull_k_node_store_.erase(frame_id);
-      full_k_node_store_[frame_id] = node;
-    }
-  } else if (full_k_node_store_.count(frame_id) != 0) {
-    LRUKNode *node = full_k_node_store_[frame_id];
-    if (node == nullptr) {
-      throw Exception("unfull_k_node_stroe的node2为空");
-    }
-    node->PushTime(current_timestamp_);
-
-    int flag = 1;
-    for (auto it = node->right_; it != full_k_tail_; it = it->right_) {
-      if (it->history_.front() > node->history_.front()) {
-        RemoveNode(node);
-        InsertNode(it->left_, node);
-        flag = 0;
-        break;
-      }
-    }
-    if (flag != 0) {
-      RemoveNode(node);
-      InsertNode(full_k_tail_->left_, node);
-    }
-  }
+void LRUKReplacer::HeapPush(frame_id_t frame_id) {
+  heap_pos_[frame_id] = heap_.size();
+  heap_.push_back(frame_id);
+  SiftUp(heap_.size() - 1);
 }
 
-void LRUKReplacer::SetEvictable(bustub::frame_id_t frame_id, bool set_evictable) {
-  std::unique_lock<std::mutex> lock(latch_);
-  current_timestamp_++;
-  if ((static_cast<size_t>(frame_id) > (replacer_size_))) {
-    throw Exception("异常LUR010");
+void LRUKReplacer::HeapErase(frame_id_t frame_id) {
+  size_t pos = heap_pos_[frame_id];
+  size_t last = heap_.size() - 1;
+  if (pos != last) {
+    HeapSwap(pos, last);
   }
-
-  if (full_k_node_store_.count(frame_id) == 0 && unfull_k_node_store_.count(frame_id) == 0) {
-    return;
+  heap_.pop_back();
+  heap_pos_[frame_id] = NOT_IN_HEAP;
+  if (pos < heap_.size()) {
+    SiftUp(pos);
+    SiftDown(pos);
   }
-  LRUKNode *node = nullptr;
-  if (unfull_k_node_store_.count(frame_id) != 0) {
-    node = unfull_k_node_store_[frame_id];
-    if (node->GetIsEvictable() && !set_evictable) {
-      curr_size_--;
-      node->SetIsEvictable(set_evictable);
-    } else if (!node->GetIsEvictable() && set_evictable) {
-      curr_size_++;
-      node->SetIsEvictable(set_evictable);
-    }
-  } else if (full_k_node_store_.count(frame_id) != 0) {
-    node = full_k_node_store_[frame_id];
-    if (node->GetIsEvictable() && !set_evictable) {
-      curr_size_--;
-      node->SetIsEvictable(set_evictable);
-    } else if (!node->GetIsEvictable() && set_evictable) {
-      curr_size_++;
-      node->SetIsEvictable(set_evictable);
+}
+
+void LRUKReplacer::HeapSwap(size_t i, size_t j) {
+  std::swap(heap_[i], heap_[j]);
+  heap_pos_[heap_[i]] = i;
+  heap_pos_[heap_[j]] = j;
+}
+
+void LRUKReplacer::SiftUp(size_t i) {
+  while (i > 0) {
+    size_t parent = (i - 1) / 2;
+    if (!EvictsBefore(heap_[i], heap_[parent])) {
+      break;
     }
+    HeapSwap(i, parent);
+    i = parent;
   }
 }
 
-void LRUKReplacer::Remove(frame_id_t frame_id) {
-  std::unique_lock<std::mutex> lock(latch_);
-  if (full_k_node_store_.count(frame_id) == 0 && unfull_k_node_store_.count(frame_id) == 0) {
-    return;
-  }
-  if (unfull_k_node_store_.count(frame_id) != 0) {
-    LRUKNode *node = unfull_k_node_store_[frame_id];
-    if (!node->GetIsEvictable()) {
-      throw Exception("不是候选键不可淘汰");
+void LRUKReplacer::SiftDown(size_t i) {
+  while (true) {
+    size_t smallest = i;
+    size_t left = 2 * i + 1;
+    size_t right = left + 1;
+    if (left < heap_.size() && EvictsBefore(heap_[left], heap_[smallest])) {
+      smallest = left;
+    }
+    if (right < heap_.size() && EvictsBefore(heap_[right], heap_[smallest])) {
+      smallest = right;
     }
-    RemoveNode(node);
-    unfull_k_node_store_.erase(frame_id);
-    unfull_k_size_--;
-    delete node;
-  } else if (full_k_node_store_.count(frame_id) != 0) {
-    LRUKNode *node = full_k_node_store_[frame_id];
-    if (!node->GetIsEvictable()) {
-      throw Exception("不可淘汰");
+    if (smallest == i) {
+      return;
     }
-    RemoveNode(node);
-    full_k_node_store_.erase(frame_id);
-    full_k_size_--;
-    delete node;
+    HeapSwap(i, smallest);
+    i = smallest;
   }
-  curr_size_--;
 }
 
-auto LRUKReplacer::Size() -> size_t {
-  std::unique_lock<std::mutex> lock(latch_);
-  return curr_size_;
+void LRUKReplacer::ClearFrame(frame_id_t frame_id) {
+  history_size_[frame_id] = 0;
+  history_next_[frame_id] = 0;
+  evictable_[frame_id] = false;
+}
+
+void LRUKReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_) {
+    throw Exception("LRUKReplacer: invalid frame id " + std::to_string(frame_id));
+  }
 }
 
 }  // namespace bustub
@@ -12,18 +12,106 @@
 
 #include "buffer/lru_replacer.h"
 
+#include <string>
+
+#include "common/exception.h"
+
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages)
+    : position_(num_pages), tracked_(num_pages, false), evictable_(num_pages, false), num_pages_(num_pages) {}
 
 LRUReplacer::~LRUReplacer() = default;
 
-auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+void LRUReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  if (tracked_[frame_id]) {
+    if (access_type == AccessType::Scan) {
+      // Leave scanned pages where they are so a scan cannot refresh them.
+      return;
+    }
+    lru_list_.erase(position_[frame_id]);
+  }
+  tracked_[frame_id] = true;
+  position_[frame_id] = lru_list_.insert(lru_list_.end(), frame_id);
+}
+
+void LRUReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  if (!tracked_[frame_id] || evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    num_evictable_++;
+  } else {
+    num_evictable_--;
+  }
+}
+
+auto LRUReplacer::Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &claim) -> bool {
+  std::unique_lock<std::mutex> lock(latch_);
+  if (num_evictable_ == 0) {
+    return false;
+  }
+  for (auto it = lru_list_.begin(); it != lru_list_.end(); ++it) {
+    if (!evictable_[*it]) {
+      continue;
+    }
+    evictable_[*it] = false;
+    num_evictable_--;
+    if (claim(*it)) {
+      *frame_id = *it;
+      lru_list_.erase(it);
+      tracked_[*frame_id] = false;
+      return true;
+    }
+  }
+  return false;
+}
+
+void LRUReplacer::Remove(frame_id_t frame_id) {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  if (!tracked_[frame_id]) {
+    return;
+  }
+  if (!evictable_[frame_id]) {
+    throw Exception("LRUReplacer: cannot remove a non-evictable frame");
+  }
+  lru_list_.erase(position_[frame_id]);
+  tracked_[frame_id] = false;
+  evictable_[frame_id] = false;
+  num_evictable_--;
+}
+
+auto LRUReplacer::Size() -> size_t {
+  std::unique_lock<std::mutex> lock(latch_);
+  return num_evictable_;
+}
+
+auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { return Evict(frame_id); }
 
-void LRUReplacer::Pin(frame_id_t frame_id) {}
+void LRUReplacer::Pin(frame_id_t frame_id) { SetEvictable(frame_id, false); }
 
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
+void LRUReplacer::Unpin(frame_id_t frame_id) {
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    CheckFrameId(frame_id);
+    if (evictable_[frame_id]) {
+      return;
+    }
+  }
+  RecordAccess(frame_id);
+  SetEvictable(frame_id, true);
+}
 
-auto LRUReplacer::Size() -> size_t { return 0; }
+void LRUReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    throw Exception("LRUReplacer: invalid frame id " + std::to_string(frame_id));
+  }
+}
 
 }  // namespace bustub
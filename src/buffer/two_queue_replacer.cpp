@@ -0,0 +1,158 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.cpp
+//
+// Identification: src/buffer/two_queue_replacer.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+
+#include <algorithm>
+#include <string>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+TwoQueueReplacer::TwoQueueReplacer(size_t num_frames, double kin_ratio, double kout_ratio)
+    : capacity_(num_frames),
+      kin_ratio_(kin_ratio),
+      kout_ratio_(kout_ratio),
+      kin_(std::max<size_t>(1, static_cast<size_t>(static_cast<double>(num_frames) * kin_ratio))),
+      kout_(std::max<size_t>(1, static_cast<size_t>(static_cast<double>(num_frames) * kout_ratio))),
+      position_(num_frames),
+      location_(num_frames, Location::None),
+      page_of_(num_frames, INVALID_PAGE_ID),
+      evictable_(num_frames, false) {}
+
+void TwoQueueReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+
+  switch (location_[frame_id]) {
+    case Location::Am:
+      if (access_type != AccessType::Scan) {
+        am_.splice(am_.end(), am_, position_[frame_id]);
+      }
+      return;
+    case Location::A1In:
+      // Correlated references shortly after the load do not make a page hot.
+      return;
+    case Location::None:
+      break;
+  }
+
+  page_of_[frame_id] = page_id;
+  // A page that a sequential scan brings back is not hot, however recently it was evicted.
+  if (page_id != INVALID_PAGE_ID && access_type != AccessType::Scan && a1out_.Erase(page_id)) {
+    position_[frame_id] = am_.insert(am_.end(), frame_id);
+    location_[frame_id] = Location::Am;
+  } else {
+    position_[frame_id] = a1in_.insert(a1in_.end(), frame_id);
+    location_[frame_id] = Location::A1In;
+  }
+}
+
+void TwoQueueReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  if (location_[frame_id] == Location::None || evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    num_evictable_++;
+  } else {
+    num_evictable_--;
+  }
+}
+
+auto TwoQueueReplacer::Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &claim) -> bool {
+  std::unique_lock<std::mutex> lock(latch_);
+  if (num_evictable_ == 0) {
+    return false;
+  }
+  bool prefer_a1in = a1in_.size() > kin_;
+  auto *first = prefer_a1in ? &a1in_ : &am_;
+  auto *second = prefer_a1in ? &am_ : &a1in_;
+  if (!EvictFrom(first, frame_id, claim) && !EvictFrom(second, frame_id, claim)) {
+    return false;
+  }
+
+  // Only pages leaving A1in are remembered; a page dropping out of Am has had its chance.
+  page_id_t page_id = page_of_[*frame_id];
+  if (location_[*frame_id] == Location::A1In && page_id != INVALID_PAGE_ID) {
+    a1out_.PushBack(page_id);
+    while (a1out_.Size() > kout_) {
+      a1out_.PopFront();
+    }
+  }
+  location_[*frame_id] = Location::None;
+  page_of_[*frame_id] = INVALID_PAGE_ID;
+  return true;
+}
+
+void TwoQueueReplacer::Remove(frame_id_t frame_id) {
+  std::unique_lock<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  if (location_[frame_id] == Location::None) {
+    return;
+  }
+  if (!evictable_[frame_id]) {
+    throw Exception("TwoQueueReplacer: cannot remove a non-evictable frame");
+  }
+  Unlink(frame_id);
+  evictable_[frame_id] = false;
+  num_evictable_--;
+  location_[frame_id] = Location::None;
+  page_of_[frame_id] = INVALID_PAGE_ID;
+}
+
+auto TwoQueueReplacer::Size() -> size_t {
+  std::unique_lock<std::mutex> lock(latch_);
+  return num_evictable_;
+}
+
+auto TwoQueueReplacer::EvictFrom(std::list<frame_id_t> *queue, frame_id_t *frame_id,
+                                 const std::function<bool(frame_id_t)> &claim) -> bool {
+  for (frame_id_t fid : *queue) {
+    if (!evictable_[fid]) {
+      continue;
+    }
+    evictable_[fid] = false;
+    num_evictable_--;
+    if (claim(fid)) {
+      *frame_id = fid;
+      queue->erase(position_[fid]);
+      return true;
+    }
+  }
+  return false;
+}
+
+void TwoQueueReplacer::SetCapacity(size_t num_frames) {
+  std::unique_lock<std::mutex> lock(latch_);
+  capacity_ = std::min(num_frames, location_.size());
+  kin_ = std::max<size_t>(1, static_cast<size_t>(static_cast<double>(capacity_) * kin_ratio_));
+  kout_ = std::max<size_t>(1, static_cast<size_t>(static_cast<double>(capacity_) * kout_ratio_));
+  while (a1out_.Size() > kout_) {
+    a1out_.PopFront();
+  }
+}
+
+void TwoQueueReplacer::Unlink(frame_id_t frame_id) {
+  (location_[frame_id] == Location::A1In ? a1in_ : am_).erase(position_[frame_id]);
+}
+
+void TwoQueueReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= location_.size()) {
+    throw Exception("TwoQueueReplacer: invalid frame id " + std::to_string(frame_id));
+  }
+}
+
+}  // namespace bustub
@@ -19,24 +19,25 @@ void IndexScanExecutor::Init() {
   index_info_ = (exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid()));
   table_info_ = (exec_ctx_->GetCatalog()->GetTable(index_info_->table_name_));
   tree_it_ = (dynamic_cast<BPlusTreeIndexForTwoIntegerColumn *>(index_info_->index_.get()));
-  it_ = (tree_it_->GetBeginIterator());
-  end_it_ = (tree_it_->GetEndIterator());
+  it_ = plan_->reverse_ ? tree_it_->GetReverseBeginIterator() : tree_it_->GetBeginIterator();
+  batch_.clear();
+  batch_index_ = 0;
 }
 
 auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   for (;;) {
-    if (it_ == end_it_) {
-      return false;
+    if (batch_index_ == batch_.size()) {
+      batch_ = it_.NextBatch(INDEX_SCAN_BATCH_SIZE);
+      batch_index_ = 0;
+      if (batch_.empty()) {
+        return false;
+      }
     }
-    auto mapping_type = *it_;
-    RID res_rid = mapping_type.second;
+    RID res_rid = batch_[batch_index_++].second;
     std::pair<TupleMeta, Tuple> res_tuple = table_info_->table_->GetTuple(res_rid);
-    if (res_tuple.first.is_deleted_) {
-      ++it_;
-    } else {
+    if (!res_tuple.first.is_deleted_) {
       *tuple = res_tuple.second;
       *rid = res_rid;
-      ++it_;
       return true;
     }
   }
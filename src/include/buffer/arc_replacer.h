@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <list>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/ghost_list.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy (Megiddo and Modha, FAST '03).
+ *
+ * Resident frames are kept in two LRU lists: T1 for pages seen once since they were loaded, and T2 for pages seen at
+ * least twice. The ids of pages recently evicted from T1 and T2 are remembered in the ghost lists B1 and B2. A page
+ * that comes back while remembered in B1 (resp. B2) grows (resp. shrinks) the target size p of T1, and the victim is
+ * taken from T1 while it is larger than p and from T2 otherwise. Pinned frames are skipped.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new ARCReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit ARCReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ARCReplacer);
+
+  ~ARCReplacer() override = default;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) override;
+  using Replacer::RecordAccess;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  auto Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &claim) -> bool override;
+  using Replacer::Evict;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  void SetCapacity(size_t num_frames) override;
+
+  /** @return the current target size p of T1 */
+  auto GetTargetT1Size() -> size_t;
+
+ private:
+  enum class Location { None, T1, T2 };
+
+  void CheckFrameId(frame_id_t frame_id) const;
+  /** @brief Take the least recently used evictable frame that claim() accepts out of a resident list. */
+  auto EvictFrom(std::list<frame_id_t> *list, frame_id_t *frame_id, const std::function<bool(frame_id_t)> &claim)
+      -> bool;
+  void Unlink(frame_id_t frame_id);
+  /** @brief Forget the oldest ghosts until the directory fits the capacity again. */
+  void TrimGhosts();
+
+  /** Number of frames in use; frame ids range over the size of location_. */
+  size_t capacity_;
+  /** Target size of T1, adapted on ghost hits. */
+  size_t target_t1_{0};
+  /** Resident lists, least recently used first. */
+  std::list<frame_id_t> t1_;
+  std::list<frame_id_t> t2_;
+  GhostList b1_;
+  GhostList b2_;
+  std::vector<std::list<frame_id_t>::iterator> position_;
+  std::vector<Location> location_;
+  std::vector<page_id_t> page_of_;
+  std::vector<bool> evictable_;
+  size_t num_evictable_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
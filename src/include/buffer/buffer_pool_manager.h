@@ -12,12 +12,21 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
 #include <memory>
 #include <mutex>  // NOLINT
-#include <unordered_map>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/concurrent_page_table.h"
 #include "buffer/lru_k_replacer.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
@@ -28,6 +37,28 @@ namespace bustub {
 
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * The pool can be split into several shards. Every page id is mapped to exactly one shard, and each shard owns a
+ * disjoint slice of the frames together with its own page table, free list, replacer and latch. With a single shard
+ * (the default) this is the classic single-latch buffer pool.
+ *
+ * A fetch that hits in the pool does not take the shard latch: the frame is found through a lock-free page table and
+ * pinned with a CAS on its pin count. The latch is only taken on a miss, for eviction, and for page creation/deletion.
+ *
+ * Misses of AccessType::Scan fetches are served from a small ring of frames per shard (SCAN_RING_SIZE frames in
+ * total, at most a quarter of each shard): once the ring is full, a scan recycles its own oldest frame instead of
+ * asking the replacer for a victim, so a sequential scan over a large table cannot flush the working set. A point
+ * access to a page in the ring takes it out of the ring.
+ *
+ * PrefetchPages() hands page ids to a background thread that reads them into unpinned frames, so that a sequential
+ * reader finds them resident by the time it gets there. Likewise, StartPageCleaner() starts a thread that writes dirty
+ * pages back ahead of their eviction.
+ *
+ * Resize() grows or shrinks the pool while it is in use, within the max_pool_size given at construction. Address space
+ * and frame metadata are reserved for max_pool_size frames up front; memory is only used by the frames in use.
+ *
+ * SaveHotPages() and LoadHotPages() carry the contents of the pool across a restart, so that it does not have to warm
+ * up again one miss at a time.
  */
 class BufferPoolManager {
  public:
@@ -37,9 +68,25 @@ class BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the LookBack constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param num_shards the number of partitions of the page table, each guarded by its own latch. It is clamped to
+   * [1, pool_size].
+   * @param max_pool_size the largest size Resize() can grow the pool to, at least pool_size
    */
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                    LogManager *log_manager = nullptr);
+                    LogManager *log_manager = nullptr, size_t num_shards = 1, size_t max_pool_size = 0);
+
+  /**
+   * @brief Creates a new BufferPoolManager with a custom replacement policy.
+   * @param pool_size the size of the buffer pool
+   * @param disk_manager the disk manager
+   * @param replacer_factory builds one replacer per shard, given the number of frames of the shard
+   * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param num_shards the number of partitions of the page table, each guarded by its own latch. It is clamped to
+   * [1, pool_size].
+   * @param max_pool_size the largest size Resize() can grow the pool to, at least pool_size
+   */
+  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, const ReplacerFactory &replacer_factory,
+                    LogManager *log_manager = nullptr, size_t num_shards = 1, size_t max_pool_size = 0);
 
   /**
    * @brief Destroy an existing BufferPoolManager.
@@ -49,9 +96,15 @@ class BufferPoolManager {
   /** @brief Return the size (number of frames) of the buffer pool. */
   auto GetPoolSize() -> size_t { return pool_size_; }
 
+  /** @brief Return the largest size the buffer pool can be resized to. */
+  auto GetMaxPoolSize() -> size_t { return max_pool_size_; }
+
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetPages() -> Page * { return pages_; }
 
+  /** @brief Return the number of shards the buffer pool is partitioned into. */
+  auto GetNumShards() -> size_t { return shards_.size(); }
+
   /**
    * TODO(P1): Add implementation
    *
@@ -115,11 +168,38 @@ class BufferPoolManager {
    * the returned page already has a read or write latch held, respectively.
    *
    * @param page_id, the id of the page to fetch
+   * @param access_type type of access to the page; AccessType::Scan keeps the page in the scan ring
    * @return PageGuard holding the fetched page
    */
-  auto FetchPageBasic(page_id_t page_id) -> BasicPageGuard;
-  auto FetchPageRead(page_id_t page_id) -> ReadPageGuard;
-  auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
+  auto FetchPageBasic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> BasicPageGuard;
+  auto FetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> ReadPageGuard;
+  auto FetchPageWrite(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> WritePageGuard;
+
+  /**
+   * @brief Fetch a page for optimistic reading: the page is pinned but not latched, and the guard snapshots its version
+   * for the reader to validate its reads against, see OptimisticReadGuard.
+   */
+  auto FetchPageOptimistic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> OptimisticReadGuard;
+
+  /**
+   * @brief Fetch a page only if it is already in the buffer pool, without ever reading it from disk or evicting
+   * anything. The lookup takes no latch and may miss a page that is being moved around concurrently.
+   *
+   * @param page_id id of page to be fetched
+   * @param access_type type of access to the page
+   * @return nullptr if the page is not resident, otherwise pointer to the pinned page
+   */
+  auto FetchPageIfResident(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
+
+  /**
+   * @brief Ask the buffer pool to read pages in the background. The pages are loaded into frames like FetchPage()
+   * would, but are left unpinned and evictable. Pages already resident are skipped, and requests beyond what the pool
+   * could hold anyway are dropped: prefetching is a hint and never fails.
+   *
+   * @param page_ids ids of the pages to read, in the order they should be read
+   * @param access_type type of the access the pages are read ahead for
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Unknown);
 
   /**
    * TODO(P1): Add implementation
@@ -149,64 +229,300 @@ class BufferPoolManager {
    * @return false if the page could not be found in the page table, true otherwise
    */
   auto FlushPage(page_id_t page_id) -> bool;
-  auto InternalFlushPages(page_id_t page_id) -> bool;
 
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Flush all the pages in the buffer pool to disk.
+   * @brief Flush all the pages in the buffer pool to disk. Pages with consecutive ids are written together with a
+   * single DiskManager::WritePages() call.
    */
   void FlushAllPages();
 
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Delete a page from the buffer pool. If page_id is not in the buffer pool, do nothing and return true. If the
-   * page is pinned and cannot be deleted, return false immediately.
+   * @brief Delete a page from the buffer pool and give it back to the disk manager for reuse. If page_id is not in the
+   * buffer pool, only deallocate it and return true. If the page is pinned and cannot be deleted, return false
+   * immediately.
    *
    * After deleting the page from the page table, stop tracking the frame in the replacer and add the frame
-   * back to the free list. Also, reset the page's memory and metadata. Finally, you should call DeallocatePage() to
-   * imitate freeing the page on the disk.
+   * back to the free list. Also, reset the page's memory and metadata. Finally, call DeallocatePage() so that a later
+   * NewPage() can reuse the page id and its space on disk.
    *
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
   auto DeletePage(page_id_t page_id) -> bool;
 
+  /**
+   * @brief Start a background thread that writes back dirty, unpinned pages, so that evictions find clean victims and
+   * do not wait on the disk. Every page_cleaner_interval, it writes up to PAGE_CLEANER_BATCH_SIZE pages per shard until
+   * clean_fraction of the unpinned frames of the shard are clean. When logging is enabled, a page is only written once
+   * the log is persistent up to the page LSN. Does nothing if the cleaner is already running.
+   *
+   * @param clean_fraction share of the unpinned frames to keep clean, in [0, 1]
+   */
+  void StartPageCleaner(double clean_fraction = 0.5);
+
+  /** @brief Stop the page cleaner, if it is running. Dirty pages it has not reached yet stay dirty. */
+  void StopPageCleaner();
+
+  /**
+   * @brief Grow or shrink the buffer pool to new_size frames while it is in use.
+   *
+   * New frames are handed to the free lists of their shards. Shrinking retires the frames of each shard from the
+   * highest frame id down: free frames are dropped, unpinned pages are written back if dirty and evicted, and the
+   * memory of the retired frames is given back to the OS. A shard stops shrinking at its first pinned frame. Frames
+   * are retired in batches of BUFFER_POOL_RESIZE_BATCH, each under one acquisition of the shard latch, so fetches of
+   * other pages are never held up for long. Replacers are told about their new capacity.
+   *
+   * @param new_size the new number of frames, in [number of shards, max pool size]
+   * @return false if new_size is out of range or pinned frames kept the pool from shrinking all the way; the pool
+   * then keeps the frames it could not retire, see GetPoolSize()
+   */
+  auto Resize(size_t new_size) -> bool;
+
+  /**
+   * @brief Save the ids of the resident pages to a sidecar file, hottest first, for LoadHotPages() to read back on the
+   * next start. Hotness is the access count of each frame in its replacer (up to k for LRU-K).
+   *
+   * Call it at shutdown, or periodically from any thread while the pool is in use: each shard is only latched while
+   * its frames are listed. The file is replaced atomically, so a crash while saving leaves the previous one intact.
+   *
+   * @param file_name path of the sidecar file
+   * @return false if the file could not be written
+   */
+  auto SaveHotPages(const std::string &file_name) -> bool;
+
+  /**
+   * @brief Read the pages listed by SaveHotPages() back into the pool, with num_threads threads reading in parallel.
+   *
+   * The hottest pages are read first, and each one gets its saved access count replayed into the replacer. Pages only
+   * go into free frames: a preload never evicts anything, so it is safe to run before or alongside queries, and
+   * pages that queries fetched meanwhile are simply skipped. Pages past the end of the pool are ignored.
+   *
+   * @param file_name path of the sidecar file
+   * @param num_threads number of threads reading pages
+   * @return the number of pages read; 0 if the file is missing or malformed
+   */
+  auto LoadHotPages(const std::string &file_name, size_t num_threads = HOT_PAGES_LOAD_THREADS) -> size_t;
+
+  /** @return the number of dirty victims written back on the eviction path */
+  auto GetForegroundWrites() const -> size_t { return foreground_writes_; }
+
+  /** @return the number of pages written back by the page cleaner */
+  auto GetBackgroundWrites() const -> size_t { return background_writes_; }
+
+  /** @return the number of write calls FlushAllPages() saved by coalescing runs of consecutive pages */
+  auto GetSavedWriteCalls() const -> size_t { return saved_write_calls_; }
+
+  /**
+   * @brief Take a snapshot of the counters and latency histograms of the pool: hits, misses, evictions, failures to
+   * find an unpinned frame, waits on the shard latches, and the synchronous reads and writes it issued (one value per
+   * disk manager call). Counting is cheap enough to be always on, see BufferPoolStatsCollector.
+   */
+  auto GetStats() const -> BufferPoolStats { return stats_.Snapshot(); }
+
+  /** @brief Zero the counters behind GetStats(), e.g. once a benchmark has loaded its data. */
+  void ResetStats() { stats_.Reset(); }
+
  private:
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
-  /** The next page id to be allocated  */
-  std::atomic<page_id_t> next_page_id_ = 0;
+  /**
+   * One partition of the buffer pool. Frame i of the pool belongs to shard (i % num_shards) and is known inside the
+   * shard by the local frame id (i / num_shards).
+   */
+  struct Shard {
+    /** Frames owned by this shard, indexed by shard-local frame id, up to the maximum pool size. */
+    std::vector<Page *> frames_;
+    /** Frames [0, num_active_) are in use; the others are neither free nor in the page table or the replacer. */
+    size_t num_active_{0};
+    /** Page table for the pages held by this shard, mapping page ids to shard-local frame ids. */
+    std::unique_ptr<ConcurrentPageTable> page_table_;
+    /** Replacer to find unpinned frames of this shard for replacement. */
+    std::unique_ptr<Replacer> replacer_;
+    /** List of free shard-local frames that don't have any pages on them. */
+    std::list<frame_id_t> free_list_;
+    /** Frames recycled by scans, in the order they are reused. Holds at most scan_ring_capacity_ entries. */
+    std::vector<frame_id_t> scan_ring_;
+    size_t scan_ring_capacity_{0};
+    /** Slot of scan_ring_ to recycle next, once the ring is full. */
+    size_t scan_ring_next_{0};
+    /**
+     * in_scan_ring_[f] is set while frame f holds a page loaded by a scan that no point access has touched since.
+     * Only such frames are recycled by the ring; a slot whose frame lost the flag is refilled on its next turn.
+     */
+    std::unique_ptr<std::atomic<bool>[]> in_scan_ring_;
+    /**
+     * reading_[f] is set between StartRead() and FinishRead() on frame f, while its page is read without the shard
+     * latch. The frame holds no consistent page yet, and the disk does: flushes skip it.
+     */
+    std::unique_ptr<std::atomic<bool>[]> reading_;
+    /** evictable_latches_[f] orders the updates of the evictable flag of frame f, see SyncEvictable(). */
+    std::unique_ptr<std::mutex[]> evictable_latches_;
+    /**
+     * This latch serializes all changes to page_table_ and free_list_, and the assignment of pages to frames. Lookups
+     * and pinning of resident pages go without it.
+     */
+    std::mutex latch_;
+  };
+
+  /** Number of pages in the buffer pool. Changed by Resize() only, under resize_latch_. */
+  std::atomic<size_t> pool_size_;
+  /** Number of frames reserved for the buffer pool to grow into. */
+  const size_t max_pool_size_;
+  /** Serializes calls to Resize(). */
+  std::mutex resize_latch_;
 
   /** Array of buffer pool pages. */
   Page *pages_;
+  /** Page-aligned slab holding the data of all the frames, frame i at offset i * BUSTUB_PAGE_SIZE. */
+  char *frame_data_;
+  size_t frame_data_size_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. Please ignore this for P1. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  std::unique_ptr<LRUKReplacer> replacer_;
-  /** List of free frames that don't have any pages on them. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  /** Partitions of the buffer pool. The vector itself is never resized after construction. */
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  /** Pages waiting to be read by prefetch_thread_, with the access type they were requested for. */
+  std::deque<std::pair<page_id_t, AccessType>> prefetch_queue_;
+  /** Set on destruction to stop prefetch_thread_. Protected by prefetch_latch_, like prefetch_queue_. */
+  bool stop_prefetch_{false};
+  std::mutex prefetch_latch_;
+  std::condition_variable prefetch_cv_;
+  /** Started by the first call to PrefetchPages(). */
+  std::thread prefetch_thread_;
+
+  /** Set to stop cleaner_thread_. Protected by cleaner_latch_, like clean_fraction_. */
+  bool stop_cleaner_{false};
+  double clean_fraction_{0};
+  std::mutex cleaner_latch_;
+  std::condition_variable cleaner_cv_;
+  /** Runs between StartPageCleaner() and StopPageCleaner(). */
+  std::thread cleaner_thread_;
+  std::atomic<size_t> foreground_writes_{0};
+  std::atomic<size_t> background_writes_{0};
+  std::atomic<size_t> saved_write_calls_{0};
+  BufferPoolStatsCollector stats_;
+
+  /** @brief Take the shard latch, recording how long it took into the stats. */
+  auto LockShard(Shard &shard) -> std::unique_lock<std::mutex>;
+
+  /** @brief Read a page through the disk manager, recording how long it took into the stats. */
+  void ReadPage(page_id_t page_id, char *page_data);
+
+  /** @return the shard responsible for the given page id */
+  auto ShardOf(page_id_t page_id) -> Shard & { return *shards_[static_cast<size_t>(page_id) % shards_.size()]; }
+
+  /**
+   * @brief Find a frame to hold a new page, from the free list first and the replacer second. A scan recycles the
+   * next frame of the scan ring instead, once the ring is full. A dirty victim is written back and removed from the
+   * page table. Caller should hold the shard latch.
+   * @param shard the shard to take the frame from
+   * @param[out] frame_id the shard-local id of the frame
+   * @param access_type type of the access the frame is needed for
+   * @return false if every frame of the shard is pinned
+   */
+  auto AcquireFrame(Shard &shard, frame_id_t *frame_id, AccessType access_type) -> bool;
+
+  /**
+   * @brief Take the next frame of a full scan ring if it is unpinned and still holds a scanned page. Caller should
+   * hold the shard latch.
+   */
+  auto ReuseScanRingFrame(Shard &shard, frame_id_t *frame_id) -> bool;
+
+  /** @brief Write back and unmap the page of a frame whose pin count the caller has set to -1. */
+  void ResetFrame(Shard &shard, Page *page);
+
+  /** @brief Empty the scan ring and size it for the frames in use. Caller should hold the shard latch. */
+  void ResetScanRing(Shard &shard);
+
+  /**
+   * @brief Retire up to BUFFER_POOL_RESIZE_BATCH frames at the top of a shard, stopping at a pinned frame or at
+   * new_active frames. Takes the shard latch.
+   * @return false if a pinned frame stopped the shard from shrinking
+   */
+  auto RetireFrames(Shard &shard, size_t new_active) -> bool;
+
+  /**
+   * @brief Map a page to a frame just taken from the free list or the replacer, and publish it pinned and write-latched
+   * so that the page can be read without the shard latch: a fetch of the page finds the frame and waits in
+   * WaitForRead() until FinishRead(). Caller should hold the shard latch.
+   * @param num_accesses number of accesses of type access_type to record for the frame
+   */
+  void StartRead(Shard &shard, frame_id_t frame_id, page_id_t page_id, AccessType access_type,
+                 size_t num_accesses = 1);
+
+  /** @brief Unlatch and unpin a frame of StartRead() once its page has been read. Needs no latch. */
+  void FinishRead(Shard &shard, frame_id_t frame_id);
+
+  /** @brief Body of prefetch_thread_: read queued pages until the buffer pool is destroyed. */
+  void RunPrefetcher();
+
+  /**
+   * @brief Read pages into unpinned frames, skipping those resident already. The shard latch is only taken to claim the
+   * frames; all the reads are submitted to the disk manager before any of them is waited for.
+   */
+  void PrefetchBatch(const std::vector<std::pair<page_id_t, AccessType>> &batch);
+
+  /**
+   * @brief Read a page into a free frame and replay num_accesses accesses to it in the replacer. The shard latch is
+   * only taken to claim the frame, not for the read.
+   * @return false if the page is resident already or the shard has no free frame
+   */
+  auto PreloadPage(page_id_t page_id, size_t num_accesses) -> bool;
+
+  /** @brief Body of cleaner_thread_: clean every shard once per page_cleaner_interval until stopped. */
+  void RunPageCleaner();
+
+  /**
+   * @brief Write back dirty unpinned pages of a shard, as many as needed to get clean_fraction of its unpinned frames
+   * clean and at most PAGE_CLEANER_BATCH_SIZE. The pages are pinned under the shard latch and written without it.
+   */
+  void CleanShard(Shard &shard, double clean_fraction);
+
+  /**
+   * @brief Pin a frame without holding the shard latch. Fails if the frame is being reassigned or no longer holds
+   * page_id, in which case the caller should fall back to the latched path. Waits for a read of the page in flight.
+   */
+  auto TryPinFrame(Shard &shard, frame_id_t frame_id, page_id_t page_id, AccessType access_type) -> bool;
+
+  /**
+   * @brief Wait until the read started by StartRead() on a frame is done, if there is one. The caller must hold a pin
+   * on the frame, and not the shard latch.
+   */
+  void WaitForRead(Shard &shard, frame_id_t frame_id);
+
+  /** @brief Drop one pin on a frame, making it evictable once the pin count reaches zero. Needs no latch. */
+  auto UnpinFrame(Shard &shard, frame_id_t frame_id, bool is_dirty) -> bool;
+
+  /**
+   * @brief Make a frame evictable in the replacer if and only if its pin count is zero now. Called after every change
+   * of the pin count from or to zero. Does nothing for a frame being reassigned (pin count -1). Needs no latch.
+   */
+  void SyncEvictable(Shard &shard, frame_id_t frame_id);
+
+  /** @brief Make the replacer forget a frame whose pin count the caller has set to -1. */
+  void RemoveFromReplacer(Shard &shard, frame_id_t frame_id);
+
+  /**
+   * @brief Write a page of the shard back to disk and clear its dirty flag. Caller should hold the shard latch.
+   * @return false if the page is not in the page table of the shard
+   */
+  auto InternalFlushPages(Shard &shard, page_id_t page_id) -> bool;
 
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Allocate a page on disk, reusing a deallocated page if the disk manager has one. Needs no latch.
    * @return the id of the allocated page
    */
-  auto AllocatePage() -> page_id_t;
+  auto AllocatePage() -> page_id_t { return disk_manager_->AllocatePage(); }
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Deallocate a page on disk, so that its id can be handed out again. Needs no latch.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id) { disk_manager_->DeallocatePage(page_id); }
 
   // TODO(student): You may add additional private members and helper functions
 };
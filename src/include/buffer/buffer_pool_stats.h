@@ -0,0 +1,152 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * LatencyHistogram counts values (nanoseconds) in log-linear buckets, like an HDR histogram: every power of two is
+ * split into SUB_BUCKETS buckets of equal width, so any recorded value is known within 1 / SUB_BUCKETS of itself, over
+ * the whole 64-bit range and in constant space. Histograms of the same shape merge by adding up their buckets.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr size_t SUB_BUCKET_BITS = 3;
+  static constexpr size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+  /** Values below SUB_BUCKETS get a bucket each; then SUB_BUCKETS buckets for each remaining power of two. */
+  static constexpr size_t NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+  /** @return the bucket a value falls into */
+  static auto BucketOf(uint64_t value) -> size_t;
+
+  /** @return the largest value that falls into a bucket */
+  static auto BucketUpperBound(size_t bucket) -> uint64_t;
+
+  void Record(uint64_t value) {
+    buckets_[BucketOf(value)]++;
+    count_++;
+    sum_ += value;
+  }
+
+  void Merge(const LatencyHistogram &other);
+
+  auto Count() const -> uint64_t { return count_; }
+  auto Mean() const -> double { return count_ == 0 ? 0 : static_cast<double>(sum_) / static_cast<double>(count_); }
+
+  /**
+   * @param percentile in [0, 100]
+   * @return an upper bound of the given percentile of the recorded values, 0 if there are none
+   */
+  auto Percentile(double percentile) const -> uint64_t;
+
+  /** @return an upper bound of the largest recorded value, 0 if there are none */
+  auto Max() const -> uint64_t { return Percentile(100); }
+
+ private:
+  friend class BufferPoolStatsCollector;
+
+  std::array<uint64_t, NUM_BUCKETS> buckets_{};
+  uint64_t count_{0};
+  uint64_t sum_{0};
+};
+
+/** A snapshot of the counters of a buffer pool, see BufferPoolManager::GetStats(). */
+struct BufferPoolStats {
+  /** Fetches that found the page resident. */
+  uint64_t hits_{0};
+  /** Fetches that had to read the page. */
+  uint64_t misses_{0};
+  /** Pages evicted to make room for others, with and without a write back. */
+  uint64_t clean_evictions_{0};
+  uint64_t dirty_evictions_{0};
+  /** Fetches and page creations that failed because every frame of the shard was pinned. */
+  uint64_t pin_wait_failures_{0};
+  /** Time spent waiting for shard latches, one value per acquisition (0 when it was free). */
+  LatencyHistogram latch_wait_;
+  /** Time spent in synchronous page reads and writes of the disk manager. */
+  LatencyHistogram read_latency_;
+  LatencyHistogram write_latency_;
+
+  /** @return the fraction of fetches that were hits, 0 if there were none */
+  auto HitRatio() const -> double {
+    uint64_t fetches = hits_ + misses_;
+    return fetches == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(fetches);
+  }
+
+  /** @return a multi-line report of the counters, and of the percentiles of each histogram in microseconds */
+  auto ToString() const -> std::string;
+};
+
+/**
+ * BufferPoolStatsCollector gathers the counters of a buffer pool from many threads at little cost. Each thread updates
+ * one of NUM_STRIPES cache-line aligned stripes with relaxed atomic additions, so that threads do not bounce a shared
+ * cache line; Snapshot() adds the stripes up. A snapshot taken while the pool is busy is not an atomic cut, but every
+ * counter in it is exact as of some point during the call.
+ */
+class BufferPoolStatsCollector {
+ public:
+  enum class Counter { HIT = 0, MISS, CLEAN_EVICTION, DIRTY_EVICTION, PIN_WAIT_FAILURE, NUM_COUNTERS };
+  enum class Histogram { LATCH_WAIT = 0, READ, WRITE, NUM_HISTOGRAMS };
+
+  using Clock = std::chrono::steady_clock;
+
+  BufferPoolStatsCollector();
+
+  DISALLOW_COPY_AND_MOVE(BufferPoolStatsCollector);
+
+  ~BufferPoolStatsCollector() = default;
+
+  void Add(Counter counter) {
+    CurrentStripe().counters_[static_cast<size_t>(counter)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /** @brief Record the time elapsed since start into a histogram. */
+  void RecordSince(Histogram histogram, Clock::time_point start) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    Record(histogram, static_cast<uint64_t>(elapsed));
+  }
+
+  void Record(Histogram histogram, uint64_t nanos);
+
+  auto Snapshot() const -> BufferPoolStats;
+
+  /** @brief Zero all the counters. Updates racing with the reset may or may not survive it. */
+  void Reset();
+
+ private:
+  static constexpr size_t NUM_STRIPES = 16;
+  static constexpr size_t NUM_COUNTERS = static_cast<size_t>(Counter::NUM_COUNTERS);
+  static constexpr size_t NUM_HISTOGRAMS = static_cast<size_t>(Histogram::NUM_HISTOGRAMS);
+
+  struct alignas(64) Stripe {
+    std::array<std::atomic<uint64_t>, NUM_COUNTERS> counters_;
+    std::array<std::array<std::atomic<uint64_t>, LatencyHistogram::NUM_BUCKETS>, NUM_HISTOGRAMS> buckets_;
+    std::array<std::atomic<uint64_t>, NUM_HISTOGRAMS> sums_;
+  };
+
+  /** @return the stripe of the calling thread; threads are dealt out to the stripes round-robin */
+  auto CurrentStripe() -> Stripe &;
+
+  std::unique_ptr<Stripe[]> stripes_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer.h
+//
+// Identification: src/include/buffer/clock_pro_replacer.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ClockProReplacer implements the CLOCK-Pro policy (Jiang, Chen and Zhang, USENIX ATC '05).
+ *
+ * All pages sit on one clock: resident hot pages, resident cold pages, and non-resident cold pages that are still in
+ * their test period. Three hands sweep it:
+ * - HAND_cold evicts a resident cold page without its reference bit. A referenced cold page in its test period is
+ *   promoted to hot; otherwise it starts a new test period at the list head. An evicted page in its test period stays
+ *   on the clock as a non-resident entry.
+ * - HAND_hot demotes the first hot page without its reference bit to cold, and ends the test periods it passes.
+ * - HAND_test ends test periods and drops non-resident entries so that at most num_frames of them are remembered.
+ * A page that faults in while still in its test period has a short reuse distance; it becomes hot and grows the target
+ * number of cold frames m_c, while expired test periods shrink it. Pinned frames are never evicted.
+ */
+class ClockProReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new ClockProReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit ClockProReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ClockProReplacer);
+
+  ~ClockProReplacer() override = default;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) override;
+  using Replacer::RecordAccess;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  auto Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &claim) -> bool override;
+  using Replacer::Evict;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  void SetCapacity(size_t num_frames) override;
+
+  /** @return the current target number of resident cold frames m_c */
+  auto GetColdTarget() -> size_t;
+
+ private:
+  struct Entry {
+    /** Frame holding the page, or -1 for a non-resident page. */
+    frame_id_t frame_id_;
+    page_id_t page_id_;
+    bool hot_;
+    bool referenced_;
+    bool in_test_;
+  };
+  using Iterator = std::list<Entry>::iterator;
+
+  void CheckFrameId(frame_id_t frame_id) const;
+  /** @return the entry after it on the clock */
+  auto Next(Iterator it) -> Iterator;
+  /** @brief Insert an entry at the list head, i.e. right behind HAND_hot. */
+  auto InsertAtHead(const Entry &entry) -> Iterator;
+  /** @brief Remove an entry from the clock, moving any hand that points at it. */
+  void Erase(Iterator it);
+  /** @brief End the test period of a cold page, dropping it if it is not resident. */
+  void EndTest(Iterator it);
+  /** @brief Advance HAND_hot until it has demoted one hot page. */
+  void RunHandHot();
+  /** @brief Advance HAND_test until it has dropped one non-resident page. */
+  void RunHandTest();
+  auto MaxColdTarget() const -> size_t { return capacity_ > 1 ? capacity_ - 1 : 1; }
+
+  /** Number of frames in use; frame ids range over the size of tracked_. */
+  size_t capacity_;
+  /** Target number of resident cold pages (m_c); the hot target is capacity_ - m_c. */
+  size_t cold_target_{1};
+  size_t num_hot_{0};
+  std::list<Entry> clock_;
+  Iterator hand_hot_;
+  Iterator hand_cold_;
+  Iterator hand_test_;
+  std::vector<Iterator> position_;
+  std::vector<bool> tracked_;
+  std::vector<bool> evictable_;
+  size_t num_evictable_{0};
+  /** Non-resident pages in their test period. */
+  std::unordered_map<page_id_t, Iterator> non_resident_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <functional>
 #include <list>
 #include <mutex>  // NOLINT
 #include <vector>
@@ -37,16 +38,38 @@ class ClockReplacer : public Replacer {
    */
   ~ClockReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  void RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) override;
+  using Replacer::RecordAccess;
 
-  void Pin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  auto Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &claim) -> bool override;
+  using Replacer::Evict;
+
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  /** @brief Legacy interface: same as Evict(). */
+  auto Victim(frame_id_t *frame_id) -> bool;
+
+  /** @brief Legacy interface: make a frame non-evictable. */
+  void Pin(frame_id_t frame_id);
+
+  /** @brief Legacy interface: start tracking a frame as evictable (counts as an access), unless it already is. */
+  void Unpin(frame_id_t frame_id);
  private:
-  // TODO(student): implement me!
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  std::vector<bool> tracked_;
+  std::vector<bool> evictable_;
+  /** Reference bits, set on every access and cleared by the sweeping clock hand. */
+  std::vector<bool> referenced_;
+  /** Frame the clock hand points at. */
+  size_t hand_{0};
+  size_t num_evictable_{0};
+  size_t num_pages_;
+  std::mutex latch_;
 };
 
 }  // namespace bustub
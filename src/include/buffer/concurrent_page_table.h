@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// concurrent_page_table.h
+//
+// Identification: src/include/buffer/concurrent_page_table.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ConcurrentPageTable maps page ids to frame ids for one buffer pool shard.
+ *
+ * It is a fixed-size open addressing table with linear probing. Every slot packs (page id, frame id) into a single
+ * 64-bit atomic word, so Find() never takes a latch and never observes a torn entry. Insert() and Erase() must be
+ * serialized by the caller (the shard latch). Erase() uses backward-shift deletion instead of tombstones, which means a
+ * concurrent Find() may miss an entry that is being moved. Lock-free readers therefore have to treat a miss as "not
+ * sure" and retry under the latch, and must validate a hit against the frame they land on.
+ */
+class ConcurrentPageTable {
+ public:
+  /**
+   * @brief Create a page table able to hold num_frames entries. The capacity is kept at least twice the number of
+   * frames so that probe sequences stay short.
+   */
+  explicit ConcurrentPageTable(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ConcurrentPageTable);
+
+  ~ConcurrentPageTable() = default;
+
+  /**
+   * @brief Look up the frame holding page_id. Safe to call without any latch.
+   * @return the frame id, or -1 if the page was not found
+   */
+  auto Find(page_id_t page_id) const -> frame_id_t;
+
+  /** @brief Insert a mapping for a page id that is not in the table yet. Caller must hold the writer latch. */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /** @brief Remove the mapping for page_id if there is one. Caller must hold the writer latch. */
+  void Erase(page_id_t page_id);
+
+ private:
+  static constexpr uint64_t EMPTY_SLOT = ~static_cast<uint64_t>(0);
+
+  static auto Pack(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto PageOf(uint64_t slot) -> page_id_t { return static_cast<page_id_t>(slot >> 32); }
+  static auto FrameOf(uint64_t slot) -> frame_id_t { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  /** @return the slot a page id hashes to */
+  auto HomeOf(page_id_t page_id) const -> size_t {
+    // Fibonacci hashing: page ids of a shard are congruent modulo the shard count, so take the high bits.
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >> (64 - bits_);
+  }
+
+  size_t bits_;
+  size_t mask_;
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+};
+
+}  // namespace bustub
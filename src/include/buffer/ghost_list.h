@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// ghost_list.h
+//
+// Identification: src/include/buffer/ghost_list.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * GhostList remembers the ids of recently evicted pages in FIFO order, for replacement policies (ARC, 2Q) that adapt
+ * to pages coming back shortly after eviction. It is not thread-safe; the owning replacer latches it.
+ */
+class GhostList {
+ public:
+  /** @brief Remember a page as the most recent entry. */
+  void PushBack(page_id_t page_id) {
+    Erase(page_id);
+    index_[page_id] = pages_.insert(pages_.end(), page_id);
+  }
+
+  /** @brief Forget the oldest entry. */
+  void PopFront() {
+    index_.erase(pages_.front());
+    pages_.pop_front();
+  }
+
+  /** @return true if the page was remembered, in which case it is forgotten now */
+  auto Erase(page_id_t page_id) -> bool {
+    auto it = index_.find(page_id);
+    if (it == index_.end()) {
+      return false;
+    }
+    pages_.erase(it->second);
+    index_.erase(it);
+    return true;
+  }
+
+  auto Size() const -> size_t { return pages_.size(); }
+
+  auto Empty() const -> bool { return pages_.empty(); }
+
+ private:
+  std::list<page_id_t> pages_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> index_;
+};
+
+}  // namespace bustub
@@ -12,45 +12,17 @@
 
 #pragma once
 
+#include <functional>
 #include <limits>
-#include <list>
-#include <map>
 #include <mutex>  // NOLINT
-#include <unordered_map>
 #include <vector>
 
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
 namespace bustub {
 
-enum class AccessType { Unknown = 0, Get, Scan };
-
-class LRUKNode {
- public:
-  /** History of last seen K timestamps of this page. Least recent timestamp stored in front. */
-  // Remove maybe_unused if you start using them. Feel free to change the member variables as you want.
-
-  std::list<size_t> history_;
-  size_t k_;
-  frame_id_t fid_;
-  bool is_evictable_{false};
-
- public:
-  LRUKNode *left_;
-  LRUKNode *right_;
-
- public:
-  LRUKNode() = default;
-  LRUKNode(size_t k, frame_id_t fid);
-  ~LRUKNode() = default;
-  void SetIsEvictable(bool f);
-  auto GetIsEvictable() -> bool;
-  auto PushTime(size_t t) -> void;
-  auto GetFrameId() -> frame_id_t { return fid_; };
-  auto GetHistorySize() -> size_t { return history_.size(); };
-};
-
 /**
  * LRUKReplacer implements the LRU-k replacement policy.
  *
@@ -61,8 +33,13 @@ class LRUKNode {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * The last k access timestamps of every frame are kept in a fixed-size ring buffer, and the oldest timestamp in the
+ * ring is the eviction key of the frame: the first access for a frame with less than k accesses, and the k-th most
+ * recent access otherwise. Evictable frames live in an indexed binary min-heap ordered by (has k accesses, key), so
+ * RecordAccess, SetEvictable, Remove and Evict are all O(log n) and never allocate.
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
   /**
    *
@@ -80,7 +57,7 @@ class LRUKReplacer {
    *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer();
+  ~LRUKReplacer() override;
 
   /**
    * TODO(P1): Add implementation
@@ -96,9 +73,11 @@ class LRUKReplacer {
    * access history.
    *
    * @param[out] frame_id id of frame that is evicted.
+   * @param claim accepts or refuses the victim, see Replacer::Evict().
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &claim) -> bool override;
+  using Replacer::Evict;
 
   /**
    * TODO(P1): Add implementation
@@ -112,8 +91,10 @@ class LRUKReplacer {
    * @param frame_id id of frame that received a new access.
    * @param access_type type of access that was received. This parameter is only needed for
    * leaderboard tests.
+   * @param page_id unused, LRU-K keeps no history for pages that are not resident.
    */
-  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown);
+  void RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) override;
+  using Replacer::RecordAccess;
 
   /**
    * TODO(P1): Add implementation
@@ -132,7 +113,7 @@ class LRUKReplacer {
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
    * TODO(P1): Add implementation
@@ -151,7 +132,7 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
 
   /**
    * TODO(P1): Add implementation
@@ -160,24 +141,39 @@ class LRUKReplacer {
    *
    * @return size_t
    */
-  auto Size() -> size_t;
+  auto Size() -> size_t override;
 
-  auto RemoveNode(LRUKNode *node) -> void;
-  auto InsertNode(LRUKNode *node1, LRUKNode *node2) -> void;
+  /** @return the number of accesses recorded for the frame, at most k */
+  auto GetAccessCount(frame_id_t frame_id) -> size_t override;
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  std::unordered_map<frame_id_t, LRUKNode *> full_k_node_store_;
-  std::unordered_map<frame_id_t, LRUKNode *> unfull_k_node_store_;
-  LRUKNode *full_k_head_;
-  LRUKNode *full_k_tail_;
-  LRUKNode *unfull_k_head_;
-  LRUKNode *unfull_k_tail_;
+  static constexpr size_t NOT_IN_HEAP = std::numeric_limits<size_t>::max();
+
+  /** @return the ring buffer slot holding the oldest remembered access of a frame */
+  auto OldestSlot(frame_id_t frame_id) const -> size_t;
+  /** @return true if frame a should be evicted before frame b */
+  auto EvictsBefore(frame_id_t a, frame_id_t b) const -> bool;
+  void HeapPush(frame_id_t frame_id);
+  void HeapErase(frame_id_t frame_id);
+  void HeapSwap(size_t i, size_t j);
+  void SiftUp(size_t i);
+  void SiftDown(size_t i);
+  /** @brief Forget the access history of a frame, which must not be in the heap. */
+  void ClearFrame(frame_id_t frame_id);
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  /** Access timestamps, k consecutive slots per frame used as a ring buffer. */
+  std::vector<size_t> history_;
+  /** Number of valid timestamps in the ring of each frame (0 means the frame is not tracked). */
+  std::vector<size_t> history_size_;
+  /** Slot that the next access of each frame is written to. */
+  std::vector<size_t> history_next_;
+  std::vector<bool> evictable_;
+  /** Indexed min-heap of the evictable frames. */
+  std::vector<frame_id_t> heap_;
+  /** Position of every frame in heap_, or NOT_IN_HEAP. */
+  std::vector<size_t> heap_pos_;
   size_t current_timestamp_{0};
-  size_t curr_size_{0};
-  size_t full_k_size_{0};
-  size_t unfull_k_size_{0};
   size_t replacer_size_;
   size_t k_;
   std::mutex latch_;
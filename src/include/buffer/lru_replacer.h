@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <functional>
 #include <list>
 #include <mutex>  // NOLINT
 #include <vector>
@@ -37,16 +38,38 @@ class LRUReplacer : public Replacer {
    */
   ~LRUReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  void RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) override;
+  using Replacer::RecordAccess;
 
-  void Pin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  auto Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &claim) -> bool override;
+  using Replacer::Evict;
+
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  /** @brief Legacy interface: same as Evict(). */
+  auto Victim(frame_id_t *frame_id) -> bool;
+
+  /** @brief Legacy interface: make a frame non-evictable. */
+  void Pin(frame_id_t frame_id);
+
+  /** @brief Legacy interface: start tracking a frame as evictable (counts as an access), unless it already is. */
+  void Unpin(frame_id_t frame_id);
  private:
-  // TODO(student): implement me!
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  /** Tracked frames, least recently used first. */
+  std::list<frame_id_t> lru_list_;
+  /** Position of every tracked frame in lru_list_. */
+  std::vector<std::list<frame_id_t>::iterator> position_;
+  std::vector<bool> tracked_;
+  std::vector<bool> evictable_;
+  size_t num_evictable_{0};
+  size_t num_pages_;
+  std::mutex latch_;
 };
 
 }  // namespace bustub
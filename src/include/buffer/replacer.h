@@ -12,12 +12,21 @@
 
 #pragma once
 
+#include <cstddef>
+#include <functional>
+#include <memory>
+
 #include "common/config.h"
 
 namespace bustub {
 
 /**
- * Replacer is an abstract class that tracks page usage.
+ * Replacer is an abstract class that tracks frame usage and picks victims for the buffer pool.
+ *
+ * A frame becomes known to the replacer on its first RecordAccess() and starts out non-evictable. The buffer pool
+ * toggles evictability as the frame gets pinned and unpinned. Evict() and Remove() make the replacer forget the frame
+ * again (policies with ghost lists may keep remembering the page that was in it). Size() is the number of evictable
+ * frames. Frame ids are in [0, num_frames); an out-of-range id throws.
  */
 class Replacer {
  public:
@@ -25,26 +34,73 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
-   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
+   * Record an access to a frame at the current time, starting to track the frame if it is not tracked yet.
+   * @param frame_id id of frame that received a new access
+   * @param access_type type of the access
+   * @param page_id the page held by the frame. Policies that remember evicted pages (ARC, 2Q, CLOCK-Pro) use it to
+   * recognise a page coming back; INVALID_PAGE_ID if unknown.
+   */
+  virtual void RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) = 0;
+
+  /** Record an access to a frame whose page is not known to the caller. */
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) {
+    RecordAccess(frame_id, access_type, INVALID_PAGE_ID);
+  }
+
+  /**
+   * Toggle whether a frame is evictable. Does nothing if the frame is not tracked.
+   * @param frame_id id of frame whose 'evictable' status will be modified
+   * @param set_evictable whether the given frame is evictable or not
+   */
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
+
+  /**
+   * Pick a victim among the evictable frames according to the replacement policy and stop tracking it.
+   * @param[out] frame_id id of frame that was evicted
    * @return true if a victim frame was found, false otherwise
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  auto Evict(frame_id_t *frame_id) -> bool {
+    return Evict(frame_id, [](frame_id_t) { return true; });
+  }
 
   /**
-   * Pins a frame, indicating that it should not be victimized until it is unpinned.
-   * @param frame_id the id of the frame to pin
+   * Like Evict(frame_id), but a victim is only taken if claim() accepts it. claim runs under the replacer latch once a
+   * victim is picked. A refused frame keeps its history and stays tracked, but becomes non-evictable until the next
+   * SetEvictable(); the next victim is tried instead. The buffer pool uses this to race latch-free pins for a frame.
+   * @param[out] frame_id id of frame that was evicted
+   * @param claim called with the picked victim; returns false if the frame must not be evicted after all
+   * @return true if a victim frame was found and claimed, false otherwise
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual auto Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &claim) -> bool = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
-   * @param frame_id the id of the frame to unpin
+   * Stop tracking an evictable frame regardless of the policy, e.g. because its page was deleted. Does nothing if the
+   * frame is not tracked, and throws if it is not evictable.
+   * @param frame_id id of frame to be removed
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
+  virtual void Remove(frame_id_t frame_id) = 0;
 
   /** @return the number of elements in the replacer that can be victimized */
   virtual auto Size() -> size_t = 0;
+
+  /**
+   * Tell the replacer how many frames the pool holds now that it has been resized. Frame ids stay below the num_frames
+   * the replacer was built for. Called before new frames are used, and after retired frames have been removed.
+   * Policies whose targets depend on the pool size adapt them; the others ignore it.
+   * @param num_frames the number of frames in use
+   */
+  virtual void SetCapacity(size_t num_frames) {}
+
+  /**
+   * How much access history the replacer keeps for a frame, as a hint of how hot its page is. Used to persist the hot
+   * set of the pool across restarts, see BufferPoolManager::SaveHotPages().
+   * @param frame_id id of a frame the replacer tracks
+   * @return the number of past accesses remembered for the frame; policies without such history return 1
+   */
+  virtual auto GetAccessCount(frame_id_t frame_id) -> size_t { return 1; }
 };
 
+/** Builds a replacer for a pool (or pool shard) of the given number of frames. */
+using ReplacerFactory = std::function<std::unique_ptr<Replacer>(size_t num_frames)>;
+
 }  // namespace bustub
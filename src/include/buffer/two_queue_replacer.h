@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.h
+//
+// Identification: src/include/buffer/two_queue_replacer.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <list>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/ghost_list.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQueueReplacer implements the full 2Q policy (Johnson and Shasha, VLDB '94).
+ *
+ * A page loaded into a frame first goes to the FIFO queue A1in, where further hits do not move it. When evicted from
+ * A1in its id is remembered in the ghost queue A1out. A page that is loaded again while remembered in A1out is
+ * considered hot and goes to the LRU queue Am. Victims come from A1in while it holds more than Kin frames, and from
+ * Am otherwise. Pinned frames are skipped.
+ */
+class TwoQueueReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new TwoQueueReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   * @param kin_ratio target share of the frames for A1in (the paper suggests 25%)
+   * @param kout_ratio number of remembered page ids in A1out relative to the number of frames (the paper suggests 50%)
+   */
+  explicit TwoQueueReplacer(size_t num_frames, double kin_ratio = 0.25, double kout_ratio = 0.5);
+
+  DISALLOW_COPY_AND_MOVE(TwoQueueReplacer);
+
+  ~TwoQueueReplacer() override = default;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) override;
+  using Replacer::RecordAccess;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  auto Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &claim) -> bool override;
+  using Replacer::Evict;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  void SetCapacity(size_t num_frames) override;
+
+ private:
+  enum class Location { None, A1In, Am };
+
+  void CheckFrameId(frame_id_t frame_id) const;
+  /** @brief Take the first evictable frame that claim() accepts out of a resident queue. */
+  auto EvictFrom(std::list<frame_id_t> *queue, frame_id_t *frame_id, const std::function<bool(frame_id_t)> &claim)
+      -> bool;
+  void Unlink(frame_id_t frame_id);
+
+  /** Number of frames in use; frame ids range over the size of location_. */
+  size_t capacity_;
+  double kin_ratio_;
+  double kout_ratio_;
+  size_t kin_;
+  size_t kout_;
+  /** Resident queues, oldest / least recently used first. */
+  std::list<frame_id_t> a1in_;
+  std::list<frame_id_t> am_;
+  GhostList a1out_;
+  std::vector<std::list<frame_id_t>::iterator> position_;
+  std::vector<Location> location_;
+  std::vector<page_id_t> page_of_;
+  std::vector<bool> evictable_;
+  size_t num_evictable_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -196,12 +196,13 @@ class Catalog {
    * @param key_attrs Key attributes
    * @param keysize Size of the key
    * @param hash_function The hash function for the index
+   * @param compress_keys Whether the pages of the index store their keys compressed
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
                    const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
-                   HashFunction<KeyType> hash_function) -> IndexInfo * {
+                   HashFunction<KeyType> hash_function, bool compress_keys = false) -> IndexInfo * {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -226,14 +227,22 @@ class Catalog {
     // just the key, value, and comparator types
 
     // TODO(chi): support both hash index and btree index
-    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                    compress_keys);
 
-    // Populate the index with all tuples in table heap
+    // Populate the index with all tuples in table heap, sorted and loaded bottom-up rather than inserted one by one
     auto *table_meta = GetTable(table_name);
-    for (auto iter = table_meta->table_->MakeIterator(); !iter.IsEnd(); ++iter) {
+    auto iter = table_meta->table_->MakeIterator();
+    index->BulkLoad([&](Tuple *key, RID *rid) {
+      if (iter.IsEnd()) {
+        return false;
+      }
       auto [meta, tuple] = iter.GetTuple();
-      index->InsertEntry(tuple.KeyFromTuple(schema, key_schema, key_attrs), tuple.GetRid(), txn);
-    }
+      *key = tuple.KeyFromTuple(schema, key_schema, key_attrs);
+      *rid = tuple.GetRid();
+      ++iter;
+      return true;
+    });
 
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
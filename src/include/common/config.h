@@ -27,15 +27,32 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The background page cleaner of the buffer pool runs every PAGE_CLEANER_INTERVAL milliseconds. */
+extern std::chrono::milliseconds page_cleaner_interval;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
 static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int HUGE_PAGE_SIZE = 2 * 1024 * 1024;                               // size of an OS huge page in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
-static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int LRUK_REPLACER_K = 10;           // lookback window for lru-k replacer
+static constexpr int SCAN_RING_SIZE = 32;            // frames that sequential scans recycle among themselves
+static constexpr int SCAN_PREFETCH_DISTANCE = 4;     // pages a table or index scan reads ahead of its cursor
+static constexpr int PAGE_CLEANER_BATCH_SIZE = 16;   // pages written per shard by one pass of the page cleaner
+static constexpr int PREFETCH_BATCH_SIZE = 16;       // pages the buffer pool prefetcher reads at once
+static constexpr int ASYNC_IO_QUEUE_DEPTH = 64;      // page I/Os in flight at once in AsyncDiskManager
+static constexpr int MMAP_SCAN_READAHEAD = 32;       // pages MmapDiskManager asks the kernel to read ahead of a scan
+static constexpr int BUFFER_POOL_RESIZE_BATCH = 64;  // frames retired per shard latch acquisition when shrinking
+static constexpr int HOT_PAGES_LOAD_THREADS = 4;     // threads reading a saved hot set back into the buffer pool
+static constexpr int BTREE_OPTIMISTIC_RETRIES = 8;   // optimistic B+ tree descents tried before taking read latches
+static constexpr int INDEX_SCAN_BATCH_SIZE = 256;    // entries an index scan copies out of a leaf at once
+
+static constexpr double BTREE_BULK_LOAD_FILL_FACTOR = 0.9;  // fraction of each page filled by BPlusTree::BulkLoad
+static constexpr int BTREE_BULK_LOAD_RUN_SIZE = 1 << 20;    // entries sorted in memory before spilling a sorted run
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -46,4 +63,7 @@ using oid_t = uint16_t;
 
 static constexpr int VARCHAR_DEFAULT_LENGTH = 128;  // default length for varchar when constructing the column
 
+/** How a page is being accessed. Replacement policies may use this as a hint, e.g. to resist sequential floods. */
+enum class AccessType { Unknown = 0, Get, Scan };
+
 }  // namespace bustub
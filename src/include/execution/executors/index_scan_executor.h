@@ -13,6 +13,7 @@
 #pragma once
 
 #include <optional>
+#include <utility>
 #include <vector>
 
 #include "catalog/catalog.h"
@@ -51,6 +52,8 @@ class IndexScanExecutor : public AbstractExecutor {
   TableInfo *table_info_ = nullptr;
   BPlusTreeIndexForTwoIntegerColumn *tree_it_ = nullptr;
   BPlusTreeIndexIteratorForTwoIntegerColumn it_;
-  BPlusTreeIndexIteratorForTwoIntegerColumn end_it_;
+  /** Entries copied out of the index by it_.NextBatch(), and the next one of them to return. */
+  std::vector<std::pair<IntegerKeyType, RID>> batch_;
+  size_t batch_index_{0};
 };
 }  // namespace bustub
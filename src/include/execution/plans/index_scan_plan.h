@@ -29,9 +29,10 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
    * @param table_oid the identifier of table to be scanned
+   * @param reverse whether to scan the index from its largest key down
    */
-  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
-      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, bool reverse = false)
+      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid), reverse_(reverse) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
@@ -43,10 +44,16 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
 
+  /** Whether the index is scanned in descending key order. */
+  bool reverse_;
+
   // Add anything you want here for index lookup
 
  protected:
   auto PlanNodeToString() const -> std::string override {
+    if (reverse_) {
+      return fmt::format("IndexScan {{ index_oid={}, reverse=true }}", index_oid_);
+    }
     return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
   }
 };
@@ -0,0 +1,149 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.h
+//
+// Identification: src/include/storage/disk/async_disk_manager.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/uio.h>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace bustub {
+
+/**
+ * AsyncDiskManager reads and writes pages of the database file with many I/Os in flight at once, instead of one at a
+ * time through a latched stream like DiskManager does.
+ *
+ * Requests go to an io_uring instance and are completed by a dedicated thread that reaps the completion queue. If the
+ * kernel does not support io_uring (or it is disabled), a pool of worker threads issuing pread/pwrite takes its place.
+ * Either way up to queue_depth requests are in flight; further submissions wait for a free slot. The synchronous
+ * ReadPage()/WritePage() skip the queue and issue pread/pwrite on the calling thread, without any latch. The log file
+ * is still handled by DiskManager.
+ *
+ * With direct_io, the database file is opened with O_DIRECT so that pages are not cached by the kernel on top of the
+ * buffer pool. Direct I/O needs page-aligned buffers: buffer pool frames are, and any other buffer goes through an
+ * aligned bounce buffer.
+ */
+class AsyncDiskManager : public DiskManager {
+ public:
+  /**
+   * Creates a new disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param queue_depth the maximum number of page I/Os in flight
+   * @param use_io_uring false to always use the thread pool backend
+   * @param direct_io true to bypass the kernel page cache, if the file system allows it
+   */
+  explicit AsyncDiskManager(const std::string &db_file, size_t queue_depth = ASYNC_IO_QUEUE_DEPTH,
+                            bool use_io_uring = true, bool direct_io = false);
+
+  /** Waits for all the I/Os in flight before releasing the file and the backend. */
+  ~AsyncDiskManager() override;
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /** Writes the run with pwritev() on the calling thread, as few calls as the kernel allows. */
+  auto WritePages(page_id_t first_page_id, const std::vector<const char *> &pages_data) -> size_t override;
+
+  using DiskManager::ReadPageAsync;
+  using DiskManager::WritePageAsync;
+  void WritePageAsync(page_id_t page_id, const char *page_data, std::function<void()> callback) override;
+  void ReadPageAsync(page_id_t page_id, char *page_data, std::function<void()> callback) override;
+
+  /** @return true if requests go through io_uring, false if they go through the thread pool */
+  auto UsesIoUring() const -> bool { return ring_fd_ >= 0; }
+
+  /** @return true if the database file is opened with O_DIRECT */
+  auto UsesDirectIO() const -> bool { return direct_io_; }
+
+ private:
+  /** One page I/O, owned by the backend from submission until its callback has run. */
+  struct Request {
+    bool is_write_;
+    page_id_t page_id_;
+    char *data_;
+    std::function<void()> callback_;
+    /** Buffer description handed to the kernel; it has to live as long as the request. */
+    iovec iov_;
+    /** Aligned copy of data_ for direct I/O, if data_ itself is not aligned. */
+    char *bounce_;
+  };
+
+  /** Wait for a free slot and hand the request to the backend. */
+  void Submit(Request *request);
+
+  /** Check the result of a finished request, run its callback, and free its slot. res is a byte count or -errno. */
+  void Complete(Request *request, int res);
+
+  /** Log a failed I/O, and zero the part of a read page that lies past the end of the file. */
+  void CheckResult(bool is_write, char *data, int res);
+
+  /** @return the result of a pread/pwrite of one page on the calling thread, a byte count or -errno */
+  auto PositionalIO(bool is_write, page_id_t page_id, char *data) -> int;
+
+  auto SetUpIoUring() -> bool;
+  /** @return false if io_uring refused the request; it is then withdrawn from the ring and still the caller's */
+  auto SubmitToIoUring(Request *request) -> bool;
+  /** Body of the completion thread of the io_uring backend. */
+  void ReapCompletions();
+
+  /** Body of the worker threads of the thread pool backend. */
+  void RunWorker();
+  /** Do the I/O of a request with pread/pwrite on the calling thread and complete it. */
+  void RunRequest(Request *request);
+
+  /** Descriptor of the database file used for page I/O. */
+  int fd_{-1};
+  bool direct_io_{false};
+  const size_t queue_depth_;
+
+  /** Protects in_flight_, and the submission queue of whichever backend is in use. */
+  std::mutex submit_latch_;
+  std::condition_variable slot_cv_;
+  size_t in_flight_{0};
+
+  // io_uring backend. ring_fd_ is -1 when the thread pool is used instead.
+  int ring_fd_{-1};
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+  std::thread reaper_;
+
+  // Thread pool backend.
+  std::deque<Request *> queue_;
+  bool stop_workers_{false};
+  std::condition_variable queue_cv_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
@@ -14,9 +14,12 @@
 
 #include <atomic>
 #include <fstream>
+#include <functional>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
+#include <set>
 #include <string>
+#include <vector>
 
 #include "common/config.h"
 
@@ -25,6 +28,10 @@ namespace bustub {
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Deallocated pages are remembered in a free-page bitmap and handed out again, lowest id first, before the file is
+ * grown. For a database file, the bitmap is kept in a side file next to it (db.fsm for db.db) and updated on every
+ * allocation and deallocation, so it survives a restart; in-memory disk managers keep it in memory only.
  */
 class DiskManager {
  public:
@@ -51,6 +58,16 @@ class DiskManager {
    */
   virtual void WritePage(page_id_t page_id, const char *page_data);
 
+  /**
+   * Write a run of consecutive pages to the database file with as few I/O calls as possible. By default the pages are
+   * written one by one through WritePage(); only the database file of a plain DiskManager is written in one go.
+   * Subclasses that can batch the writes override this.
+   * @param first_page_id id of the first page of the run
+   * @param pages_data raw data of the pages, pages_data[i] belonging to page first_page_id + i
+   * @return the number of write calls issued
+   */
+  virtual auto WritePages(page_id_t first_page_id, const std::vector<const char *> &pages_data) -> size_t;
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
@@ -58,6 +75,38 @@ class DiskManager {
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Write a page to the database file without waiting for the write to finish. The default implementation writes
+   * synchronously and calls the callback before returning; subclasses with a real I/O queue may call it later, from
+   * another thread. page_data must stay valid until then.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @param callback called once the write is done
+   */
+  virtual void WritePageAsync(page_id_t page_id, const char *page_data, std::function<void()> callback);
+
+  /**
+   * Read a page from the database file without waiting for the read to finish. See WritePageAsync().
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   * @param callback called once the read is done
+   */
+  virtual void ReadPageAsync(page_id_t page_id, char *page_data, std::function<void()> callback);
+
+  /**
+   * Tell the disk manager how a page is about to be read, so that it can prepare the I/O. Called by the buffer pool
+   * right before ReadPage(). Does nothing by default.
+   * @param page_id id of the page
+   * @param access_type type of the access the page is read for
+   */
+  virtual void AdviseAccess(page_id_t page_id, AccessType access_type) {}
+
+  /** @return a future that becomes ready once the write is done, see WritePageAsync() */
+  auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void>;
+
+  /** @return a future that becomes ready once the read is done, see ReadPageAsync() */
+  auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void>;
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -74,6 +123,21 @@ class DiskManager {
    */
   auto ReadLog(char *log_data, int size, int offset) -> bool;
 
+  /**
+   * Allocate a page, reusing a deallocated one if there is any.
+   * @return the id of the allocated page
+   */
+  auto AllocatePage() -> page_id_t;
+
+  /**
+   * Return a page to the free space. Deallocating a page that is already free does nothing.
+   * @param page_id id of the page to deallocate
+   */
+  void DeallocatePage(page_id_t page_id);
+
+  /** @return the number of deallocated pages waiting to be reused */
+  auto GetNumFreePages() -> size_t;
+
   /** @return the number of disk flushes */
   auto GetNumFlushes() const -> int;
 
@@ -94,6 +158,8 @@ class DiskManager {
 
  protected:
   auto GetFileSize(const std::string &file_name) -> int;
+  /** For subclasses that open the database file themselves: pages below next_page_id exist already. */
+  void SetNextPageId(page_id_t next_page_id);
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
@@ -101,11 +167,26 @@ class DiskManager {
   std::fstream db_io_;
   std::string file_name_;
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
   // With multiple buffer pool instances, need to protect file access
   std::mutex db_io_latch_;
+
+ private:
+  /** Set or clear the bit of a page in the free-page bitmap, and in its file if there is one. */
+  void MarkFree(page_id_t page_id, bool is_free);
+
+  // stream to write the free-page bitmap
+  std::fstream fsm_io_;
+  std::string fsm_name_;
+  /** Protects everything below. */
+  std::mutex alloc_latch_;
+  /** Pages below next_page_id_ have been allocated at some point; free_pages_ are those deallocated since. */
+  page_id_t next_page_id_{0};
+  std::set<page_id_t> free_pages_;
+  /** Bit i of the bitmap is set iff page i is free. Mirrors the content of the free-page file. */
+  std::vector<uint8_t> free_bitmap_;
 };
 
 }  // namespace bustub
@@ -10,12 +10,16 @@
 //
 //===----------------------------------------------------------------------===//
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>  // NOLINT
 #include <cstring>
 #include <fstream>
 #include <future>  // NOLINT
 #include <memory>
 #include <mutex>  // NOLINT
 #include <optional>
+#include <random>
 #include <shared_mutex>
 #include <string>
 #include <thread>  // NOLINT
@@ -57,9 +61,39 @@ class DiskManagerMemory : public DiskManager {
   char *memory_;
 };
 
+/** Service time of one page I/O, drawn from a log-normal distribution, or constant when stddev_ is zero. */
+struct LatencyModel {
+  std::chrono::microseconds mean_{0};
+  std::chrono::microseconds stddev_{0};
+};
+
+/**
+ * Performance model of a simulated storage device. Each page I/O waits for a free queue slot, then takes the latency
+ * of its kind, and cannot finish before its transfer is done on a channel shared by all I/Os at the given bandwidth.
+ * I/Os in flight overlap, up to the queue depth, like on an NVMe device.
+ */
+struct DeviceModel {
+  LatencyModel read_;
+  LatencyModel write_;
+  /** Bytes per second shared by reads and writes, 0 for unlimited. */
+  size_t bandwidth_{0};
+  /** Page I/Os in flight at once, 0 for unlimited. */
+  size_t queue_depth_{0};
+
+  /**
+   * Parse a device model from a comma-separated list of key=value pairs, e.g.
+   * "read=80,write=20,read-stddev=40,bandwidth=2000,queue-depth=32". Latencies are in microseconds, the bandwidth is
+   * in MB/s, and keys that are left out stay unlimited. Throws on an unknown key or a malformed value.
+   */
+  static auto FromString(const std::string &spec) -> DeviceModel;
+};
+
 /**
  * DiskManagerMemory replicates the utility of DiskManager on memory. It is primarily used for
  * data structure performance testing.
+ *
+ * By default I/Os are as fast as a memcpy. SetDeviceModel() makes them behave like those of a real device, so that
+ * benchmarks can reproduce the I/O behavior of production hardware without touching a disk.
  */
 class DiskManagerUnlimitedMemory : public DiskManager {
  public:
@@ -71,8 +105,8 @@ class DiskManagerUnlimitedMemory : public DiskManager {
    * @param page_data raw page data
    */
   void WritePage(page_id_t page_id, const char *page_data) override {
-    if (latency_ > 0) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(latency_));
+    if (simulate_device_) {
+      SimulateIO(true);
     }
 
     std::unique_lock<std::mutex> l(mutex_);
@@ -95,8 +129,8 @@ class DiskManagerUnlimitedMemory : public DiskManager {
    * @param[out] page_data output buffer
    */
   void ReadPage(page_id_t page_id, char *page_data) override {
-    if (latency_ > 0) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(latency_));
+    if (simulate_device_) {
+      SimulateIO(false);
     }
 
     std::unique_lock<std::mutex> l(mutex_);
@@ -115,14 +149,36 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     memcpy(page_data, ptr->first.data(), BUSTUB_PAGE_SIZE);
   }
 
-  void SetLatency(size_t latency_ms) { latency_ = latency_ms; }
+  /** Make every read and write take latency_ms, without any other limit. */
+  void SetLatency(size_t latency_ms) {
+    DeviceModel model;
+    model.read_.mean_ = std::chrono::milliseconds(latency_ms);
+    model.write_.mean_ = model.read_.mean_;
+    SetDeviceModel(model);
+  }
+
+  /** Simulate the given device from now on. Should not be called while I/Os are in progress. */
+  void SetDeviceModel(const DeviceModel &model);
 
  private:
+  /** Wait as long as the simulated device would take to perform a page I/O. */
+  void SimulateIO(bool is_write);
+
   std::mutex mutex_;
   using Page = std::array<char, BUSTUB_PAGE_SIZE>;
   using ProtectedPage = std::pair<Page, std::shared_mutex>;
   std::vector<std::shared_ptr<ProtectedPage>> data_;
-  size_t latency_{0};
+
+  /** False while the model has no cost at all, to keep the I/O path free of the device latch. */
+  std::atomic<bool> simulate_device_{false};
+  /** Protects everything below. */
+  std::mutex device_latch_;
+  std::condition_variable slot_cv_;
+  DeviceModel model_;
+  size_t in_flight_{0};
+  /** When the transfers issued so far will be done, if the bandwidth is limited. */
+  std::chrono::steady_clock::time_point channel_free_at_;
+  std::mt19937_64 gen_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_disk_manager.h
+//
+// Identification: src/include/storage/disk/mmap_disk_manager.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <shared_mutex>
+#include <string>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * MmapDiskManager maps the database file into memory, so that ReadPage() is a memcpy out of the kernel page cache
+ * instead of a seek and read through a latched stream. It targets read-mostly databases, e.g. replicas that only
+ * query their copy of the file.
+ *
+ * The mapping is advised for random access: point lookups should not drag neighbouring pages into memory. Scans make
+ * up for it through AdviseAccess(), which asks the kernel to read MMAP_SCAN_READAHEAD pages ahead of them.
+ *
+ * In read-only mode the file is opened O_RDONLY and WritePage() throws. Otherwise writes go through pwrite() to the
+ * same file, which the shared mapping sees right away; the mapping is grown when a read reaches past its end. The log
+ * and the free-page bitmap are not persisted: allocations start after the last page of the file on every open.
+ */
+class MmapDiskManager : public DiskManager {
+ public:
+  /**
+   * Creates a new disk manager that maps the specified database file.
+   * @param db_file the file name of the database file to map
+   * @param read_only true to open the file read-only, which requires it to exist
+   */
+  explicit MmapDiskManager(const std::string &db_file, bool read_only = true);
+
+  /** Unmaps and closes the database file. */
+  ~MmapDiskManager() override;
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /** Scans ask the kernel to read the following pages in the background. */
+  void AdviseAccess(page_id_t page_id, AccessType access_type) override;
+
+  /** @return true if the database file is opened read-only */
+  auto IsReadOnly() const -> bool { return read_only_; }
+
+ private:
+  /** Map the whole file again if it has grown past the current mapping. Caller should hold map_latch_ exclusively. */
+  void Remap();
+
+  int fd_{-1};
+  bool read_only_;
+  /** Shared by readers of the mapping, exclusive while replacing it. */
+  std::shared_mutex map_latch_;
+  char *map_{nullptr};
+  size_t map_size_{0};
+};
+
+}  // namespace bustub
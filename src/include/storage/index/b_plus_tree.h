@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <deque>
+#include <functional>
 #include <iostream>
 #include <map>
 #include <mutex>  // NOLINT
@@ -65,6 +66,7 @@ INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  friend INDEXITERATOR_TYPE;
 
  public:
   explicit BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
@@ -98,12 +100,66 @@ class BPlusTree {
   void DeleteInternalNodeKey(page_id_t this_page_id, int delete_index, std::map<page_id_t, int> index_mp, Context &ctx,
                              Transaction *txn = nullptr);
 
+  /**
+   * @brief Fill an empty tree bottom-up from entries sorted by key, instead of inserting them one by one. Leaves are
+   * written left to right, each filled to fill_factor of its capacity; then every level of internal pages is built the
+   * same way from the first keys of the pages below it, until one page is left for the root. Pages hold at least their
+   * minimum size, and are linked for B-link mode too. A key equal to the one before it is skipped, as in Insert().
+   * @param next yields the next entry, false when there are no more; throws if keys go down
+   * @return the number of entries loaded
+   */
+  auto BulkLoad(const std::function<bool(MappingType *)> &next, double fill_factor = BTREE_BULK_LOAD_FILL_FACTOR)
+      -> size_t;
+
   // Return the value associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn = nullptr) -> bool;
 
   // Return the page id of the root node
   auto GetRootPageId() -> page_id_t;
 
+  /**
+   * Lookups and iterator descents read the tree optimistically by default: pages are pinned without taking their read
+   * latch and validated against their version afterwards, so readers never write to the cache lines of hot inner
+   * nodes. After BTREE_OPTIMISTIC_RETRIES failed validations they fall back to read latches. Disabling this makes them
+   * take read latches from the start, e.g. to compare the two.
+   */
+  void SetOptimisticReads(bool enable) { optimistic_reads_ = enable; }
+
+  /**
+   * Insert() and Remove() crab optimistically by default: they descend like an optimistic lookup, write latch the leaf
+   * alone, and only restart from the header with write latches down the whole path when the leaf has to split or
+   * underflows. Disabling this makes every change take the pessimistic path, e.g. to compare the two.
+   */
+  void SetOptimisticWrites(bool enable) { optimistic_writes_ = enable; }
+
+  /**
+   * Switch the tree to Lehman and Yao's B-link protocol; the tree must still be empty. Every page then carries a high
+   * key and a link to its right sibling. A split publishes the new right half through that link alone and lets go of
+   * the split page before it latches the parent to add the separator, and a reader that finds its key at or past the
+   * high key of a page moves right. Lookups and scans hold one latch at a time and never wait for a split to reach the
+   * parent; the optimistic paths do not apply. Removals do not merge or redistribute: pages may end up empty, and are
+   * skipped by the iterators.
+   */
+  void SetBLink(bool enable);
+
+  /**
+   * Store the keys of every page compressed; the tree must still be empty, and its max sizes no larger than
+   * the COMPRESSED_MAX_SIZE of its pages. Pages elide the bytes that all of their keys share,
+   * and hold as many entries as fit up to their max size, so similar keys give a larger fanout and a lower tree. Leaf
+   * splits push up the shortest separator that tells the two halves apart rather than the first key of the right one.
+   * Removals merge or redistribute pages as in plain trees whenever the entries that move fit; if they do not, the page
+   * is left less than half full, and the iterators skip pages that end up empty.
+   */
+  void SetKeyCompression(bool enable);
+
+  /**
+   * Store the keys of every page in as many bytes as they take, up to their last nonzero one; the tree must still be
+   * empty, and its max sizes no larger than the VARIABLE_LENGTH_MAX_SIZE of its pages. This suits keys that mostly
+   * leave a wide GenericKey empty, such as strings: pages hold as many entries as fit up to their max size, and leaf
+   * splits push up the shortest separator. Removals work as with compressed keys. This replaces key compression.
+   */
+  void SetVariableLengthKeys(bool enable);
+
   // Index iterator
   auto Begin() -> INDEXITERATOR_TYPE;
 
@@ -111,6 +167,15 @@ class BPlusTree {
 
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
 
+  /** @return an iterator from key on that ends past the keys no greater than upper_bound, see SetUpperBound() */
+  auto Begin(const KeyType &key, const KeyType &upper_bound) -> INDEXITERATOR_TYPE;
+
+  /** @return a reverse iterator from the largest key down, which ends at End() */
+  auto RBegin() -> INDEXITERATOR_TYPE;
+
+  /** @return a reverse iterator from the largest key no greater than key down */
+  auto RBegin(const KeyType &key) -> INDEXITERATOR_TYPE;
+
   // Print the B+ tree
   void Print(BufferPoolManager *bpm);
 
@@ -161,6 +226,103 @@ class BPlusTree {
    */
   auto ToPrintableBPlusTree(page_id_t root_id) -> PrintableBPlusTree;
 
+  /**
+   * @brief Descend to the leaf that may hold key (the leftmost leaf if key is nullptr) with optimistic reads, checking
+   * every inner page against its version before following one of its children.
+   * @param[out] leaf the leaf, still to be validated after reading it; nullopt if the tree is empty
+   * @return false if a validation failed and the descent has to start over
+   */
+  auto DescendOptimistic(const KeyType *key, std::optional<OptimisticReadGuard> *leaf) -> bool;
+
+  /** @return the result of GetValue(), or nullopt if an optimistic read failed to validate */
+  auto TryGetValueOptimistic(const KeyType &key, std::vector<ValueType> *result) -> std::optional<bool>;
+
+  /**
+   * @brief Write latch the leaf that covers key, found with an optimistic descent.
+   * @return the guard of the leaf, or nullopt if the tree is empty or the descent failed BTREE_OPTIMISTIC_RETRIES
+   * times
+   */
+  auto LatchLeafOptimistic(const KeyType &key) -> std::optional<WritePageGuard>;
+
+  /** @return the result of Insert(), or nullopt if the insert needs the pessimistic path */
+  auto TryInsertOptimistic(const KeyType &key, const ValueType &value, Transaction *txn) -> std::optional<bool>;
+
+  /** @return true if Remove() is done, false if it needs the pessimistic path */
+  auto TryRemoveOptimistic(const KeyType &key, Transaction *txn) -> bool;
+
+  /** @return the level of a page, 0 for leaves */
+  static auto LevelOf(const BPlusTreePage *page) -> int;
+
+  /** @return the right sibling of a page if key lies at or past its high key, INVALID_PAGE_ID otherwise */
+  auto RightOfBLink(const BPlusTreePage *page, const KeyType &key) const -> page_id_t;
+
+  /**
+   * @brief Find the page at a level that covers key (the leftmost one if key is nullptr), latching one page at a time.
+   * @param[out] path if not nullptr, the pages passed on the way down, by level
+   * @return the read guard of the page, or nullopt if the tree is empty or not as high as level
+   */
+  auto DescendBLink(const KeyType *key, int level, std::vector<page_id_t> *path) -> std::optional<ReadPageGuard>;
+
+  /** @return the write guard of the page that covers key, moving right from page_id at the same level */
+  auto LatchBLink(page_id_t page_id, const KeyType &key) -> WritePageGuard;
+
+  auto GetValueBLink(const KeyType &key, std::vector<ValueType> *result) -> bool;
+  auto InsertBLink(const KeyType &key, const ValueType &value, Transaction *txn) -> bool;
+  void RemoveBLink(const KeyType &key);
+
+  /**
+   * @brief Split a full leaf while adding an entry to it.
+   * @return the separator, i.e. the new high key of the leaf, and the page id of the new right half
+   */
+  auto SplitLeafBLink(LeafPage *node, const KeyType &key, const ValueType &value) -> std::pair<KeyType, page_id_t>;
+
+  /**
+   * @brief Split a full internal page while adding an entry to it.
+   * @return the key moved up, i.e. the new high key of the page, and the page id of the new right half
+   */
+  auto SplitInternalBLink(InternalPage *node, const KeyType &key, page_id_t child) -> std::pair<KeyType, page_id_t>;
+
+  /**
+   * @brief Link a new right half into the level above it. No latch may be held, as this may have to latch the header.
+   * @param path the pages passed on the way down, used as a starting point on each level
+   */
+  void InsertParentBLink(KeyType key, page_id_t child, int level, const std::vector<page_id_t> &path);
+
+  /** @brief Put a new root above the root if it is still at level, which has split. */
+  void GrowRootBLink(int level);
+
+  /** @return an iterator at index of a leaf, or at the first entry after it if the leaf has no more entries */
+  auto IteratorAt(ReadPageGuard guard, int index) -> INDEXITERATOR_TYPE;
+
+  /**
+   * @brief Even out the last two pages of a level built by BulkLoad(), or merge them if they cannot both hold their
+   * minimum size. right_key is the separator of the right page, and is updated with it.
+   * @return true if the right page was merged into the left one
+   */
+  template <typename PageType>
+  auto BalanceLastPages(PageType *left, PageType *right, KeyType *right_key) -> bool;
+
+  /** @return the key to separate a page that ends with left from its right sibling that starts with right */
+  auto Separator(const KeyType &left, const KeyType &right) const -> KeyType;
+
+  /**
+   * @brief Remove key from its leaf for trees with compressed or variable-length keys, latching one page at a time on
+   * the way down, as long as the leaf stays at least half full.
+   * @return true if Remove() is done, false if it needs the pessimistic path to merge or redistribute the leaf
+   */
+  auto RemoveFromLeaf(const KeyType &key) -> bool;
+
+  /**
+   * @brief Find the largest key below key, or no greater than it if inclusive, or the largest of all if key is nullptr.
+   * The descent follows the last child that may hold such a key, and keeps the lowest key the child may hold; should
+   * the leaf it ends on have none, it starts over with that lower bound, which only goes down.
+   * @return a reverse iterator at the key found, or End()
+   */
+  auto SeekBefore(const KeyType *key, bool inclusive) -> INDEXITERATOR_TYPE;
+
+  /** @return the result of Begin() or Begin(*key), or nullopt if an optimistic read failed to validate */
+  auto TryBeginOptimistic(const KeyType *key) -> std::optional<INDEXITERATOR_TYPE>;
+
   // member variable
   std::string index_name_;
   BufferPoolManager *bpm_;
@@ -169,6 +331,10 @@ class BPlusTree {
   int leaf_max_size_;
   int internal_max_size_;
   page_id_t header_page_id_;
+  bool optimistic_reads_{true};
+  bool optimistic_writes_{true};
+  bool blink_{false};
+  KeyFormat key_format_{KeyFormat::PLAIN};
 };
 
 /**
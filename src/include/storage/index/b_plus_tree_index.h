@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -27,7 +28,14 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+  /**
+   * @param compress_keys whether the pages of the tree store their keys compressed, see BPlusTree::SetKeyCompression();
+   * their max sizes are then the largest that compressed pages allow. Indexes compared by a SerializedComparator always
+   * store their keys in pages with variable-length keys instead, see BPlusTree::SetVariableLengthKeys(), with the
+   * largest max sizes those allow.
+   */
+  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                 bool compress_keys = false);
 
   auto InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool override;
 
@@ -35,12 +43,26 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /**
+   * @brief Fill the index, which must be empty, from entries in any order. They are sorted by an ExternalSorter, which
+   * spills sorted runs to temporary files past BTREE_BULK_LOAD_RUN_SIZE entries, and handed to BPlusTree::BulkLoad().
+   * @param next yields the next key and RID, false when there are no more
+   * @return the number of entries loaded; of the entries with the same key, only the first one is
+   */
+  auto BulkLoad(const std::function<bool(Tuple *, RID *)> &next) -> size_t;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
 
+  /** @return an iterator over the keys from key up to upper_bound, inclusive */
+  auto GetBeginIterator(const KeyType &key, const KeyType &upper_bound) -> INDEXITERATOR_TYPE;
+
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
+  /** @return a reverse iterator from the largest key down, which ends at GetEndIterator() */
+  auto GetReverseBeginIterator() -> INDEXITERATOR_TYPE;
+
  protected:
   // comparator for key
   KeyComparator comparator_;
@@ -59,4 +81,12 @@ using BPlusTreeIndexIteratorForTwoIntegerColumn =
     IndexIterator<IntegerKeyType, IntegerValueType, IntegerComparatorType>;
 using IntegerHashFunctionType = HashFunction<IntegerKeyType>;
 
+/** Indexes with strings in their keys, which take as many bytes as they need in the pages of the tree. */
+
+constexpr static const auto VARCHAR_KEY_SIZE = 64;
+using VarcharKeyType = GenericKey<VARCHAR_KEY_SIZE>;
+using VarcharComparatorType = SerializedComparator<VARCHAR_KEY_SIZE>;
+using BPlusTreeIndexForVarcharColumns = BPlusTreeIndex<VarcharKeyType, RID, VarcharComparatorType>;
+using VarcharHashFunctionType = HashFunction<VarcharKeyType>;
+
 }  // namespace bustub
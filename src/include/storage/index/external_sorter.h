@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter.h
+//
+// Identification: src/include/storage/index/external_sorter.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define EXTERNAL_SORTER_TYPE ExternalSorter<KeyType, ValueType, KeyComparator>
+
+/**
+ * ExternalSorter sorts index entries by key, for BPlusTree::BulkLoad(), without holding all of them in memory.
+ *
+ * Entries are buffered until run_size of them have been added. The buffer is then sorted and spilled to a temporary
+ * file as a sorted run. Finish() sorts the last buffer, and Next() merges the runs through a heap, reading each run
+ * sequentially in blocks. If everything fits in one buffer, nothing touches the disk.
+ *
+ * The sort is stable: entries with equal keys come out in the order they were added.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExternalSorter {
+ public:
+  explicit ExternalSorter(const KeyComparator &comparator, size_t run_size = BTREE_BULK_LOAD_RUN_SIZE);
+
+  /** Closes the temporary files, which removes them. */
+  ~ExternalSorter();
+
+  DISALLOW_COPY_AND_MOVE(ExternalSorter);
+
+  /** @brief Add an entry. Must not be called after Finish(). */
+  void Add(const KeyType &key, const ValueType &value);
+
+  /** @brief Stop adding entries, and get ready to hand them out in order. */
+  void Finish();
+
+  /**
+   * @brief Get the next entry in key order. Must be called after Finish().
+   * @return false if all entries have been handed out
+   */
+  auto Next(MappingType *entry) -> bool;
+
+  /** @return the number of sorted runs spilled to disk so far */
+  auto NumSpilledRuns() const -> size_t { return runs_.size(); }
+
+ private:
+  /** A sorted run in a temporary file, and the block of it that is being merged. */
+  struct Run {
+    FILE *file_;
+    std::vector<MappingType> block_;
+    size_t pos_{0};
+  };
+
+  /** Entries read from a run at once while merging. */
+  static constexpr size_t RUN_BLOCK_SIZE = 1024;
+
+  /** @brief Sort the buffer stably. */
+  void SortBuffer();
+
+  /** @brief Sort the buffer and write it out as a new run. */
+  void SpillRun();
+
+  /** @brief Read the next block of a run. @return false if the run is exhausted */
+  auto RefillRun(Run *run) -> bool;
+
+  /** @return true if run a should be merged after run b, i.e. its head is larger, or equal and added later */
+  auto MergeAfter(size_t a, size_t b) const -> bool;
+
+  KeyComparator comparator_;
+  const size_t run_size_;
+  std::vector<MappingType> buffer_;
+  size_t buffer_pos_{0};
+  std::vector<Run> runs_;
+  /** Min-heap of the runs that still have entries, ordered by MergeAfter(). */
+  std::vector<size_t> heap_;
+  bool finished_{false};
+};
+
+}  // namespace bustub
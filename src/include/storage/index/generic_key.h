@@ -12,10 +12,15 @@
 
 #pragma once
 
+#include <array>
 #include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
 
 #include "storage/table/tuple.h"
 #include "type/value.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -32,7 +37,8 @@ class GenericKey {
   inline void SetFromKey(const Tuple &tuple) {
     // intialize to 0
     memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+    // Keys with strings may be longer than the key; keep what fits.
+    memcpy(data_, tuple.GetData(), std::min<size_t>(tuple.GetLength(), KeySize));
   }
 
   // NOTE: for test purpose only
@@ -94,13 +100,276 @@ class GenericComparator {
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  /**
+   * @return the key to separate lhs from rhs with in an internal page, where lhs < rhs: rhs, with the columns past the
+   * first one that tells them apart set to zero, or to their smallest value where rhs is negative. The result is still
+   * greater than lhs and no greater than rhs, but shares more bytes with the other separators, so that compressed pages
+   * store less of it. Columns that are not inlined are left as they are.
+   */
+  inline auto ShortestSeparator(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const
+      -> GenericKey<KeySize> {
+    GenericKey<KeySize> separator = rhs;
+    uint32_t column_count = key_schema_->GetColumnCount();
+    uint32_t i = 0;
+    while (i < column_count &&
+           lhs.ToValue(key_schema_, i).CompareLessThan(rhs.ToValue(key_schema_, i)) != CmpBool::CmpTrue) {
+      i++;
+    }
+    for (i++; i < column_count; i++) {
+      const auto &col = key_schema_->GetColumn(i);
+      Value value = rhs.ToValue(key_schema_, i);
+      if (!col.IsInlined() || value.IsNull()) {
+        continue;
+      }
+      Value zero = ValueFactory::GetZeroValueByType(col.GetType());
+      if (zero.CompareLessThanEquals(value) == CmpBool::CmpTrue) {
+        zero.SerializeTo(separator.data_ + col.GetOffset());
+      } else {
+        Type::GetMinValue(col.GetType()).SerializeTo(separator.data_ + col.GetOffset());
+      }
+    }
+    return separator;
+  }
+
+  /**
+   * @return true if the key columns are integers that fit in 8 bytes together, in which case IntegerCode() orders the
+   * keys as this comparator does, and pages search them by their codes
+   */
+  inline auto HasIntegerCodes() const -> bool { return integer_search_ && num_integer_columns_ > 0; }
+
+  /** @return true if the key is a lone BIGINT, whose code is its bytes read as an int64_t with the sign bit flipped */
+  inline auto HasInt64Keys() const -> bool { return HasIntegerCodes() && int64_key_; }
+
+  /**
+   * @return the integer columns of key, with their sign bits flipped, packed into an unsigned integer from the first
+   * column down, so that codes compare as the keys do. NULLs, which operator() does not order, come first.
+   */
+  inline auto IntegerCode(const GenericKey<KeySize> &key) const -> uint64_t {
+    if (int64_key_) {
+      uint64_t bits;
+      memcpy(&bits, key.data_, sizeof(bits));
+      return bits ^ (uint64_t{1} << 63);
+    }
+    uint64_t code = 0;
+    for (uint32_t i = 0; i < num_integer_columns_; i++) {
+      auto [offset, width] = integer_columns_[i];
+      uint64_t bits = 0;
+      memcpy(&bits, key.data_ + offset, width);
+      code = (code << (8 * width)) | (bits ^ (uint64_t{1} << (8 * width - 1)));
+    }
+    return code;
+  }
+
+  /** @brief Compare integer keys through operator() as any other, for benchmarks. */
+  void SetIntegerSearch(bool integer_search) { integer_search_ = integer_search; }
+
+  GenericComparator(const GenericComparator &other) = default;
 
   // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {
+    uint32_t width_sum = 0;
+    for (const auto &col : key_schema_->GetColumns()) {
+      TypeId type = col.GetType();
+      if (type != TypeId::TINYINT && type != TypeId::SMALLINT && type != TypeId::INTEGER && type != TypeId::BIGINT) {
+        num_integer_columns_ = 0;
+        return;
+      }
+      width_sum += col.GetFixedLength();
+      if (width_sum > sizeof(uint64_t) || col.GetOffset() + col.GetFixedLength() > KeySize) {
+        num_integer_columns_ = 0;
+        return;
+      }
+      integer_columns_[num_integer_columns_++] = {col.GetOffset(), col.GetFixedLength()};
+    }
+    int64_key_ = num_integer_columns_ == 1 && integer_columns_[0] == std::pair<uint32_t, uint32_t>{0, 8};
+  }
 
  private:
   Schema *key_schema_;
+  /** The offset and width of each key column, if they are all integers that fit in 8 bytes together */
+  std::array<std::pair<uint32_t, uint32_t>, sizeof(uint64_t)> integer_columns_{};
+  uint32_t num_integer_columns_{0};
+  bool int64_key_{false};
+  bool integer_search_{true};
+};
+
+/**
+ * Function object that compares generic keys by their serialized bytes, column by column, without deserializing them
+ * into Values: integers, booleans, decimals and timestamps by their fixed-length bytes, and strings by the bytes that
+ * their offsets point to, in the order that Value comparisons give them. NULLs, which Value comparisons leave
+ * unordered, compare as the values they are stored as, and NULL strings come before all others. A string cut short
+ * by the end of the key compares by the bytes that fit. Columns of other types are deserialized. B+ tree indexes that
+ * use it store their keys in pages with variable-length keys, see BPlusTreeIndex.
+ */
+template <size_t KeySize>
+class SerializedComparator {
+ public:
+  inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
+    for (uint32_t i = 0; i < columns_.size(); i++) {
+      int cmp = CompareColumn(lhs, rhs, i);
+      if (cmp != 0) {
+        return cmp;
+      }
+    }
+    return 0;
+  }
+
+  /**
+   * @return the key to separate lhs from rhs with in an internal page, where lhs < rhs: rhs, with the integer columns
+   * past the first one that tells them apart set to zero, or to their smallest value where rhs is negative. Should that
+   * column be the string stored last, it keeps only one byte more than it shares with lhs, and the key ends with it, so
+   * that pages with variable-length keys store fewer bytes of it.
+   */
+  inline auto ShortestSeparator(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const
+      -> GenericKey<KeySize> {
+    GenericKey<KeySize> separator = rhs;
+    uint32_t i = 0;
+    while (i < columns_.size() && CompareColumn(lhs, rhs, i) == 0) {
+      i++;
+    }
+    if (i == columns_.size()) {
+      return separator;
+    }
+    for (uint32_t j = i + 1; j < columns_.size(); j++) {
+      char *data = separator.data_ + columns_[j].offset_;
+      switch (columns_[j].type_) {
+        case TypeId::TINYINT:
+          SetMin<int8_t>(data);
+          break;
+        case TypeId::SMALLINT:
+          SetMin<int16_t>(data);
+          break;
+        case TypeId::INTEGER:
+          SetMin<int32_t>(data);
+          break;
+        case TypeId::BIGINT:
+          SetMin<int64_t>(data);
+          break;
+        default:
+          break;
+      }
+    }
+    if (columns_[i].type_ != TypeId::VARCHAR) {
+      return separator;
+    }
+    auto [rhs_offset, rhs_length] = StringAt(rhs, columns_[i].offset_);
+    for (const auto &column : columns_) {
+      if (column.type_ == TypeId::VARCHAR && StringAt(rhs, column.offset_).first > rhs_offset) {
+        return separator;
+      }
+    }
+    auto [lhs_offset, lhs_length] = StringAt(lhs, columns_[i].offset_);
+    int shared = 0;
+    while (lhs_offset >= 0 && shared < std::min(lhs_length, rhs_length) &&
+           lhs.data_[lhs_offset + shared] == rhs.data_[rhs_offset + shared]) {
+      shared++;
+    }
+    if (shared + 1 >= rhs_length) {
+      return separator;
+    }
+    // The length counts the terminating zero; the bytes past the string are zero, as in a key built from a tuple.
+    uint32_t length = shared + 2;
+    memcpy(separator.data_ + rhs_offset - sizeof(uint32_t), &length, sizeof(uint32_t));
+    memset(separator.data_ + rhs_offset + shared + 1, 0, KeySize - rhs_offset - shared - 1);
+    return separator;
+  }
+
+  SerializedComparator(const SerializedComparator &other) = default;
+
+  // constructor
+  explicit SerializedComparator(Schema *key_schema) : key_schema_(key_schema) {
+    for (const auto &col : key_schema_->GetColumns()) {
+      columns_.push_back({col.GetType(), col.GetOffset()});
+    }
+  }
+
+ private:
+  struct KeyColumn {
+    TypeId type_;
+    uint32_t offset_;
+  };
+
+  template <typename T>
+  static auto CompareFixed(const char *lhs, const char *rhs) -> int {
+    T lhs_value;
+    T rhs_value;
+    memcpy(&lhs_value, lhs, sizeof(T));
+    memcpy(&rhs_value, rhs, sizeof(T));
+    return static_cast<int>(rhs_value < lhs_value) - static_cast<int>(lhs_value < rhs_value);
+  }
+
+  template <typename T>
+  static void SetMin(char *data) {
+    T value;
+    memcpy(&value, data, sizeof(T));
+    value = value < 0 ? std::numeric_limits<T>::min() : 0;
+    memcpy(data, &value, sizeof(T));
+  }
+
+  /**
+   * @return the offset in key of the bytes of the string whose offset is at column_offset, and how many of them there
+   * are, without the terminating zero, up to the end of the key; the offset is -1 if the string is NULL
+   */
+  static auto StringAt(const GenericKey<KeySize> &key, uint32_t column_offset) -> std::pair<int, int> {
+    if (column_offset + sizeof(int32_t) > KeySize) {
+      return {-1, 0};
+    }
+    int32_t offset;
+    memcpy(&offset, key.data_ + column_offset, sizeof(int32_t));
+    if (offset < 0 || offset + sizeof(uint32_t) > KeySize) {
+      return {-1, 0};
+    }
+    uint32_t length;
+    memcpy(&length, key.data_ + offset, sizeof(uint32_t));
+    if (length == BUSTUB_VALUE_NULL) {
+      return {-1, 0};
+    }
+    int begin = offset + sizeof(uint32_t);
+    return {begin, std::min(std::max(static_cast<int>(length) - 1, 0), static_cast<int>(KeySize) - begin)};
+  }
+
+  auto CompareColumn(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs, uint32_t i) const -> int {
+    const char *lhs_data = lhs.data_ + columns_[i].offset_;
+    const char *rhs_data = rhs.data_ + columns_[i].offset_;
+    switch (columns_[i].type_) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        return CompareFixed<int8_t>(lhs_data, rhs_data);
+      case TypeId::SMALLINT:
+        return CompareFixed<int16_t>(lhs_data, rhs_data);
+      case TypeId::INTEGER:
+        return CompareFixed<int32_t>(lhs_data, rhs_data);
+      case TypeId::BIGINT:
+        return CompareFixed<int64_t>(lhs_data, rhs_data);
+      case TypeId::DECIMAL:
+        return CompareFixed<double>(lhs_data, rhs_data);
+      case TypeId::TIMESTAMP:
+        return CompareFixed<uint64_t>(lhs_data, rhs_data);
+      case TypeId::VARCHAR: {
+        auto [lhs_offset, lhs_length] = StringAt(lhs, columns_[i].offset_);
+        auto [rhs_offset, rhs_length] = StringAt(rhs, columns_[i].offset_);
+        if (lhs_offset < 0 || rhs_offset < 0) {
+          return static_cast<int>(lhs_offset >= 0) - static_cast<int>(rhs_offset >= 0);
+        }
+        int cmp = memcmp(lhs.data_ + lhs_offset, rhs.data_ + rhs_offset, std::min(lhs_length, rhs_length));
+        if (cmp == 0) {
+          cmp = lhs_length - rhs_length;
+        }
+        return static_cast<int>(cmp > 0) - static_cast<int>(cmp < 0);
+      }
+      default: {
+        Value lhs_value = lhs.ToValue(key_schema_, i);
+        Value rhs_value = rhs.ToValue(key_schema_, i);
+        if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
+          return -1;
+        }
+        return lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue ? 1 : 0;
+      }
+    }
+  }
+
+  Schema *key_schema_;
+  std::vector<KeyColumn> columns_;
 };
 
 }  // namespace bustub
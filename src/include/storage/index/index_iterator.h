@@ -14,20 +14,38 @@
  */
 #pragma once
 
+#include <deque>
+#include <optional>
+#include <vector>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
   // you may define your own constructor based on your member variables
   IndexIterator();
-  IndexIterator(BufferPoolManager *bufferPoolManager, page_id_t pid, int index, MappingType &entry);
+  /**
+   * @param comparator if not nullptr, the iterator finds its place again by key instead of by index on every step, as
+   * it must in a B-link tree, whose leaves may have changed or split since the last step
+   */
+  IndexIterator(BufferPoolManager *bufferPoolManager, page_id_t pid, int index, MappingType &entry,
+                const KeyComparator *comparator = nullptr);
   IndexIterator(BufferPoolManager *buffer_pool_manager, page_id_t page_id, int index);
+  /**
+   * A reverse iterator, which steps from larger keys to smaller ones, see BPlusTree::RBegin(). Leaves only link to
+   * their right, so each step off the first entry of a leaf descends the tree again, see BPlusTree::SeekBefore().
+   */
+  IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, page_id_t pid, int index, MappingType &entry);
   // IndexIterator();
   ~IndexIterator();  // NOLINT
 
@@ -37,6 +55,22 @@ class IndexIterator {
 
   auto operator++() -> IndexIterator &;
 
+  /**
+   * @brief Copy out the entries from the current one on, up to n of them and no further than the end of its leaf, all
+   * under one read latch, and move past them. Reverse iterators copy them out in descending order.
+   * @return the entries, empty at the end
+   */
+  auto NextBatch(size_t n) -> std::vector<MappingType>;
+
+  /**
+   * @brief End the iteration past the keys no greater than upper_bound, instead of at the end of the tree. Leaves past
+   * it are not read ahead either. Not for reverse iterators.
+   */
+  void SetUpperBound(const KeyType &upper_bound, const KeyComparator *comparator);
+
+  /** @brief Set the number of leaves read ahead of the one the iterator is on, see ReadAhead(). */
+  inline void SetPrefetchDistance(size_t distance) { prefetch_distance_ = distance; }
+
   auto operator==(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
 
   auto operator!=(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
@@ -46,11 +80,34 @@ class IndexIterator {
   auto operator!=(const IndexIterator &that) -> bool;
 
  private:
+  /** @brief Move to the first entry past entry_, starting from the leaf in guard. */
+  auto SeekPast(ReadPageGuard guard) -> IndexIterator &;
+
+  /** @brief Move to the entry after entry_, starting from the leaf in guard, then end at the upper bound. */
+  void Step(ReadPageGuard guard);
+
+  /** @brief Move to the entry before entry_, from the leaf in guard if it holds it, or else from the tree. */
+  void StepBack(ReadPageGuard guard);
+
+  /**
+   * Follow the next page ids past the leaves already read ahead, and have the buffer pool prefetch the leaves found,
+   * until the prefetch distance is covered, as TableIterator::ReadAhead() does for table pages.
+   */
+  void ReadAhead();
+
   // add your own private member variables here
   BufferPoolManager *bpm_;
   page_id_t pid_;
   int index_;
   MappingType entry_;
+  const KeyComparator *comparator_{nullptr};
+  // Set for reverse iterators only.
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_{nullptr};
+  std::optional<KeyType> upper_bound_;
+  const KeyComparator *bound_comparator_{nullptr};
+  size_t prefetch_distance_{SCAN_PREFETCH_DISTANCE};
+  // Leaves after the one the iterator is on that have been handed to the buffer pool for prefetching, in order.
+  std::deque<page_id_t> read_ahead_;
 };
 
 }  // namespace bustub
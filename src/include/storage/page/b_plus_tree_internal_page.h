@@ -12,6 +12,7 @@
 
 #include <queue>
 #include <string>
+#include <vector>
 
 #include "common/config.h"
 #include "storage/page/b_plus_tree_page.h"
@@ -19,8 +20,15 @@
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 12
+#define INTERNAL_PAGE_HEADER_SIZE (28 + sizeof(KeyType))
 #define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+// See LEAF_PAGE_COMPRESSED_SIZE.
+#define INTERNAL_PAGE_SLOT_AREA_SIZE (BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE - 2 * sizeof(KeyType))
+#define INTERNAL_PAGE_COMPRESSED_SIZE (2 * (INTERNAL_PAGE_SLOT_AREA_SIZE / sizeof(MappingType)) - 4)
+// See LEAF_PAGE_VARIABLE_LENGTH_SIZE.
+#define INTERNAL_PAGE_BODY_SIZE (BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE)
+#define INTERNAL_PAGE_VARIABLE_LENGTH_SIZE \
+  (2 * (INTERNAL_PAGE_BODY_SIZE / SlottedEntries<KeyType, ValueType>::MAX_ENTRY_SIZE) - 4)
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -33,6 +41,26 @@ namespace bustub {
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * Header format (size in byte, 28 bytes + key size in total):
+ *  --------------------------------------------------------------------------
+ * | PageType (4) | CurrentSize (4) | MaxSize (4) | NextPageId (4) | Level (4) |
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------------------------------------
+ * | HighKey (key size) | KeyFormat (1) | HasReference (1) | Prefix (1) | Suffix (1) | NumSlots (2) | HeapBegin (2) |
+ *  ---------------------------------------------------------------------------------------------------------------
+ *
+ * The right link, level and high key are only maintained by trees in B-link mode. The level counts from the leaves,
+ * which are at level 0.
+ *
+ * A compressed internal page stores its keys the way a compressed leaf does, see BPlusTreeLeafPage, except for the
+ * first key, which is kept whole in front of the reference key since it takes no part in searches.
+ *  ----------------------------------------------------------------------------------------------------
+ * | HEADER | KEY(0) | REFERENCE KEY | PAGE_ID(0) | KEY BYTES(1)+PAGE_ID(1) | ... | KEY BYTES(n)+PAGE_ID(n) |
+ *  ----------------------------------------------------------------------------------------------------
+ *
+ * An internal page with variable-length keys lays its entries out as a leaf does, see BPlusTreeLeafPage; the first
+ * key is left empty, and takes no bytes.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
@@ -41,12 +69,19 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   BPlusTreeInternalPage() = delete;
   BPlusTreeInternalPage(const BPlusTreeInternalPage &other) = delete;
 
+  /** The largest max size of a compressed internal page */
+  static constexpr int COMPRESSED_MAX_SIZE = INTERNAL_PAGE_COMPRESSED_SIZE;
+
+  /** The largest max size of an internal page with variable-length keys */
+  static constexpr int VARIABLE_LENGTH_MAX_SIZE = INTERNAL_PAGE_VARIABLE_LENGTH_SIZE;
+
   /**
    * Writes the necessary header information to a newly created page, must be called after
    * the creation of a new page to make a valid BPlusTreeInternalPage
    * @param max_size Maximal size of the page
+   * @param key_format how the page stores its keys
    */
-  void Init(int max_size = INTERNAL_PAGE_SIZE);
+  void Init(int max_size = INTERNAL_PAGE_SIZE, KeyFormat key_format = KeyFormat::PLAIN);
 
   /**
    * @param index The index of the key to get. Index must be non-zero.
@@ -78,6 +113,26 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   auto SetKeyValueAt(int index, KeyType key, ValueType value);
 
   auto FindValue(const KeyType &key, ValueType &value, const KeyComparator &comparator) const -> int;
+
+  auto GetNextPageId() const -> page_id_t;
+  void SetNextPageId(page_id_t next_page_id);
+  auto GetLevel() const -> int;
+  void SetLevel(int level);
+  auto GetHighKey() const -> KeyType;
+  void SetHighKey(const KeyType &high_key);
+
+  auto IsCompressed() const -> bool;
+  auto GetKeyFormat() const -> KeyFormat;
+
+  /** @return true if size entries fit in the page once key is one of them, see BPlusTreeLeafPage::Fits() */
+  auto Fits(int size, const KeyType &key) const -> bool;
+
+  /** @return true if size entries fit in the page once keys are among them, see BPlusTreeLeafPage::Fits() */
+  auto Fits(int size, const std::vector<KeyType> &keys) const -> bool;
+
+  /** @brief Narrow the slots or compact the heap of the page, see BPlusTreeLeafPage::Compact(). */
+  void Compact();
+
   /**
    * @brief For test only, return a string representing all keys in
    * this internal page, formatted as "(key1,key2,key3,...)"
@@ -105,6 +160,27 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   }
 
  private:
+  static auto SlotSize(int prefix_len, int suffix_len) -> int;
+
+  auto Reference() const -> const char *;
+  auto Reference() -> char *;
+  auto Slot(int index) const -> const char *;
+  auto Slot(int index) -> char *;
+
+  /** @brief Widen the slots of a compressed page, if need be, so that they can hold key. */
+  void Widen(const KeyType &key);
+
+  auto Entries() const -> SlottedEntries<KeyType, ValueType>;
+
+  page_id_t next_page_id_;
+  int level_;
+  KeyType high_key_;
+  KeyFormat key_format_;
+  bool has_reference_;
+  uint8_t prefix_len_;
+  uint8_t suffix_len_;
+  uint16_t num_slots_;
+  uint16_t heap_begin_;
   // Flexible array member for page data.
   MappingType array_[0];
 };
@@ -19,8 +19,16 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 16
+#define LEAF_PAGE_HEADER_SIZE (24 + sizeof(KeyType))
 #define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+// The bytes left for the slots of a compressed leaf after its reference key. A slot is never wider than an entry, so
+// half of the max size fits whatever the keys, and so do both halves of a split, see Fits().
+#define LEAF_PAGE_SLOT_AREA_SIZE (BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - sizeof(KeyType))
+#define LEAF_PAGE_COMPRESSED_SIZE (2 * (LEAF_PAGE_SLOT_AREA_SIZE / sizeof(MappingType)) - 2)
+// The same holds for the largest entries of a leaf with variable-length keys, with room for one more key, see Fits().
+#define LEAF_PAGE_BODY_SIZE (BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE)
+#define LEAF_PAGE_VARIABLE_LENGTH_SIZE \
+  (2 * (LEAF_PAGE_BODY_SIZE / SlottedEntries<KeyType, ValueType>::MAX_ENTRY_SIZE) - 2)
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
@@ -32,13 +40,34 @@ namespace bustub {
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 16 bytes in total):
+ *  Header format (size in byte, 24 bytes + key size in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * |  NextPageId (4)
- *  -----------------------------------------------
+ *  ----------------------------------------------------------------------------------------------------
+ * |  NextPageId (4) | HighKey (key size) | KeyFormat (1) | HasReference (1) | Prefix (1) | Suffix (1) |
+ *  ----------------------------------------------------------------------------------------------------
+ *  ---------------------------------
+ * | NumSlots (2) | HeapBegin (2) |
+ *  ---------------------------------
+ *
+ * The high key is only maintained by trees in B-link mode, where it bounds the keys of the page from above (exclusive)
+ * unless the page is the last leaf.
+ *
+ * A compressed leaf stores the first key written to it as a reference key, and only the bytes of each key that differ
+ * from it: all keys share the reference's first Prefix bytes and its last Suffix bytes, and their slots hold the
+ * bytes in between, followed by the value. The slots grow wider whenever a key shares less than that, so a page holds
+ * as many entries as fit, up to its max size; Fits() tells if one more would.
+ *  ------------------------------------------------------------------------------------
+ * | HEADER | REFERENCE KEY | KEY BYTES(1) + RID(1) | ... | KEY BYTES(n) + RID(n) |
+ *  ------------------------------------------------------------------------------------
+ *
+ * A leaf with variable-length keys keeps its entries in slots that point into a heap of key bytes at the back of the
+ * page, see SlottedEntries. Each key takes the bytes up to its last nonzero one, so short keys in a wide GenericKey,
+ * such as strings, leave room for more entries; Fits() tells if one more would fit, as for compressed leaves.
+ *  ------------------------------------------------------------------------------------------------------
+ * | HEADER | OFFSET(1) + LENGTH(1) + RID(1) | ... | OFFSET(n) + LENGTH(n) + RID(n) | FREE | KEY BYTES ... |
+ *  ------------------------------------------------------------------------------------------------------
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
@@ -47,21 +76,50 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   BPlusTreeLeafPage() = delete;
   BPlusTreeLeafPage(const BPlusTreeLeafPage &other) = delete;
 
+  /** The largest max size of a compressed leaf */
+  static constexpr int COMPRESSED_MAX_SIZE = LEAF_PAGE_COMPRESSED_SIZE;
+
+  /** The largest max size of a leaf with variable-length keys */
+  static constexpr int VARIABLE_LENGTH_MAX_SIZE = LEAF_PAGE_VARIABLE_LENGTH_SIZE;
+
   /**
    * After creating a new leaf page from buffer pool, must call initialize
    * method to set default values
    * @param max_size Max size of the leaf node
+   * @param key_format how the page stores its keys
    */
-  void Init(int max_size = LEAF_PAGE_SIZE);
+  void Init(int max_size = LEAF_PAGE_SIZE, KeyFormat key_format = KeyFormat::PLAIN);
 
   // helper methods
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
+  auto GetHighKey() const -> KeyType;
+  void SetHighKey(const KeyType &high_key);
   auto KeyAt(int index) const -> KeyType;
   auto ValueAt(int index) const -> ValueType;
   void SetKeyAt(int index, const KeyType &key);
   void SetValueAt(int index, const ValueType &value);
   auto FindValue(const KeyType &key, ValueType &value, const KeyComparator &comparator) const -> int;
+
+  auto IsCompressed() const -> bool;
+  auto GetKeyFormat() const -> KeyFormat;
+
+  /**
+   * @return true if size entries fit in the page once key is one of them. Plain pages hold as many entries as their
+   * max size allows, whatever the keys, so this is only ever false for compressed pages and those with variable-length
+   * keys.
+   */
+  auto Fits(int size, const KeyType &key) const -> bool;
+
+  /** @return true if size entries fit in the page once keys are among them, e.g. those of a page to merge with */
+  auto Fits(int size, const std::vector<KeyType> &keys) const -> bool;
+
+  /**
+   * @brief Narrow the slots of a compressed page down to what the keys it holds now differ in, or compact the heap of a
+   * page with variable-length keys.
+   */
+  void Compact();
+
   /**
    * @brief for test only return a string representing all keys in
    * this leaf page formatted as "(key1,key2,key3,...)"
@@ -88,7 +146,25 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   }
 
  private:
+  /** @return the width of a slot of a compressed page, if its keys share prefix_len and suffix_len bytes */
+  static auto SlotSize(int prefix_len, int suffix_len) -> int;
+
+  auto Slot(int index) const -> const char *;
+  auto Slot(int index) -> char *;
+
+  /** @brief Widen the slots of a compressed page, if need be, so that they can hold key. */
+  void Widen(const KeyType &key);
+
+  auto Entries() const -> SlottedEntries<KeyType, ValueType>;
+
   page_id_t next_page_id_;
+  KeyType high_key_;
+  KeyFormat key_format_;
+  bool has_reference_;
+  uint8_t prefix_len_;
+  uint8_t suffix_len_;
+  uint16_t num_slots_;
+  uint16_t heap_begin_;
   // Flexible array member for page data.
   MappingType array_[0];
 };
@@ -10,12 +10,16 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <climits>
 #include <cstdlib>
+#include <cstring>
 #include <string>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
 #include "storage/index/generic_key.h"
 
 namespace bustub {
@@ -27,6 +31,16 @@ namespace bustub {
 // define page type enum
 enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
 
+/** How the leaf and internal pages of a tree store their keys, see their page formats */
+enum class KeyFormat : uint8_t {
+  /** Whole keys, next to their values */
+  PLAIN = 0,
+  /** The bytes of each key that differ from a reference key, in slots that are all as wide */
+  COMPRESSED,
+  /** The bytes of each key up to its last nonzero one, in a heap that a slot array points into */
+  VARIABLE_LENGTH,
+};
+
 /**
  * Both internal and leaf page are inherited from this page.
  *
@@ -66,4 +80,228 @@ class BPlusTreePage {
   int max_size_ __attribute__((__unused__));
 };
 
+/** @return the number of leading bytes that a and b share, out of size */
+inline auto SharedPrefixLength(const char *a, const char *b, int size) -> int {
+  int length = 0;
+  while (length < size && a[length] == b[length]) {
+    length++;
+  }
+  return length;
+}
+
+/** @return the number of trailing bytes that a and b share, out of size */
+inline auto SharedSuffixLength(const char *a, const char *b, int size) -> int {
+  int length = 0;
+  while (length < size && a[size - 1 - length] == b[size - 1 - length]) {
+    length++;
+  }
+  return length;
+}
+
+/**
+ * The entries of a page with variable-length keys, laid out in the body_size bytes of the page past its header. Slots
+ * fill the body from the front, each holding the offset and the length of its key's bytes and then its value, and the
+ * keys' bytes fill it from the back, in a heap that grows towards the slots. Keys are zero-padded, so only the bytes up
+ * to the last nonzero one are stored, and KeyAt() pads them back. The page header keeps the number of slots in use and
+ * the offset at which the heap begins.
+ *
+ * A slot that takes a key no longer than the one it holds reuses its bytes; any other one takes new bytes off the heap,
+ * and when the heap runs into the slots, the first live slots are compacted and the rest dropped. Callers may fill
+ * slots before growing the size to cover them, so the live slots are those below the size or the slot being set,
+ * whichever is higher.
+ */
+template <typename KeyType, typename ValueType>
+class SlottedEntries {
+ public:
+  /** The bytes of a slot: the offset and length of its key, then its value */
+  static constexpr int SLOT_SIZE = 2 * sizeof(uint16_t) + sizeof(ValueType);
+
+  /** The most bytes an entry takes, its slot and its key whole */
+  static constexpr int MAX_ENTRY_SIZE = SLOT_SIZE + sizeof(KeyType);
+
+  SlottedEntries(const char *body, int body_size, const uint16_t *num_slots, const uint16_t *heap_begin)
+      : body_(const_cast<char *>(body)),
+        body_size_(body_size),
+        num_slots_(const_cast<uint16_t *>(num_slots)),
+        heap_begin_(const_cast<uint16_t *>(heap_begin)) {}
+
+  /** @return the number of bytes a key takes in the heap */
+  static auto KeyLength(const KeyType &key) -> int {
+    auto bytes = reinterpret_cast<const char *>(&key);
+    int length = sizeof(KeyType);
+    while (length > 0 && bytes[length - 1] == 0) {
+      length--;
+    }
+    return length;
+  }
+
+  /** @brief Empty the body. */
+  void Init() {
+    *num_slots_ = 0;
+    *heap_begin_ = body_size_;
+  }
+
+  auto KeyAt(int index) const -> KeyType {
+    KeyType key{};
+    if (index >= *num_slots_) {
+      return key;
+    }
+    // An optimistic reader may see a slot and the heap of different versions of the page; stay in bounds.
+    auto [offset, length] = SlotAt(index);
+    if ((index + 1) * SLOT_SIZE > body_size_ || length > static_cast<int>(sizeof(KeyType)) ||
+        offset + length > body_size_) {
+      throw Exception("index out of range", false);
+    }
+    memcpy(&key, body_ + offset, length);
+    return key;
+  }
+
+  auto ValueAt(int index) const -> ValueType {
+    ValueType value;
+    if ((index + 1) * SLOT_SIZE > body_size_) {
+      throw Exception("index out of range", false);
+    }
+    memcpy(&value, body_ + index * SLOT_SIZE + 2 * sizeof(uint16_t), sizeof(ValueType));
+    return value;
+  }
+
+  /** @brief Set the key of a slot; live is the number of slots in use, see the class comment. */
+  void SetKeyAt(int index, const KeyType &key, int live) {
+    Reserve(index, live);
+    int length = KeyLength(key);
+    auto [offset, old_length] = SlotAt(index);
+    if (length <= old_length) {
+      memcpy(body_ + offset, &key, length);
+      SetSlot(index, offset, length);
+      return;
+    }
+    SetSlot(index, body_size_, 0);
+    if (*heap_begin_ - length < *num_slots_ * SLOT_SIZE) {
+      Compact(std::max(live, index + 1));
+    }
+    BUSTUB_ASSERT(*heap_begin_ - length >= *num_slots_ * SLOT_SIZE, "no room for the key, see Fits()");
+    *heap_begin_ -= length;
+    memcpy(body_ + *heap_begin_, &key, length);
+    SetSlot(index, *heap_begin_, length);
+  }
+
+  void SetValueAt(int index, const ValueType &value, int live) {
+    Reserve(index, live);
+    memcpy(body_ + index * SLOT_SIZE + 2 * sizeof(uint16_t), &value, sizeof(ValueType));
+  }
+
+  /**
+   * @return true if size entries fit once key is one of them, besides the first live ones. Room is kept for one more
+   * key, whole, since moving entries along one by one holds a copy of one of them for a while.
+   */
+  auto Fits(int size, int live, const KeyType &key) const -> bool {
+    int bytes = size * SLOT_SIZE + KeyLength(key) + sizeof(KeyType);
+    for (int i = 0; i < std::min<int>(live, *num_slots_); i++) {
+      bytes += SlotAt(i).second;
+    }
+    return bytes <= body_size_;
+  }
+
+  /** @return true if size entries fit once keys are among them, besides the first live ones, see above */
+  auto Fits(int size, int live, const std::vector<KeyType> &keys) const -> bool {
+    int bytes = size * SLOT_SIZE + sizeof(KeyType);
+    for (int i = 0; i < std::min<int>(live, *num_slots_); i++) {
+      bytes += SlotAt(i).second;
+    }
+    for (const auto &key : keys) {
+      bytes += KeyLength(key);
+    }
+    return bytes <= body_size_;
+  }
+
+  /** @brief Move the keys of the first live slots to the back of the body, next to each other, and drop the rest. */
+  void Compact(int live) {
+    live = std::min<int>(live, *num_slots_);
+    std::vector<char> heap(body_size_);
+    int heap_begin = body_size_;
+    for (int i = 0; i < live; i++) {
+      auto [offset, length] = SlotAt(i);
+      heap_begin -= length;
+      memcpy(heap.data() + heap_begin, body_ + offset, length);
+      SetSlot(i, heap_begin, length);
+    }
+    memcpy(body_ + heap_begin, heap.data() + heap_begin, body_size_ - heap_begin);
+    *num_slots_ = live;
+    *heap_begin_ = heap_begin;
+  }
+
+ private:
+  auto SlotAt(int index) const -> std::pair<int, int> {
+    uint16_t slot[2];
+    memcpy(slot, body_ + index * SLOT_SIZE, sizeof(slot));
+    return {slot[0], slot[1]};
+  }
+
+  void SetSlot(int index, int offset, int length) {
+    uint16_t slot[2] = {static_cast<uint16_t>(offset), static_cast<uint16_t>(length)};
+    memcpy(body_ + index * SLOT_SIZE, slot, sizeof(slot));
+  }
+
+  /** @brief Bring the slots up to index into use, empty, making room for them first if need be. */
+  void Reserve(int index, int live) {
+    if (index < *num_slots_) {
+      return;
+    }
+    if ((index + 1) * SLOT_SIZE > *heap_begin_) {
+      Compact(std::max(live, index + 1));
+    }
+    BUSTUB_ASSERT((index + 1) * SLOT_SIZE <= *heap_begin_, "no room for the slot, see Fits()");
+    for (int i = *num_slots_; i <= index; i++) {
+      SetSlot(i, body_size_, 0);
+    }
+    *num_slots_ = index + 1;
+  }
+
+  char *body_;
+  int body_size_;
+  uint16_t *num_slots_;
+  uint16_t *heap_begin_;
+};
+
+/** The number of entries an integer key search narrows a page down to before it counts them off */
+static constexpr int INTEGER_SEARCH_WINDOW = 8;
+
+/** @return true if the CPU runs AVX2 instructions */
+auto HasAvx2() -> bool;
+
+/**
+ * @return the number of the n entries, stride bytes apart from each other starting at entries, whose keys are less
+ * than key, or no greater than it if inclusive. Each entry starts with its key, an int64_t, and the keys are in order.
+ * Requires HasAvx2().
+ */
+auto CountInt64KeysAvx2(const char *entries, size_t stride, int n, int64_t key, bool inclusive) -> int;
+
+/**
+ * @return the number of the n entries, stride bytes apart from each other starting at entries, whose key codes are
+ * less than code, or no greater than it if Inclusive; code_of() reads the code of an entry, and entries are in order
+ * of their codes. The search halves the range with conditional moves rather than branches on the keys, and counts off
+ * the last few entries, with AVX2 when the codes are plain int64_t keys (see GenericComparator::HasInt64Keys()).
+ */
+template <bool Inclusive, typename CodeOf>
+auto CountIntegerKeys(const char *entries, size_t stride, int n, uint64_t code, bool int64_keys, CodeOf code_of)
+    -> int {
+  int base = 0;
+  while (n > INTEGER_SEARCH_WINDOW) {
+    int half = n / 2;
+    uint64_t mid = code_of(entries + (base + half - 1) * stride);
+    base = (Inclusive ? mid <= code : mid < code) ? base + half : base;
+    n -= half;
+  }
+  if (int64_keys && HasAvx2()) {
+    return base + CountInt64KeysAvx2(entries + base * stride, stride, n,
+                                     static_cast<int64_t>(code ^ (uint64_t{1} << 63)), Inclusive);
+  }
+  int count = 0;
+  for (int i = 0; i < n; i++) {
+    uint64_t entry_code = code_of(entries + (base + i) * stride);
+    count += static_cast<int>(Inclusive ? entry_code <= code : entry_code < code);
+  }
+  return base + count;
+}
+
 }  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -37,7 +38,11 @@ class Page {
   }
 
   /** Default destructor. */
-  ~Page() { delete[] data_; }
+  ~Page() {
+    if (owns_data_) {
+      delete[] data_;
+    }
+  }
 
   /** @return the actual data contained within this page */
   inline auto GetData() -> char * { return data_; }
@@ -46,16 +51,25 @@ class Page {
   inline auto GetPageId() -> page_id_t { return page_id_; }
 
   /** @return the pin count of this page */
-  inline auto GetPinCount() -> int { return pin_count_; }
+  inline auto GetPinCount() -> int {
+    int pins = pin_count_.load();
+    return pins < 0 ? 0 : pins;
+  }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline auto IsDirty() -> bool { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. The version becomes odd until the latch is released. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1, std::memory_order_acq_rel);
+  }
 
-  /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  /** Release the page write latch, publishing the changes to optimistic readers with a new even version. */
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -63,6 +77,13 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * @return the version of the page, which every write latch holder bumps twice: it is odd while a writer holds the
+   * page, and a reader that sees the same even version before and after reading the data has read a consistent page.
+   * See OptimisticReadGuard.
+   */
+  inline auto GetVersion() const -> uint64_t { return version_.load(std::memory_order_acquire); }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -78,6 +99,12 @@ class Page {
   static constexpr size_t OFFSET_LSN = 4;
 
  private:
+  /**
+   * Constructor for the frames of the buffer pool. Their data lives in a slab owned by the buffer pool, which keeps it
+   * aligned for direct I/O. Zeros out the page data.
+   */
+  explicit Page(char *data) : data_(data), owns_data_(false) { ResetMemory(); }
+
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, BUSTUB_PAGE_SIZE); }
 
@@ -85,14 +112,21 @@ class Page {
   // Usually this should be stored as `char data_[BUSTUB_PAGE_SIZE]{};`. But to enable ASAN to detect page overflow,
   // we store it as a ptr.
   char *data_;
+  /** False if data_ is borrowed from the buffer pool's slab. */
+  bool owns_data_{true};
   /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  std::atomic<page_id_t> page_id_ = INVALID_PAGE_ID;
+  /**
+   * The pin count of this page. The buffer pool pins pages without holding its latch, so this is atomic; -1 marks a
+   * frame that is free or being reassigned and therefore cannot be pinned.
+   */
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Bumped on write latch and unlatch, see GetVersion(). */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
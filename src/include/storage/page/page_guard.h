@@ -1,5 +1,7 @@
 #pragma once
 
+#include <optional>
+
 #include "storage/page/page.h"
 
 namespace bustub {
@@ -81,6 +83,7 @@ class BasicPageGuard {
  private:
   friend class ReadPageGuard;
   friend class WritePageGuard;
+  friend class OptimisticReadGuard;
 
   BufferPoolManager *bpm_{nullptr};
   Page *page_{nullptr};
@@ -214,4 +217,51 @@ class WritePageGuard {
   BasicPageGuard guard_;
 };
 
+/**
+ * OptimisticReadGuard pins a page without taking its latch, for reads that are validated afterwards instead
+ * (optimistic lock coupling). The guard snapshots the page version when it is created, waiting for a writer that holds
+ * the page to finish first. Whatever is read through it may be torn by a concurrent writer, so nothing read may be
+ * trusted (e.g. followed as a page id) until Validate() has confirmed that no writer came by since the snapshot.
+ *
+ * Only changes made under the page write latch are detected, which is how every WritePageGuard writes.
+ */
+class OptimisticReadGuard {
+ public:
+  OptimisticReadGuard() = default;
+  OptimisticReadGuard(BufferPoolManager *bpm, Page *page);
+  OptimisticReadGuard(const OptimisticReadGuard &) = delete;
+  auto operator=(const OptimisticReadGuard &) -> OptimisticReadGuard & = delete;
+
+  OptimisticReadGuard(OptimisticReadGuard &&that) noexcept;
+  auto operator=(OptimisticReadGuard &&that) noexcept -> OptimisticReadGuard &;
+
+  /** @brief Unpin the page. There is no latch to release. */
+  void Drop();
+
+  ~OptimisticReadGuard();
+
+  /** @return true if no writer has latched the page since the guard was created */
+  auto Validate() const -> bool;
+
+  /**
+   * @brief Take the write latch of the page and hand the pin over to a WritePageGuard, provided that no writer has
+   * latched the page since the guard was created. This guard is empty afterwards either way.
+   * @return the write guard, or nullopt if the page may have changed since it was read
+   */
+  auto UpgradeWrite() -> std::optional<WritePageGuard>;
+
+  auto PageId() -> page_id_t { return guard_.PageId(); }
+
+  auto GetData() -> const char * { return guard_.GetData(); }
+
+  template <class T>
+  auto As() -> const T * {
+    return guard_.As<T>();
+  }
+
+ private:
+  BasicPageGuard guard_;
+  uint64_t version_{0};
+};
+
 }  // namespace bustub
@@ -63,9 +63,10 @@ class TableHeap {
   /**
    * Read a tuple from the table.
    * @param rid rid of the tuple to read
+   * @param access_type how the page is accessed, AccessType::Scan for sequential scans
    * @return the meta and tuple
    */
-  auto GetTuple(RID rid) -> std::pair<TupleMeta, Tuple>;
+  auto GetTuple(RID rid, AccessType access_type = AccessType::Unknown) -> std::pair<TupleMeta, Tuple>;
 
   /**
    * Read a tuple meta from the table. Note: if you want to get tuple and meta together, use `GetTuple` insead
@@ -84,6 +85,12 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /**
+   * Set how many pages ahead of their cursor the iterators of this table read in the background.
+   * @param distance number of pages to read ahead, 0 to disable read-ahead
+   */
+  inline void SetPrefetchDistance(size_t distance) { prefetch_distance_ = distance; }
+
   /**
    * Update a tuple in place. SHOULD NOT BE USED UNLESS YOU WANT TO OPTIMIZE FOR PROJECT 4.
    * @param meta new tuple meta
@@ -95,6 +102,7 @@ class TableHeap {
  private:
   BufferPoolManager *bpm_;
   page_id_t first_page_id_{INVALID_PAGE_ID};
+  size_t prefetch_distance_{SCAN_PREFETCH_DISTANCE};
 
   std::mutex latch_;
   page_id_t last_page_id_{INVALID_PAGE_ID}; /* protected by latch_ */
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <cassert>
+#include <deque>
 #include <memory>
 #include <utility>
 
@@ -48,6 +49,13 @@ class TableIterator {
   auto operator++() -> TableIterator &;
 
  private:
+  /**
+   * Follow the page chain past the pages already read ahead, and have the buffer pool prefetch the pages found, until
+   * the table's prefetch distance is covered. The chain is only followed through resident pages, so this never blocks
+   * on disk; whatever it cannot reach yet is picked up by a later call.
+   */
+  void ReadAhead();
+
   TableHeap *table_heap_;
   RID rid_;
 
@@ -55,6 +63,9 @@ class TableIterator {
   // Otherwise we will have dead loops when updating while scanning. (In project 4, update should be implemented as
   // deletion + insertion.)
   RID stop_at_rid_;
+
+  // Pages after the one the cursor is on that have been handed to the buffer pool for prefetching, in chain order.
+  std::deque<page_id_t> read_ahead_;
 };
 
 }  // namespace bustub
@@ -28,14 +28,17 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
   }
   auto optimized_plan = plan->CloneWithChildren(std::move(children));
 
+  // This rule runs before the sort + limit -> top-N rewrite, so an ORDER BY ... LIMIT n still has its sort here: it
+  // turns into a limit over the index scan.
   if (optimized_plan->GetType() == PlanType::Sort) {
     const auto &sort_plan = dynamic_cast<const SortPlanNode &>(*optimized_plan);
     const auto &order_bys = sort_plan.GetOrderBy();
 
     std::vector<uint32_t> order_by_column_ids;
+    // An index scans all ascending, or, backwards, all descending.
+    bool reverse = !order_bys.empty() && order_bys[0].first == OrderByType::DESC;
     for (const auto &[order_type, expr] : order_bys) {
-      // Order type is asc or default
-      if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT)) {
+      if ((order_type == OrderByType::DESC) != reverse || order_type == OrderByType::INVALID) {
         return optimized_plan;
       }
 
@@ -69,7 +72,7 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
             }
           }
           if (valid) {
-            return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
+            return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_, reverse);
           }
         }
       }
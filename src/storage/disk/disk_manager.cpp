@@ -14,9 +14,12 @@
 #include <cassert>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
+#include <typeinfo>
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -49,6 +52,16 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     }
   }
 
+  fsm_name_ = file_name_.substr(0, n) + ".fsm";
+  fsm_io_.open(fsm_name_, std::ios::binary | std::ios::in | std::ios::out);
+  if (!fsm_io_.is_open()) {
+    fsm_io_.clear();
+    fsm_io_.open(fsm_name_, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
+    if (!fsm_io_.is_open()) {
+      throw Exception("can't open free space file");
+    }
+  }
+
   std::scoped_lock scoped_db_io_latch(db_io_latch_);
   db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
   // directory or file does not exist
@@ -61,6 +74,36 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     }
   }
   buffer_used = nullptr;
+
+  // Recover the free space: every page up to the end of the file has been allocated, and the bitmap tells which of
+  // them have been given back since.
+  int db_size = GetFileSize(file_name_);
+  next_page_id_ = db_size > 0 ? (db_size + BUSTUB_PAGE_SIZE - 1) / BUSTUB_PAGE_SIZE : 0;
+  int fsm_size = GetFileSize(fsm_name_);
+  if (fsm_size > 0) {
+    free_bitmap_.resize(fsm_size);
+    fsm_io_.seekg(0);
+    fsm_io_.read(reinterpret_cast<char *>(free_bitmap_.data()), fsm_size);
+    fsm_io_.clear();
+  }
+  std::vector<page_id_t> beyond_end;
+  for (size_t byte = 0; byte < free_bitmap_.size(); ++byte) {
+    for (size_t bit = 0; bit < 8 && free_bitmap_[byte] != 0; ++bit) {
+      auto page_id = static_cast<page_id_t>(byte * 8 + bit);
+      if ((free_bitmap_[byte] & (1U << bit)) == 0) {
+        continue;
+      }
+      if (page_id < next_page_id_) {
+        free_pages_.insert(page_id);
+      } else {
+        beyond_end.push_back(page_id);
+      }
+    }
+  }
+  // Pages freed before they ever reached the file are simply past its end now; they will be allocated by growing it.
+  for (page_id_t page_id : beyond_end) {
+    MarkFree(page_id, false);
+  }
 }
 
 /**
@@ -71,6 +114,10 @@ void DiskManager::ShutDown() {
     std::scoped_lock scoped_db_io_latch(db_io_latch_);
     db_io_.close();
   }
+  {
+    std::scoped_lock scoped_alloc_latch(alloc_latch_);
+    fsm_io_.close();
+  }
   log_io_.close();
 }
 
@@ -93,6 +140,35 @@ void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
   db_io_.flush();
 }
 
+/**
+ * Write the contents of consecutive pages into disk file. The database file itself gets a single seek and flush;
+ * subclasses write the pages one by one through their WritePage(), unless they override this as well.
+ */
+auto DiskManager::WritePages(page_id_t first_page_id, const std::vector<const char *> &pages_data) -> size_t {
+  if (pages_data.empty()) {
+    return 0;
+  }
+  if (typeid(*this) != typeid(DiskManager)) {
+    for (size_t i = 0; i < pages_data.size(); ++i) {
+      WritePage(first_page_id + static_cast<page_id_t>(i), pages_data[i]);
+    }
+    return pages_data.size();
+  }
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  size_t offset = static_cast<size_t>(first_page_id) * BUSTUB_PAGE_SIZE;
+  num_writes_ += static_cast<int>(pages_data.size());
+  db_io_.seekp(offset);
+  for (const char *page_data : pages_data) {
+    db_io_.write(page_data, BUSTUB_PAGE_SIZE);
+  }
+  if (db_io_.bad()) {
+    LOG_DEBUG("I/O error while writing");
+    return 1;
+  }
+  db_io_.flush();
+  return 1;
+}
+
 /**
  * Read the contents of the specified page into the given memory area
  */
@@ -122,6 +198,86 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   }
 }
 
+void DiskManager::WritePageAsync(page_id_t page_id, const char *page_data, std::function<void()> callback) {
+  WritePage(page_id, page_data);
+  callback();
+}
+
+void DiskManager::ReadPageAsync(page_id_t page_id, char *page_data, std::function<void()> callback) {
+  ReadPage(page_id, page_data);
+  callback();
+}
+
+auto DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> {
+  auto promise = std::make_shared<std::promise<void>>();
+  auto future = promise->get_future();
+  WritePageAsync(page_id, page_data, [promise] { promise->set_value(); });
+  return future;
+}
+
+auto DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> {
+  auto promise = std::make_shared<std::promise<void>>();
+  auto future = promise->get_future();
+  ReadPageAsync(page_id, page_data, [promise] { promise->set_value(); });
+  return future;
+}
+
+/**
+ * Allocate a page, lowest free page first
+ */
+auto DiskManager::AllocatePage() -> page_id_t {
+  std::scoped_lock scoped_alloc_latch(alloc_latch_);
+  if (free_pages_.empty()) {
+    return next_page_id_++;
+  }
+  page_id_t page_id = *free_pages_.begin();
+  free_pages_.erase(free_pages_.begin());
+  MarkFree(page_id, false);
+  return page_id;
+}
+
+/**
+ * Give a page back to the free space
+ */
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock scoped_alloc_latch(alloc_latch_);
+  if (page_id < 0 || page_id >= next_page_id_ || !free_pages_.insert(page_id).second) {
+    return;
+  }
+  MarkFree(page_id, true);
+}
+
+void DiskManager::SetNextPageId(page_id_t next_page_id) {
+  std::scoped_lock scoped_alloc_latch(alloc_latch_);
+  next_page_id_ = next_page_id;
+}
+
+auto DiskManager::GetNumFreePages() -> size_t {
+  std::scoped_lock scoped_alloc_latch(alloc_latch_);
+  return free_pages_.size();
+}
+
+void DiskManager::MarkFree(page_id_t page_id, bool is_free) {
+  size_t byte = static_cast<size_t>(page_id) / 8;
+  if (byte >= free_bitmap_.size()) {
+    free_bitmap_.resize(byte + 1);
+  }
+  auto mask = static_cast<uint8_t>(1U << (page_id % 8));
+  free_bitmap_[byte] = is_free ? (free_bitmap_[byte] | mask) : (free_bitmap_[byte] & ~mask);
+  if (!fsm_io_.is_open()) {
+    return;
+  }
+  // The bitmap is written through, so a page is not handed out twice after the process crashes. It is not synced,
+  // though, so this does not hold across an OS crash.
+  fsm_io_.seekp(byte);
+  fsm_io_.write(reinterpret_cast<const char *>(&free_bitmap_[byte]), 1);
+  if (fsm_io_.bad()) {
+    LOG_DEBUG("I/O error while writing free space");
+    return;
+  }
+  fsm_io_.flush();
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
@@ -12,7 +12,9 @@
 
 #include "storage/disk/disk_manager_memory.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
 #include <cstring>
 #include <iostream>
@@ -21,6 +23,7 @@
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/util/string_util.h"
 
 namespace bustub {
 
@@ -47,4 +50,76 @@ void DiskManagerMemory::ReadPage(page_id_t page_id, char *page_data) {
   memcpy(page_data, memory_ + offset, BUSTUB_PAGE_SIZE);
 }
 
+auto DeviceModel::FromString(const std::string &spec) -> DeviceModel {
+  DeviceModel model;
+  for (const auto &entry : StringUtil::Split(spec, ',')) {
+    auto pos = entry.find('=');
+    if (pos == std::string::npos) {
+      throw Exception("malformed device model entry: " + entry);
+    }
+    auto key = entry.substr(0, pos);
+    size_t value;
+    try {
+      value = std::stoul(entry.substr(pos + 1));
+    } catch (const std::logic_error &) {
+      throw Exception("malformed device model entry: " + entry);
+    }
+    if (key == "read") {
+      model.read_.mean_ = std::chrono::microseconds(value);
+    } else if (key == "read-stddev") {
+      model.read_.stddev_ = std::chrono::microseconds(value);
+    } else if (key == "write") {
+      model.write_.mean_ = std::chrono::microseconds(value);
+    } else if (key == "write-stddev") {
+      model.write_.stddev_ = std::chrono::microseconds(value);
+    } else if (key == "bandwidth") {
+      model.bandwidth_ = value * 1000 * 1000;
+    } else if (key == "queue-depth") {
+      model.queue_depth_ = value;
+    } else {
+      throw Exception("unknown device model key: " + key);
+    }
+  }
+  return model;
+}
+
+void DiskManagerUnlimitedMemory::SetDeviceModel(const DeviceModel &model) {
+  std::unique_lock<std::mutex> l(device_latch_);
+  model_ = model;
+  channel_free_at_ = std::chrono::steady_clock::now();
+  simulate_device_ = model.read_.mean_.count() > 0 || model.write_.mean_.count() > 0 || model.bandwidth_ > 0 ||
+                     model.queue_depth_ > 0;
+}
+
+void DiskManagerUnlimitedMemory::SimulateIO(bool is_write) {
+  std::unique_lock<std::mutex> l(device_latch_);
+  slot_cv_.wait(l, [&] { return model_.queue_depth_ == 0 || in_flight_ < model_.queue_depth_; });
+  in_flight_++;
+
+  auto now = std::chrono::steady_clock::now();
+  const LatencyModel &latency = is_write ? model_.write_ : model_.read_;
+  auto mean = static_cast<double>(latency.mean_.count());
+  auto stddev = static_cast<double>(latency.stddev_.count());
+  auto done = now + latency.mean_;
+  if (mean > 0 && stddev > 0) {
+    // Pick the parameters of the log-normal distribution so that it has the requested mean and deviation.
+    double sigma2 = std::log1p(stddev * stddev / (mean * mean));
+    std::lognormal_distribution<double> dist(std::log(mean) - sigma2 / 2, std::sqrt(sigma2));
+    done = now + std::chrono::microseconds(static_cast<int64_t>(dist(gen_)));
+  }
+  if (model_.bandwidth_ > 0) {
+    auto transfer = std::chrono::nanoseconds(static_cast<int64_t>(BUSTUB_PAGE_SIZE * 1e9 / model_.bandwidth_));
+    channel_free_at_ = std::max(now, channel_free_at_) + transfer;
+    done = std::max(done, channel_free_at_);
+  }
+  l.unlock();
+
+  std::this_thread::sleep_until(done);
+
+  l.lock();
+  in_flight_--;
+  l.unlock();
+  slot_cv_.notify_one();
+}
+
 }  // namespace bustub
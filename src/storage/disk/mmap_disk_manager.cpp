@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_disk_manager.cpp
+//
+// Identification: src/storage/disk/mmap_disk_manager.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/mmap_disk_manager.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <mutex>  // NOLINT
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+MmapDiskManager::MmapDiskManager(const std::string &db_file, bool read_only) : read_only_(read_only) {
+  file_name_ = db_file;
+  fd_ = read_only ? open(db_file.c_str(), O_RDONLY) : open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  std::unique_lock<std::shared_mutex> l(map_latch_);
+  Remap();
+  SetNextPageId(static_cast<page_id_t>((map_size_ + BUSTUB_PAGE_SIZE - 1) / BUSTUB_PAGE_SIZE));
+}
+
+MmapDiskManager::~MmapDiskManager() {
+  if (map_ != nullptr) {
+    munmap(map_, map_size_);
+  }
+  close(fd_);
+}
+
+void MmapDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  if (read_only_) {
+    throw Exception("can't write to a read-only db file");
+  }
+  auto offset = static_cast<off_t>(page_id) * BUSTUB_PAGE_SIZE;
+  num_writes_ += 1;
+  // The mapping shares the page cache with the file, so it sees the write without being touched.
+  if (pwrite(fd_, page_data, BUSTUB_PAGE_SIZE, offset) != BUSTUB_PAGE_SIZE) {
+    LOG_DEBUG("I/O error while writing");
+  }
+}
+
+void MmapDiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  std::shared_lock<std::shared_mutex> l(map_latch_);
+  if (offset + BUSTUB_PAGE_SIZE > map_size_) {
+    // The file may have grown since it was mapped.
+    l.unlock();
+    {
+      std::unique_lock<std::shared_mutex> ul(map_latch_);
+      Remap();
+    }
+    l.lock();
+  }
+  if (offset >= map_size_) {
+    LOG_DEBUG("I/O error reading past end of file");
+    memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    return;
+  }
+  size_t read_count = std::min<size_t>(BUSTUB_PAGE_SIZE, map_size_ - offset);
+  memcpy(page_data, map_ + offset, read_count);
+  if (read_count < BUSTUB_PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+  }
+}
+
+void MmapDiskManager::AdviseAccess(page_id_t page_id, AccessType access_type) {
+  // One system call per window of read-ahead is enough. Each call covers the next window as well, so that the kernel
+  // is already reading it by the time the scan gets there.
+  if (access_type != AccessType::Scan || page_id % MMAP_SCAN_READAHEAD != 0) {
+    return;
+  }
+  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  std::shared_lock<std::shared_mutex> l(map_latch_);
+  if (offset >= map_size_) {
+    return;
+  }
+  size_t length = std::min<size_t>(2 * MMAP_SCAN_READAHEAD * BUSTUB_PAGE_SIZE, map_size_ - offset);
+  madvise(map_ + offset, length, MADV_WILLNEED);
+}
+
+void MmapDiskManager::Remap() {
+  struct stat stat_buf;
+  if (fstat(fd_, &stat_buf) != 0 || static_cast<size_t>(stat_buf.st_size) <= map_size_) {
+    return;
+  }
+  auto size = static_cast<size_t>(stat_buf.st_size);
+  // Pages are only ever copied out of the mapping; writes go through the file descriptor.
+  void *map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd_, 0);
+  if (map == MAP_FAILED) {
+    LOG_DEBUG("can't map db file");
+    return;
+  }
+  madvise(map, size, MADV_RANDOM);
+  if (map_ != nullptr) {
+    munmap(map_, map_size_);
+  }
+  map_ = static_cast<char *>(map);
+  map_size_ = size;
+}
+
+}  // namespace bustub
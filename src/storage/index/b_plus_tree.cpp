@@ -1,9 +1,12 @@
 #include "storage/index/b_plus_tree.h"
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <optional>
 #include <sstream>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include "common/config.h"
 #include "common/exception.h"
@@ -39,7 +42,51 @@ INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::IsEmpty() const -> bool {
   ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
   auto head_page = guard.As<BPlusTreeHeaderPage>();
-  return head_page->root_page_id_ == INVALID_PAGE_ID;
+  if (head_page->root_page_id_ == INVALID_PAGE_ID) {
+    return true;
+  }
+  if (!blink_ && key_format_ == KeyFormat::PLAIN) {
+    return false;
+  }
+  // B-link trees and trees with compressed or variable-length keys keep their pages when they run out of keys: look
+  // for a leaf that still has some.
+  ReadPageGuard page_guard = bpm_->FetchPageRead(head_page->root_page_id_);
+  guard.Drop();
+  while (!page_guard.As<BPlusTreePage>()->IsLeafPage()) {
+    page_guard = bpm_->FetchPageRead(page_guard.As<InternalPage>()->ValueAt(0));
+  }
+  while (page_guard.As<LeafPage>()->GetSize() == 0) {
+    page_id_t next_page_id = page_guard.As<LeafPage>()->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      return true;
+    }
+    page_guard = bpm_->FetchPageRead(next_page_id, AccessType::Scan);
+  }
+  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetBLink(bool enable) {
+  BUSTUB_ASSERT(GetRootPageId() == INVALID_PAGE_ID, "the protocol of a tree can only be changed while it is empty");
+  blink_ = enable;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetKeyCompression(bool enable) {
+  BUSTUB_ASSERT(GetRootPageId() == INVALID_PAGE_ID, "the page format of a tree can only be changed while it is empty");
+  BUSTUB_ASSERT(!enable || (leaf_max_size_ <= LeafPage::COMPRESSED_MAX_SIZE &&
+                            internal_max_size_ <= InternalPage::COMPRESSED_MAX_SIZE),
+                "max sizes too large for compressed pages");
+  key_format_ = enable ? KeyFormat::COMPRESSED : KeyFormat::PLAIN;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetVariableLengthKeys(bool enable) {
+  BUSTUB_ASSERT(GetRootPageId() == INVALID_PAGE_ID, "the page format of a tree can only be changed while it is empty");
+  BUSTUB_ASSERT(!enable || (leaf_max_size_ <= LeafPage::VARIABLE_LENGTH_MAX_SIZE &&
+                            internal_max_size_ <= InternalPage::VARIABLE_LENGTH_MAX_SIZE),
+                "max sizes too large for pages with variable-length keys");
+  key_format_ = enable ? KeyFormat::VARIABLE_LENGTH : KeyFormat::PLAIN;
 }
 /*****************************************************************************
  * SEARCH
@@ -55,13 +102,22 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   Context ctx;
   (void)ctx;
   // throw Exception("Get先异常");
-  LOG_INFO("Get key : %s", std::to_string(key.ToString()).c_str());
+  LOG_TRACE("Get key : %s", std::to_string(key.ToString()).c_str());
   // if (GetRootPageId() == INVALID_PAGE_ID) {
   //   return false;
   // }
   if (header_page_id_ == INVALID_PAGE_ID) {
     return false;
   }
+  if (blink_) {
+    return GetValueBLink(key, result);
+  }
+  for (int attempt = 0; optimistic_reads_ && attempt < BTREE_OPTIMISTIC_RETRIES; attempt++) {
+    auto found = TryGetValueOptimistic(key, result);
+    if (found.has_value()) {
+      return *found;
+    }
+  }
   ReadPageGuard head_guard = bpm_->FetchPageRead(header_page_id_);
   auto head_node = head_guard.As<BPlusTreeHeaderPage>();
 
@@ -90,6 +146,120 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   return false;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::DescendOptimistic(const KeyType *key, std::optional<OptimisticReadGuard> *leaf) -> bool {
+  OptimisticReadGuard guard = bpm_->FetchPageOptimistic(header_page_id_);
+  page_id_t next_page_id = guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (!guard.Validate()) {
+    return false;
+  }
+  if (next_page_id == INVALID_PAGE_ID) {
+    *leaf = std::nullopt;
+    return true;
+  }
+  while (true) {
+    OptimisticReadGuard child = bpm_->FetchPageOptimistic(next_page_id);
+    // The parent still has to point to the child now that the child's version is taken: a split or merge that moved
+    // keys away from the child changes the parent before its writer lets go of the child.
+    if (!guard.Validate()) {
+      return false;
+    }
+    guard = std::move(child);
+    if (guard.As<BPlusTreePage>()->IsLeafPage()) {
+      break;
+    }
+    auto internal_node = guard.As<InternalPage>();
+    if (key == nullptr) {
+      next_page_id = internal_node->ValueAt(0);
+    } else {
+      internal_node->FindValue(*key, next_page_id, comparator_);
+    }
+    // Never follow a page id that may have been torn by a writer.
+    if (!guard.Validate()) {
+      return false;
+    }
+  }
+  *leaf = std::move(guard);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::TryGetValueOptimistic(const KeyType &key, std::vector<ValueType> *result)
+    -> std::optional<bool> {
+  // A torn read can trip the bounds checks of the page accessors; that is just another failed validation.
+  try {
+    std::optional<OptimisticReadGuard> guard;
+    if (!DescendOptimistic(&key, &guard)) {
+      return std::nullopt;
+    }
+    if (!guard.has_value()) {
+      return false;
+    }
+    auto leaf_node = guard->As<LeafPage>();
+    ValueType value;
+    int index = leaf_node->FindValue(key, value, comparator_);
+    bool found = index != -1 && comparator_(leaf_node->KeyAt(index), key) == 0;
+    if (found) {
+      value = leaf_node->ValueAt(index);
+    }
+    if (!guard->Validate()) {
+      return std::nullopt;
+    }
+    if (found) {
+      result->push_back(value);
+    }
+    return found;
+  } catch (Exception &) {
+    return std::nullopt;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::LatchLeafOptimistic(const KeyType &key) -> std::optional<WritePageGuard> {
+  for (int attempt = 0; attempt < BTREE_OPTIMISTIC_RETRIES; attempt++) {
+    std::optional<OptimisticReadGuard> leaf;
+    try {
+      if (!DescendOptimistic(&key, &leaf)) {
+        continue;
+      }
+    } catch (Exception &) {
+      continue;
+    }
+    if (!leaf.has_value()) {
+      return std::nullopt;
+    }
+    // The parent was validated after the leaf's version was taken, so if the leaf is unchanged once latched, it still
+    // covers key: whoever moves keys out of a leaf latches it.
+    auto guard = leaf->UpgradeWrite();
+    if (guard.has_value()) {
+      return guard;
+    }
+  }
+  return std::nullopt;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::TryInsertOptimistic(const KeyType &key, const ValueType &value, Transaction *txn)
+    -> std::optional<bool> {
+  std::optional<WritePageGuard> guard = LatchLeafOptimistic(key);
+  if (!guard.has_value()) {
+    return std::nullopt;
+  }
+  auto leaf_node = guard->As<LeafPage>();
+  ValueType v;
+  int index = leaf_node->FindValue(key, v, comparator_);
+  if (index != -1 && comparator_(leaf_node->KeyAt(index), key) == 0) {
+    return false;
+  }
+  if (!leaf_node->IsInsertSafe() || !leaf_node->Fits(leaf_node->GetSize() + 1, key)) {
+    return std::nullopt;
+  }
+  // A safe leaf never splits, so InsertLeafNode() does not need the path in the context.
+  Context ctx;
+  InsertLeafNode(guard->AsMut<LeafPage>(), key, value, ctx, txn);
+  return true;
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -106,7 +276,16 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   // std::cout << "Thread ID: " << thread << " -- Find | key : " << std::to_string(key.ToString()).c_str() << std::endl;
   Context ctx;
   (void)ctx;
-  LOG_INFO("Insert key : %s", std::to_string(key.ToString()).c_str());
+  LOG_TRACE("Insert key : %s", std::to_string(key.ToString()).c_str());
+  if (blink_) {
+    return InsertBLink(key, value, txn);
+  }
+  if (optimistic_writes_) {
+    auto inserted = TryInsertOptimistic(key, value, txn);
+    if (inserted.has_value()) {
+      return *inserted;
+    }
+  }
 
   ctx.header_page_ = bpm_->FetchPageWrite(header_page_id_);
   auto head_page = ctx.header_page_.value().AsMut<BPlusTreeHeaderPage>();
@@ -116,7 +295,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
     WritePageGuard guard1 = bpm_->FetchPageWrite(head_page->root_page_id_);
     auto leaf_node = guard1.AsMut<LeafPage>();
     ctx.root_page_id_ = head_page->root_page_id_;
-    leaf_node->Init(leaf_max_size_);
+    leaf_node->Init(leaf_max_size_, key_format_);
     leaf_node->IncreaseSize(1);
     leaf_node->SetKeyAt(0, key);
     leaf_node->SetValueAt(0, value);
@@ -160,7 +339,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::InsertLeafNode(LeafPage *node, const KeyType &key, const ValueType &value, Context &ctx,
                                     Transaction *txn) -> void {
-  if (node->GetSize() + 1 == node->GetMaxSize()) {
+  if (node->GetSize() + 1 == node->GetMaxSize() || !node->Fits(node->GetSize() + 1, key)) {
     SplitLeafNode(node, key, value, ctx, txn);
   } else {
     ValueType v;
@@ -185,17 +364,16 @@ auto BPLUSTREE_TYPE::SplitLeafNode(LeafPage *node, const KeyType &key, const Val
   bpm_->NewPageGuarded(&pid);
   WritePageGuard w_guard = bpm_->FetchPageWrite(pid);
   auto new_leaf_node = w_guard.AsMut<LeafPage>();
-  new_leaf_node->Init(leaf_max_size_);
+  new_leaf_node->Init(leaf_max_size_, key_format_);
   bool put_left = false;
 
-  for (int i = node->GetMinSize() - 1; i < node->GetMinSize(); i++) {
-    if (comparator_(key, node->KeyAt(i)) < 0) {
-      put_left = true;
-      break;
-    }
+  // A compressed leaf, or one with variable-length keys, may run out of room before it is full, so the halves are taken
+  // from its size.
+  int mid = (node->GetSize() + 1) / 2 - 1;
+  if (comparator_(key, node->KeyAt(mid)) < 0) {
+    put_left = true;
   }
   if (put_left) {
-    int mid = node->GetMinSize() - 1;
     int num = 0;
     for (int i = mid, j = 0; i < node->GetSize(); j++, i++) {
       new_leaf_node->SetKeyAt(j, node->KeyAt(i));
@@ -219,7 +397,6 @@ auto BPLUSTREE_TYPE::SplitLeafNode(LeafPage *node, const KeyType &key, const Val
     node->SetValueAt(index, value);
 
   } else {
-    int mid = node->GetMinSize() - 1;
     int num = 0;
     for (int i = mid + 1, j = 0; i < node->GetSize(); j++, i++) {
       new_leaf_node->SetKeyAt(j, node->KeyAt(i));
@@ -246,8 +423,9 @@ auto BPLUSTREE_TYPE::SplitLeafNode(LeafPage *node, const KeyType &key, const Val
   page_id_t nxt = node->GetNextPageId();
   new_leaf_node->SetNextPageId(nxt);
   node->SetNextPageId(pid);
+  node->Compact();
 
-  InsertParent(new_leaf_node->KeyAt(0), pid, ctx, txn);
+  InsertParent(Separator(node->KeyAt(node->GetSize() - 1), new_leaf_node->KeyAt(0)), pid, ctx, txn);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -257,7 +435,7 @@ auto BPLUSTREE_TYPE::SplitInternalNode(InternalPage *node, const KeyType &key, c
   KeyType up_key{};
   page_id_t up_key_value;
 
-  int mid = node->GetMinSize() - 1;
+  int mid = (node->GetSize() + 1) / 2 - 1;
   bool put_left = false;
   if (comparator_(key, node->KeyAt(mid)) < 0) {
     put_left = true;
@@ -290,7 +468,7 @@ auto BPLUSTREE_TYPE::SplitInternalNode(InternalPage *node, const KeyType &key, c
   WritePageGuard w_guard = bpm_->FetchPageWrite(pid);
 
   auto new_internal_node = w_guard.AsMut<InternalPage>();
-  new_internal_node->Init(internal_max_size_);
+  new_internal_node->Init(internal_max_size_, key_format_);
   new_internal_node->IncreaseSize(1);
   int num = 0;
   for (int i = mid, j = 1; i < node->GetSize(); i++, j++) {
@@ -324,6 +502,7 @@ auto BPLUSTREE_TYPE::SplitInternalNode(InternalPage *node, const KeyType &key, c
     new_internal_node->SetKeyAt(0, KeyType{});
     new_internal_node->SetValueAt(0, up_key_value);
   }
+  node->Compact();
 
   InsertParent(up_key, pid, ctx);
 }
@@ -346,7 +525,7 @@ auto BPLUSTREE_TYPE::InsertParent(const KeyType &key, const page_id_t &value, Co
     ctx.root_page_id_ = head_page->root_page_id_;
     auto new_root_node = new_root_guard.AsMut<InternalPage>();
 
-    new_root_node->Init(internal_max_size_);
+    new_root_node->Init(internal_max_size_, key_format_);
     new_root_node->IncreaseSize(1);
     new_root_node->IncreaseSize(1);
     new_root_node->SetKeyAt(1, key);
@@ -363,7 +542,8 @@ auto BPLUSTREE_TYPE::InsertParent(const KeyType &key, const page_id_t &value, Co
 
   auto internal_node = guard.AsMut<InternalPage>();
 
-  if (internal_node->GetSize() == internal_node->GetMaxSize()) {
+  if (internal_node->GetSize() == internal_node->GetMaxSize() ||
+      !internal_node->Fits(internal_node->GetSize() + 1, key)) {
     SplitInternalNode(internal_node, key, value, ctx, txn);
   } else {
     int index = -1;
@@ -379,6 +559,160 @@ auto BPLUSTREE_TYPE::InsertParent(const KeyType &key, const page_id_t &value, Co
     internal_node->SetValueAt(index, value);
   }
 }
+/*****************************************************************************
+ * BULK LOADING
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(const std::function<bool(MappingType *)> &next, double fill_factor) -> size_t {
+  WritePageGuard head_guard = bpm_->FetchPageWrite(header_page_id_);
+  auto head_page = head_guard.AsMut<BPlusTreeHeaderPage>();
+  BUSTUB_ASSERT(head_page->root_page_id_ == INVALID_PAGE_ID, "only an empty tree can be bulk loaded");
+  auto fill_target = [fill_factor](int capacity, int min_size) {
+    return std::clamp(static_cast<int>(fill_factor * capacity), std::max(min_size, 1), capacity);
+  };
+
+  // The first key and page id of each page of the level just built, which is what the level above indexes.
+  std::vector<std::pair<KeyType, page_id_t>> pages;
+  size_t num_entries = 0;
+  {
+    // A leaf holds one entry less than its max size, see InsertLeafNode().
+    const int target = fill_target(leaf_max_size_ - 1, leaf_max_size_ / 2);
+    std::optional<WritePageGuard> left_guard;
+    std::optional<WritePageGuard> guard;
+    LeafPage *leaf_node = nullptr;
+    MappingType entry;
+    while (next(&entry)) {
+      if (leaf_node != nullptr) {
+        int cmp = comparator_(entry.first, leaf_node->KeyAt(leaf_node->GetSize() - 1));
+        if (cmp < 0) {
+          throw Exception("bulk loaded entries are not sorted by key");
+        }
+        if (cmp == 0) {
+          continue;
+        }
+      }
+      if (leaf_node == nullptr || leaf_node->GetSize() == target ||
+          !leaf_node->Fits(leaf_node->GetSize() + 1, entry.first)) {
+        page_id_t page_id;
+        bpm_->NewPageGuarded(&page_id);
+        WritePageGuard new_guard = bpm_->FetchPageWrite(page_id);
+        auto new_leaf_node = new_guard.AsMut<LeafPage>();
+        new_leaf_node->Init(leaf_max_size_, key_format_);
+        KeyType separator = entry.first;
+        if (leaf_node != nullptr) {
+          separator = Separator(leaf_node->KeyAt(leaf_node->GetSize() - 1), entry.first);
+          leaf_node->SetNextPageId(page_id);
+          leaf_node->SetHighKey(separator);
+        }
+        left_guard = std::move(guard);
+        guard = std::move(new_guard);
+        leaf_node = new_leaf_node;
+        pages.emplace_back(separator, page_id);
+      }
+      leaf_node->IncreaseSize(1);
+      leaf_node->SetKeyAt(leaf_node->GetSize() - 1, entry.first);
+      leaf_node->SetValueAt(leaf_node->GetSize() - 1, entry.second);
+      num_entries++;
+    }
+    if (pages.empty()) {
+      return 0;
+    }
+    // Compressed pages and those with variable-length keys hold no minimum size, and might not have room for entries
+    // moved over.
+    if (left_guard.has_value() && key_format_ == KeyFormat::PLAIN &&
+        BalanceLastPages(left_guard->AsMut<LeafPage>(), leaf_node, &pages.back().first)) {
+      page_id_t merged_page_id = pages.back().second;
+      pages.pop_back();
+      guard->Drop();
+      bpm_->DeletePage(merged_page_id);
+    }
+  }
+
+  const int target = fill_target(internal_max_size_, (internal_max_size_ + 1) / 2);
+  for (int level = 1; pages.size() > 1; level++) {
+    std::vector<std::pair<KeyType, page_id_t>> parents;
+    std::optional<WritePageGuard> left_guard;
+    std::optional<WritePageGuard> guard;
+    InternalPage *internal_node = nullptr;
+    for (const auto &[key, child] : pages) {
+      if (internal_node == nullptr || internal_node->GetSize() == target ||
+          !internal_node->Fits(internal_node->GetSize() + 1, key)) {
+        page_id_t page_id;
+        bpm_->NewPageGuarded(&page_id);
+        WritePageGuard new_guard = bpm_->FetchPageWrite(page_id);
+        auto new_internal_node = new_guard.AsMut<InternalPage>();
+        new_internal_node->Init(internal_max_size_, key_format_);
+        new_internal_node->SetLevel(level);
+        if (internal_node != nullptr) {
+          internal_node->SetNextPageId(page_id);
+          internal_node->SetHighKey(key);
+        }
+        left_guard = std::move(guard);
+        guard = std::move(new_guard);
+        internal_node = new_internal_node;
+        parents.emplace_back(key, page_id);
+      }
+      internal_node->IncreaseSize(1);
+      // The first key of an internal page is unused: it moves up as the separator of the page.
+      internal_node->SetKeyAt(internal_node->GetSize() - 1, internal_node->GetSize() == 1 ? KeyType{} : key);
+      internal_node->SetValueAt(internal_node->GetSize() - 1, child);
+    }
+    if (left_guard.has_value() && key_format_ == KeyFormat::PLAIN &&
+        BalanceLastPages(left_guard->AsMut<InternalPage>(), internal_node, &parents.back().first)) {
+      page_id_t merged_page_id = parents.back().second;
+      parents.pop_back();
+      guard->Drop();
+      bpm_->DeletePage(merged_page_id);
+    }
+    pages = std::move(parents);
+  }
+  head_page->root_page_id_ = pages[0].second;
+  return num_entries;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename PageType>
+auto BPLUSTREE_TYPE::BalanceLastPages(PageType *left, PageType *right, KeyType *right_key) -> bool {
+  // Internal pages keep the separator out of their first slot; put it back while entries move around.
+  constexpr bool is_internal = std::is_same_v<PageType, InternalPage>;
+  right->SetKeyAt(0, *right_key);
+  int left_size = left->GetSize();
+  int right_size = right->GetSize();
+  int total = left_size + right_size;
+  if (right_size >= right->GetMinSize()) {
+    if constexpr (is_internal) {
+      right->SetKeyAt(0, KeyType{});
+    }
+    return false;
+  }
+  if (total < 2 * right->GetMinSize()) {
+    left->IncreaseSize(right_size);
+    for (int i = 0; i < right_size; i++) {
+      left->SetKeyAt(left_size + i, right->KeyAt(i));
+      left->SetValueAt(left_size + i, right->ValueAt(i));
+    }
+    left->SetNextPageId(right->GetNextPageId());
+    return true;
+  }
+  int moved = total / 2 - right_size;
+  right->IncreaseSize(moved);
+  for (int i = right_size - 1; i >= 0; i--) {
+    right->SetKeyAt(i + moved, right->KeyAt(i));
+    right->SetValueAt(i + moved, right->ValueAt(i));
+  }
+  for (int i = 0; i < moved; i++) {
+    right->SetKeyAt(i, left->KeyAt(left_size - moved + i));
+    right->SetValueAt(i, left->ValueAt(left_size - moved + i));
+  }
+  left->IncreaseSize(-moved);
+  *right_key = right->KeyAt(0);
+  left->SetHighKey(*right_key);
+  if constexpr (is_internal) {
+    right->SetKeyAt(0, KeyType{});
+  }
+  return false;
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -396,7 +730,18 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
   Context ctx;
   (void)ctx;
   // throw Exception("remove先异常");
-  LOG_INFO("Remove key : %s", std::to_string(key.ToString()).c_str());
+  LOG_TRACE("Remove key : %s", std::to_string(key.ToString()).c_str());
+  if (blink_) {
+    RemoveBLink(key);
+    return;
+  }
+  if (key_format_ != KeyFormat::PLAIN) {
+    if (RemoveFromLeaf(key)) {
+      return;
+    }
+  } else if (optimistic_writes_ && TryRemoveOptimistic(key, txn)) {
+    return;
+  }
 
   // LOG_INFO("Remove key : %s", std::to_string(key.ToString()).c_str());
   std::map<page_id_t, int> index_mp;
@@ -448,6 +793,69 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
   DeleteLeafNodeKey(this_page_id, key, index_mp, ctx, txn);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RemoveFromLeaf(const KeyType &key) -> bool {
+  std::optional<WritePageGuard> guard;
+  if (optimistic_writes_) {
+    guard = LatchLeafOptimistic(key);
+  }
+  if (!guard.has_value()) {
+    // Nothing above the leaf changes, so one latch at a time is enough on the way down.
+    ReadPageGuard head_guard = bpm_->FetchPageRead(header_page_id_);
+    page_id_t root_page_id = head_guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+    if (root_page_id == INVALID_PAGE_ID) {
+      return true;
+    }
+    guard = bpm_->FetchPageWrite(root_page_id);
+    head_guard.Drop();
+    while (!guard->As<BPlusTreePage>()->IsLeafPage()) {
+      page_id_t next_page_id;
+      guard->As<InternalPage>()->FindValue(key, next_page_id, comparator_);
+      guard = bpm_->FetchPageWrite(next_page_id);
+    }
+  }
+  auto leaf_node = guard->AsMut<LeafPage>();
+  ValueType v;
+  int index = leaf_node->FindValue(key, v, comparator_);
+  if (index == -1 || comparator_(leaf_node->KeyAt(index), key) != 0) {
+    return true;
+  }
+  if (!leaf_node->IsDeleteSafe()) {
+    return false;
+  }
+  for (int i = index; i < leaf_node->GetSize() - 1; i++) {
+    leaf_node->SetKeyAt(i, leaf_node->KeyAt(i + 1));
+    leaf_node->SetValueAt(i, leaf_node->ValueAt(i + 1));
+  }
+  leaf_node->IncreaseSize(-1);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::TryRemoveOptimistic(const KeyType &key, Transaction *txn) -> bool {
+  std::optional<WritePageGuard> guard = LatchLeafOptimistic(key);
+  if (!guard.has_value()) {
+    return false;
+  }
+  auto leaf_node = guard->As<LeafPage>();
+  ValueType v;
+  int index = leaf_node->FindValue(key, v, comparator_);
+  if (index == -1 || comparator_(leaf_node->KeyAt(index), key) != 0) {
+    return true;
+  }
+  // A root leaf is safe too, as long as it keeps a key: an empty tree has to reset the header.
+  if (!leaf_node->IsDeleteSafe()) {
+    return false;
+  }
+  auto node = guard->AsMut<LeafPage>();
+  for (int i = index; i < node->GetSize() - 1; i++) {
+    node->SetKeyAt(i, node->KeyAt(i + 1));
+    node->SetValueAt(i, node->ValueAt(i + 1));
+  }
+  node->IncreaseSize(-1);
+  return true;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::DeleteLeafNodeKey(page_id_t this_page_id, const KeyType &key, std::map<page_id_t, int> index_mp,
                                        Context &ctx, Transaction *txn) {
@@ -508,19 +916,22 @@ void BPLUSTREE_TYPE::DeleteLeafNodeKey(page_id_t this_page_id, const KeyType &ke
 
   bool borrow_left = true;
   LeafPage *borrow_node = nullptr;
+  // The siblings stay latched until the entries have moved.
+  WritePageGuard guard1;
+  WritePageGuard guard2;
 
   if (parent_index == 0) {
     if (parent_index + 1 >= parent_node->GetSize()) {
       throw Exception("异常001");
     }
-    WritePageGuard guard1 = bpm_->FetchPageWrite(parent_node->ValueAt(parent_index + 1));
+    guard1 = bpm_->FetchPageWrite(parent_node->ValueAt(parent_index + 1));
     borrow_node = guard1.AsMut<LeafPage>();
     borrow_left = false;
   } else if (parent_index == parent_node->GetSize() - 1) {
     if (parent_index - 1 < 0) {
       throw Exception("异常002");
     }
-    WritePageGuard guard1 = bpm_->FetchPageWrite(parent_node->ValueAt(parent_index - 1));
+    guard1 = bpm_->FetchPageWrite(parent_node->ValueAt(parent_index - 1));
     borrow_node = guard1.AsMut<LeafPage>();
     borrow_left = true;
   } else {
@@ -530,9 +941,9 @@ void BPLUSTREE_TYPE::DeleteLeafNodeKey(page_id_t this_page_id, const KeyType &ke
     if (parent_index - 1 < 0) {
       throw Exception("异常004");
     }
-    WritePageGuard guard1 = bpm_->FetchPageWrite(parent_node->ValueAt(parent_index - 1));
+    guard1 = bpm_->FetchPageWrite(parent_node->ValueAt(parent_index - 1));
     auto node_left = borrow_node = guard1.AsMut<LeafPage>();
-    WritePageGuard guard2 = bpm_->FetchPageWrite(parent_node->ValueAt(parent_index + 1));
+    guard2 = bpm_->FetchPageWrite(parent_node->ValueAt(parent_index + 1));
     auto node_right = borrow_node = guard2.AsMut<LeafPage>();
     if (node_left->GetSize() >= node_right->GetSize()) {
       borrow_node = node_left;
@@ -545,6 +956,18 @@ void BPLUSTREE_TYPE::DeleteLeafNodeKey(page_id_t this_page_id, const KeyType &ke
 
   if (borrow_node->GetSize() - 1 < borrow_node->GetMinSize()) {
     // 合并
+    // Compressed or variable-length keys may not all fit in one page; the page is then left as it is.
+    if (key_format_ != KeyFormat::PLAIN) {
+      LeafPage *left = borrow_left ? borrow_node : node;
+      LeafPage *right = borrow_left ? node : borrow_node;
+      std::vector<KeyType> keys;
+      for (int j = 0; j < right->GetSize(); j++) {
+        keys.push_back(right->KeyAt(j));
+      }
+      if (!left->Fits(left->GetSize() + right->GetSize(), keys)) {
+        return;
+      }
+    }
     int delete_up_index = -1;
     delete_up_index = parent_index + 1;
     if (borrow_left) {
@@ -573,6 +996,12 @@ void BPLUSTREE_TYPE::DeleteLeafNodeKey(page_id_t this_page_id, const KeyType &ke
     return;
   }
 
+  // The borrowed entry becomes the separator in the parent, too.
+  KeyType moved_key = borrow_node->KeyAt(borrow_left ? borrow_node->GetSize() - 1 : 0);
+  KeyType separator = borrow_left ? moved_key : borrow_node->KeyAt(1);
+  if (!node->Fits(node->GetSize() + 1, moved_key) || !parent_node->Fits(parent_node->GetSize(), separator)) {
+    return;
+  }
   if (borrow_left) {
     if (borrow_node->GetSize() - 1 == -1 || borrow_node->GetSize() - 1 >= borrow_node->GetSize()) {
       throw Exception("异常11111");
@@ -669,12 +1098,15 @@ void BPLUSTREE_TYPE::DeleteInternalNodeKey(bustub::page_id_t this_page_id, int d
   bool borrow_left = true;
 
   InternalPage *borrow_node = nullptr;
+  // The siblings stay latched until the entries have moved.
+  WritePageGuard guard1;
+  WritePageGuard guard2;
 
   if (parent_index == 0) {
     if (parent_index + 1 >= parent_node->GetSize()) {
       throw Exception("异常555");
     }
-    WritePageGuard guard1 = bpm_->FetchPageWrite(parent_node->ValueAt(parent_index + 1));
+    guard1 = bpm_->FetchPageWrite(parent_node->ValueAt(parent_index + 1));
     borrow_node = guard1.AsMut<InternalPage>();
     borrow_left = false;
   } else if (parent_index == parent_node->GetSize() - 1) {
@@ -682,7 +1114,7 @@ void BPLUSTREE_TYPE::DeleteInternalNodeKey(bustub::page_id_t this_page_id, int d
       throw Exception("异常666");
     }
 
-    WritePageGuard guard1 = bpm_->FetchPageWrite(parent_node->ValueAt(parent_index - 1));
+    guard1 = bpm_->FetchPageWrite(parent_node->ValueAt(parent_index - 1));
     borrow_node = guard1.AsMut<InternalPage>();
     borrow_left = true;
   } else {
@@ -692,9 +1124,9 @@ void BPLUSTREE_TYPE::DeleteInternalNodeKey(bustub::page_id_t this_page_id, int d
     if (parent_index - 1 < 0) {
       throw Exception("异常888");
     }
-    WritePageGuard guard1 = bpm_->FetchPageWrite(parent_node->ValueAt(parent_index - 1));
+    guard1 = bpm_->FetchPageWrite(parent_node->ValueAt(parent_index - 1));
     auto node_left = borrow_node = guard1.AsMut<InternalPage>();
-    WritePageGuard guard2 = bpm_->FetchPageWrite(parent_node->ValueAt(parent_index + 1));
+    guard2 = bpm_->FetchPageWrite(parent_node->ValueAt(parent_index + 1));
     auto node_right = borrow_node = guard2.AsMut<InternalPage>();
     if (node_left->GetSize() >= node_right->GetSize()) {
       borrow_node = node_left;
@@ -707,10 +1139,14 @@ void BPLUSTREE_TYPE::DeleteInternalNodeKey(bustub::page_id_t this_page_id, int d
 
   if (borrow_node->GetSize() - 1 >= borrow_node->GetMinSize()) {
     // 借一个删除
+    // The separator in the parent comes down into node, and a key of the sibling goes up in its place.
+    KeyType down_key = parent_node->KeyAt(borrow_left ? parent_index : parent_index + 1);
+    KeyType up_key = borrow_node->KeyAt(borrow_left ? borrow_node->GetSize() - 1 : 1);
+    if (!node->Fits(node->GetSize() + 1, down_key) || !parent_node->Fits(parent_node->GetSize(), up_key)) {
+      return;
+    }
 
     if (borrow_left) {
-      KeyType up_key = borrow_node->KeyAt(borrow_node->GetSize() - 1);
-      KeyType down_key = parent_node->KeyAt(parent_index);
       page_id_t down_value = borrow_node->ValueAt(borrow_node->GetSize() - 1);
       borrow_node->IncreaseSize(-1);
 
@@ -725,9 +1161,6 @@ void BPLUSTREE_TYPE::DeleteInternalNodeKey(bustub::page_id_t this_page_id, int d
       parent_node->SetKeyAt(parent_index, up_key);
 
     } else {
-      KeyType up_key = borrow_node->KeyAt(1);
-
-      KeyType down_key = parent_node->KeyAt(parent_index + 1);
       page_id_t down_value = borrow_node->ValueAt(0);
       for (int i = 1; i < borrow_node->GetSize(); i++) {
         borrow_node->SetKeyAt(i - 1, borrow_node->KeyAt(i));
@@ -745,6 +1178,18 @@ void BPLUSTREE_TYPE::DeleteInternalNodeKey(bustub::page_id_t this_page_id, int d
   }
 
   // 内部节点的合并
+  // The separator in the parent comes down between the entries of the two pages, if they all fit in one.
+  if (key_format_ != KeyFormat::PLAIN) {
+    InternalPage *left = borrow_left ? borrow_node : node;
+    InternalPage *right = borrow_left ? node : borrow_node;
+    std::vector<KeyType> keys{parent_node->KeyAt(borrow_left ? parent_index : parent_index + 1)};
+    for (int j = 1; j < right->GetSize(); j++) {
+      keys.push_back(right->KeyAt(j));
+    }
+    if (!left->Fits(left->GetSize() + right->GetSize(), keys)) {
+      return;
+    }
+  }
 
   if (!borrow_left) {
     KeyType down_key = parent_node->KeyAt(parent_index + 1);
@@ -796,9 +1241,55 @@ void BPLUSTREE_TYPE::DeleteInternalNodeKey(bustub::page_id_t this_page_id, int d
  * index iterator
  * @return : index iterator
  */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::TryBeginOptimistic(const KeyType *key) -> std::optional<INDEXITERATOR_TYPE> {
+  try {
+    std::optional<OptimisticReadGuard> guard;
+    if (!DescendOptimistic(key, &guard)) {
+      return std::nullopt;
+    }
+    if (!guard.has_value()) {
+      return End();
+    }
+    auto leaf_node = guard->As<LeafPage>();
+    int index = 0;
+    if (key != nullptr) {
+      ValueType value;
+      index = leaf_node->FindValue(*key, value, comparator_);
+    }
+    if (index == -1) {
+      // Past the last key of the leaf, the iteration starts on the next one, which the latched descent moves on to.
+      if (leaf_node->GetNextPageId() != INVALID_PAGE_ID) {
+        return std::nullopt;
+      }
+      return guard->Validate() ? std::optional<INDEXITERATOR_TYPE>(End()) : std::nullopt;
+    }
+    MappingType entry = MappingType(leaf_node->KeyAt(index), leaf_node->ValueAt(index));
+    if (!guard->Validate()) {
+      return std::nullopt;
+    }
+    return INDEXITERATOR_TYPE(bpm_, guard->PageId(), index, entry);
+  } catch (Exception &) {
+    return std::nullopt;
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
   // throw Exception("暂时不实现迭代器，查看是否是死锁原因");
+  if (blink_) {
+    auto leaf = DescendBLink(nullptr, 0, nullptr);
+    return leaf.has_value() ? IteratorAt(std::move(*leaf), 0) : End();
+  }
+  // Leaves of trees with compressed or variable-length keys may be empty, which only the pessimistic path below steps
+  // over.
+  for (int attempt = 0; optimistic_reads_ && key_format_ == KeyFormat::PLAIN && attempt < BTREE_OPTIMISTIC_RETRIES;
+       attempt++) {
+    auto begin = TryBeginOptimistic(nullptr);
+    if (begin.has_value()) {
+      return std::move(*begin);
+    }
+  }
 
   ReadPageGuard head_guard = bpm_->FetchPageRead(header_page_id_);
   auto head_node = head_guard.As<BPlusTreeHeaderPage>();
@@ -815,6 +1306,9 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
     guard = bpm_->FetchPageRead(next_page_id);
     tree_page = guard.As<BPlusTreePage>();
   }
+  if (key_format_ != KeyFormat::PLAIN) {
+    return IteratorAt(std::move(guard), 0);
+  }
   next_page_id = guard.PageId();
   auto leaf_node = guard.As<LeafPage>();
   MappingType entry = MappingType(leaf_node->KeyAt(0), leaf_node->ValueAt(0));
@@ -829,6 +1323,26 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
   // throw Exception("暂时不实现迭代器，查看是否是死锁原因");
+  if (blink_) {
+    std::optional<ReadPageGuard> leaf = DescendBLink(&key, 0, nullptr);
+    if (!leaf.has_value()) {
+      return End();
+    }
+    auto leaf_node = leaf->As<LeafPage>();
+    ValueType value;
+    int index = leaf_node->FindValue(key, value, comparator_);
+    if (index == -1) {
+      index = leaf_node->GetSize();
+    }
+    return IteratorAt(std::move(*leaf), index);
+  }
+  for (int attempt = 0; optimistic_reads_ && key_format_ == KeyFormat::PLAIN && attempt < BTREE_OPTIMISTIC_RETRIES;
+       attempt++) {
+    auto begin = TryBeginOptimistic(&key);
+    if (begin.has_value()) {
+      return std::move(*begin);
+    }
+  }
 
   ReadPageGuard head_gurad = bpm_->FetchPageRead(header_page_id_);
   auto head_node = head_gurad.As<BPlusTreeHeaderPage>();
@@ -849,8 +1363,8 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
   next_page_id = guard.PageId();
   ValueType value;
   int index = leaf_node->FindValue(key, value, comparator_);
-  if (index == -1) {
-    return End();
+  if (key_format_ != KeyFormat::PLAIN || index == -1) {
+    return IteratorAt(std::move(guard), index == -1 ? leaf_node->GetSize() : index);
   }
   // if ((comparator_(leaf_node->KeyAt(index), key) != 0)) {
   //   return End();
@@ -860,6 +1374,101 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
   return INDEXITERATOR_TYPE(bpm_, next_page_id, index, entry);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Begin(const KeyType &key, const KeyType &upper_bound) -> INDEXITERATOR_TYPE {
+  auto iter = Begin(key);
+  iter.SetUpperBound(upper_bound, &comparator_);
+  return iter;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin() -> INDEXITERATOR_TYPE { return SeekBefore(nullptr, false); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin(const KeyType &key) -> INDEXITERATOR_TYPE { return SeekBefore(&key, true); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::SeekBefore(const KeyType *key, bool inclusive) -> INDEXITERATOR_TYPE {
+  std::optional<KeyType> target;
+  if (key != nullptr) {
+    target = *key;
+  }
+  // Whether k comes before the target, and so may be the key sought.
+  auto before = [&](const KeyType &k) {
+    if (!target.has_value()) {
+      return true;
+    }
+    int cmp = comparator_(k, *target);
+    return cmp < 0 || (inclusive && cmp == 0);
+  };
+  while (true) {
+    ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
+    page_id_t root_page_id = guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+    if (root_page_id == INVALID_PAGE_ID) {
+      return End();
+    }
+    guard = bpm_->FetchPageRead(root_page_id);
+    std::optional<KeyType> lower_bound;
+    while (true) {
+      auto page = guard.As<BPlusTreePage>();
+      // In B-link mode, keys before the target may have moved right of the page since its parent was read.
+      if (blink_) {
+        page_id_t next_page_id;
+        KeyType high_key;
+        if (page->IsLeafPage()) {
+          next_page_id = guard.As<LeafPage>()->GetNextPageId();
+          high_key = guard.As<LeafPage>()->GetHighKey();
+        } else {
+          next_page_id = guard.As<InternalPage>()->GetNextPageId();
+          high_key = guard.As<InternalPage>()->GetHighKey();
+        }
+        if (next_page_id != INVALID_PAGE_ID && before(high_key)) {
+          lower_bound = high_key;
+          guard = bpm_->FetchPageRead(next_page_id);
+          continue;
+        }
+      }
+      if (page->IsLeafPage()) {
+        break;
+      }
+      auto internal_node = guard.As<InternalPage>();
+      int index = internal_node->GetSize() - 1;
+      if (target.has_value()) {
+        page_id_t child;
+        index = internal_node->FindValue(*target, child, comparator_);
+        if (index > 0 && !before(internal_node->KeyAt(index))) {
+          index--;
+        }
+      }
+      if (index > 0) {
+        lower_bound = internal_node->KeyAt(index);
+      }
+      guard = bpm_->FetchPageRead(internal_node->ValueAt(index));
+    }
+    auto leaf_node = guard.As<LeafPage>();
+    int index = leaf_node->GetSize() - 1;
+    if (target.has_value()) {
+      ValueType value;
+      index = leaf_node->FindValue(*target, value, comparator_);
+      if (index == -1) {
+        index = leaf_node->GetSize();
+      } else if (before(leaf_node->KeyAt(index))) {
+        index++;
+      }
+      index--;
+    }
+    if (index >= 0) {
+      MappingType entry = MappingType(leaf_node->KeyAt(index), leaf_node->ValueAt(index));
+      return INDEXITERATOR_TYPE(this, guard.PageId(), index, entry);
+    }
+    if (!lower_bound.has_value()) {
+      return End();
+    }
+    target = lower_bound;
+    inclusive = false;
+  }
+}
+
 /*
  * Input parameter is void, construct an index iterator representing the end
  * of the key/value pair in the leaf node
@@ -882,6 +1491,349 @@ auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t {
   return head_page->root_page_id_;
 }
 
+/*****************************************************************************
+ * B-LINK MODE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::LevelOf(const BPlusTreePage *page) -> int {
+  return page->IsLeafPage() ? 0 : static_cast<const InternalPage *>(page)->GetLevel();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RightOfBLink(const BPlusTreePage *page, const KeyType &key) const -> page_id_t {
+  page_id_t next_page_id;
+  KeyType high_key;
+  if (page->IsLeafPage()) {
+    next_page_id = static_cast<const LeafPage *>(page)->GetNextPageId();
+    high_key = static_cast<const LeafPage *>(page)->GetHighKey();
+  } else {
+    next_page_id = static_cast<const InternalPage *>(page)->GetNextPageId();
+    high_key = static_cast<const InternalPage *>(page)->GetHighKey();
+  }
+  // The last page of a level has no high key: it covers everything up to infinity.
+  if (next_page_id == INVALID_PAGE_ID || comparator_(key, high_key) < 0) {
+    return INVALID_PAGE_ID;
+  }
+  return next_page_id;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::DescendBLink(const KeyType *key, int level, std::vector<page_id_t> *path)
+    -> std::optional<ReadPageGuard> {
+  page_id_t page_id;
+  {
+    ReadPageGuard head_guard = bpm_->FetchPageRead(header_page_id_);
+    page_id = head_guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+  }
+  if (page_id == INVALID_PAGE_ID) {
+    return std::nullopt;
+  }
+  // The root may have been replaced since, but pages are never freed, and the old root still covers its whole level.
+  ReadPageGuard guard = bpm_->FetchPageRead(page_id);
+  int root_level = LevelOf(guard.As<BPlusTreePage>());
+  if (root_level < level) {
+    return std::nullopt;
+  }
+  if (path != nullptr) {
+    path->assign(root_level + 1, INVALID_PAGE_ID);
+  }
+  while (true) {
+    auto page = guard.As<BPlusTreePage>();
+    if (key != nullptr) {
+      page_id_t right_page_id = RightOfBLink(page, *key);
+      if (right_page_id != INVALID_PAGE_ID) {
+        guard.Drop();
+        guard = bpm_->FetchPageRead(right_page_id);
+        continue;
+      }
+    }
+    int page_level = LevelOf(page);
+    if (path != nullptr) {
+      (*path)[page_level] = guard.PageId();
+    }
+    if (page_level == level) {
+      return guard;
+    }
+    auto internal_node = guard.As<InternalPage>();
+    page_id_t next_page_id = internal_node->ValueAt(0);
+    if (key != nullptr) {
+      internal_node->FindValue(*key, next_page_id, comparator_);
+    }
+    // Let go of the parent first: if the child splits meanwhile, the keys that moved away are to its right.
+    guard.Drop();
+    guard = bpm_->FetchPageRead(next_page_id);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::LatchBLink(page_id_t page_id, const KeyType &key) -> WritePageGuard {
+  WritePageGuard guard = bpm_->FetchPageWrite(page_id);
+  page_id_t right_page_id;
+  while ((right_page_id = RightOfBLink(guard.As<BPlusTreePage>(), key)) != INVALID_PAGE_ID) {
+    guard.Drop();
+    guard = bpm_->FetchPageWrite(right_page_id);
+  }
+  return guard;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetValueBLink(const KeyType &key, std::vector<ValueType> *result) -> bool {
+  std::optional<ReadPageGuard> guard = DescendBLink(&key, 0, nullptr);
+  if (!guard.has_value()) {
+    return false;
+  }
+  auto leaf_node = guard->As<LeafPage>();
+  ValueType value;
+  int index = leaf_node->FindValue(key, value, comparator_);
+  if (index == -1 || comparator_(leaf_node->KeyAt(index), key) != 0) {
+    return false;
+  }
+  result->push_back(leaf_node->ValueAt(index));
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertBLink(const KeyType &key, const ValueType &value, Transaction *txn) -> bool {
+  std::vector<page_id_t> path;
+  auto leaf = DescendBLink(&key, 0, &path);
+  while (!leaf.has_value()) {
+    {
+      WritePageGuard head_guard = bpm_->FetchPageWrite(header_page_id_);
+      auto head_page = head_guard.AsMut<BPlusTreeHeaderPage>();
+      if (head_page->root_page_id_ == INVALID_PAGE_ID) {
+        bpm_->NewPageGuarded(&head_page->root_page_id_);
+        WritePageGuard root_guard = bpm_->FetchPageWrite(head_page->root_page_id_);
+        root_guard.AsMut<LeafPage>()->Init(leaf_max_size_, key_format_);
+      }
+    }
+    leaf = DescendBLink(&key, 0, &path);
+  }
+  page_id_t leaf_page_id = leaf->PageId();
+  leaf->Drop();
+
+  WritePageGuard guard = LatchBLink(leaf_page_id, key);
+  auto leaf_node = guard.AsMut<LeafPage>();
+  ValueType v;
+  int index = leaf_node->FindValue(key, v, comparator_);
+  if (index != -1 && comparator_(leaf_node->KeyAt(index), key) == 0) {
+    return false;
+  }
+  if (leaf_node->IsInsertSafe() && leaf_node->Fits(leaf_node->GetSize() + 1, key)) {
+    Context ctx;
+    InsertLeafNode(leaf_node, key, value, ctx, txn);
+    return true;
+  }
+  auto [separator, right_page_id] = SplitLeafBLink(leaf_node, key, value);
+  guard.Drop();
+  InsertParentBLink(separator, right_page_id, 1, path);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveBLink(const KeyType &key) {
+  auto leaf = DescendBLink(&key, 0, nullptr);
+  if (!leaf.has_value()) {
+    return;
+  }
+  page_id_t leaf_page_id = leaf->PageId();
+  leaf->Drop();
+
+  WritePageGuard guard = LatchBLink(leaf_page_id, key);
+  auto leaf_node = guard.AsMut<LeafPage>();
+  ValueType v;
+  int index = leaf_node->FindValue(key, v, comparator_);
+  if (index == -1 || comparator_(leaf_node->KeyAt(index), key) != 0) {
+    return;
+  }
+  for (int i = index; i < leaf_node->GetSize() - 1; i++) {
+    leaf_node->SetKeyAt(i, leaf_node->KeyAt(i + 1));
+    leaf_node->SetValueAt(i, leaf_node->ValueAt(i + 1));
+  }
+  leaf_node->IncreaseSize(-1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::SplitLeafBLink(LeafPage *node, const KeyType &key, const ValueType &value)
+    -> std::pair<KeyType, page_id_t> {
+  std::vector<MappingType> entries;
+  entries.reserve(node->GetSize() + 1);
+  for (int i = 0; i < node->GetSize(); i++) {
+    entries.emplace_back(node->KeyAt(i), node->ValueAt(i));
+  }
+  auto pos = std::lower_bound(entries.begin(), entries.end(), key,
+                              [&](const MappingType &entry, const KeyType &k) { return comparator_(entry.first, k) < 0; });
+  entries.insert(pos, MappingType(key, value));
+
+  page_id_t right_page_id;
+  bpm_->NewPageGuarded(&right_page_id);
+  WritePageGuard right_guard = bpm_->FetchPageWrite(right_page_id);
+  auto right_node = right_guard.AsMut<LeafPage>();
+  right_node->Init(leaf_max_size_, key_format_);
+
+  int left_size = static_cast<int>(entries.size()) / 2;
+  node->SetSize(left_size);
+  right_node->SetSize(static_cast<int>(entries.size()) - left_size);
+  for (int i = 0; i < static_cast<int>(entries.size()); i++) {
+    auto target = i < left_size ? node : right_node;
+    int index = i < left_size ? i : i - left_size;
+    target->SetKeyAt(index, entries[i].first);
+    target->SetValueAt(index, entries[i].second);
+  }
+
+  node->Compact();
+
+  // The right half takes over the old bounds of the page before anybody can reach it through the right link.
+  KeyType separator = Separator(entries[left_size - 1].first, entries[left_size].first);
+  right_node->SetHighKey(node->GetHighKey());
+  right_node->SetNextPageId(node->GetNextPageId());
+  node->SetHighKey(separator);
+  node->SetNextPageId(right_page_id);
+  return {separator, right_page_id};
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::SplitInternalBLink(InternalPage *node, const KeyType &key, page_id_t child)
+    -> std::pair<KeyType, page_id_t> {
+  page_id_t v;
+  int index = node->FindValue(key, v, comparator_) + 1;
+  std::vector<std::pair<KeyType, page_id_t>> entries;
+  entries.reserve(node->GetSize() + 1);
+  for (int i = 0; i < node->GetSize(); i++) {
+    if (i == index) {
+      entries.emplace_back(key, child);
+    }
+    entries.emplace_back(node->KeyAt(i), node->ValueAt(i));
+  }
+  if (index == node->GetSize()) {
+    entries.emplace_back(key, child);
+  }
+
+  page_id_t right_page_id;
+  bpm_->NewPageGuarded(&right_page_id);
+  WritePageGuard right_guard = bpm_->FetchPageWrite(right_page_id);
+  auto right_node = right_guard.AsMut<InternalPage>();
+  right_node->Init(internal_max_size_, key_format_);
+  right_node->SetLevel(node->GetLevel());
+
+  // The key in the middle moves up; the child it points to becomes the first child of the right half.
+  int left_size = static_cast<int>(entries.size()) / 2;
+  KeyType up_key = entries[left_size].first;
+  node->SetSize(left_size);
+  right_node->SetSize(static_cast<int>(entries.size()) - left_size);
+  for (int i = 0; i < static_cast<int>(entries.size()); i++) {
+    auto target = i < left_size ? node : right_node;
+    int target_index = i < left_size ? i : i - left_size;
+    target->SetKeyAt(target_index, target_index == 0 && i >= left_size ? KeyType{} : entries[i].first);
+    target->SetValueAt(target_index, entries[i].second);
+  }
+
+  node->Compact();
+
+  right_node->SetHighKey(node->GetHighKey());
+  right_node->SetNextPageId(node->GetNextPageId());
+  node->SetHighKey(up_key);
+  node->SetNextPageId(right_page_id);
+  return {up_key, right_page_id};
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertParentBLink(KeyType key, page_id_t child, int level, const std::vector<page_id_t> &path) {
+  while (true) {
+    // Pages never move left, so the page passed on the way down is a fine place to start looking for the parent.
+    page_id_t page_id = level < static_cast<int>(path.size()) ? path[level] : INVALID_PAGE_ID;
+    if (page_id == INVALID_PAGE_ID) {
+      auto parent = DescendBLink(&key, level, nullptr);
+      if (!parent.has_value()) {
+        GrowRootBLink(level - 1);
+        continue;
+      }
+      page_id = parent->PageId();
+    }
+
+    WritePageGuard guard = LatchBLink(page_id, key);
+    auto internal_node = guard.AsMut<InternalPage>();
+    page_id_t v;
+    int index = internal_node->FindValue(key, v, comparator_);
+    // Whoever grew the root may have linked the child already.
+    if (index > 0 && comparator_(internal_node->KeyAt(index), key) == 0) {
+      return;
+    }
+    if (internal_node->GetSize() < internal_node->GetMaxSize() &&
+        internal_node->Fits(internal_node->GetSize() + 1, key)) {
+      index++;
+      internal_node->IncreaseSize(1);
+      for (int i = internal_node->GetSize() - 1; i > index; i--) {
+        internal_node->SetKeyAt(i, internal_node->KeyAt(i - 1));
+        internal_node->SetValueAt(i, internal_node->ValueAt(i - 1));
+      }
+      internal_node->SetKeyAt(index, key);
+      internal_node->SetValueAt(index, child);
+      return;
+    }
+    std::tie(key, child) = SplitInternalBLink(internal_node, key, child);
+    guard.Drop();
+    level++;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GrowRootBLink(int level) {
+  WritePageGuard head_guard = bpm_->FetchPageWrite(header_page_id_);
+  auto head_page = head_guard.AsMut<BPlusTreeHeaderPage>();
+  page_id_t old_root_page_id = head_page->root_page_id_;
+  page_id_t right_page_id;
+  KeyType high_key;
+  {
+    // Nobody waits for the header while holding a page latch, so taking one here cannot deadlock.
+    ReadPageGuard root_guard = bpm_->FetchPageRead(old_root_page_id);
+    auto root_page = root_guard.As<BPlusTreePage>();
+    if (LevelOf(root_page) != level) {
+      return;
+    }
+    if (root_page->IsLeafPage()) {
+      right_page_id = root_guard.As<LeafPage>()->GetNextPageId();
+      high_key = root_guard.As<LeafPage>()->GetHighKey();
+    } else {
+      right_page_id = root_guard.As<InternalPage>()->GetNextPageId();
+      high_key = root_guard.As<InternalPage>()->GetHighKey();
+    }
+  }
+  BUSTUB_ASSERT(right_page_id != INVALID_PAGE_ID, "the root grows only after it split");
+
+  // The new root links the old one and its right sibling. Any other page of the level is linked in by whoever split it.
+  bpm_->NewPageGuarded(&head_page->root_page_id_);
+  WritePageGuard new_root_guard = bpm_->FetchPageWrite(head_page->root_page_id_);
+  auto new_root_node = new_root_guard.AsMut<InternalPage>();
+  new_root_node->Init(internal_max_size_, key_format_);
+  new_root_node->SetLevel(level + 1);
+  new_root_node->SetSize(2);
+  new_root_node->SetKeyAt(0, KeyType{});
+  new_root_node->SetValueAt(0, old_root_page_id);
+  new_root_node->SetKeyAt(1, high_key);
+  new_root_node->SetValueAt(1, right_page_id);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Separator(const KeyType &left, const KeyType &right) const -> KeyType {
+  return key_format_ != KeyFormat::PLAIN ? comparator_.ShortestSeparator(left, right) : right;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IteratorAt(ReadPageGuard guard, int index) -> INDEXITERATOR_TYPE {
+  auto leaf_node = guard.As<LeafPage>();
+  while (index >= leaf_node->GetSize()) {
+    page_id_t next_page_id = leaf_node->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      return End();
+    }
+    guard = bpm_->FetchPageRead(next_page_id, AccessType::Scan);
+    leaf_node = guard.As<LeafPage>();
+    index = 0;
+  }
+  MappingType entry = MappingType(leaf_node->KeyAt(index), leaf_node->ValueAt(index));
+  return INDEXITERATOR_TYPE(bpm_, guard.PageId(), index, entry, &comparator_);
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
@@ -1138,4 +2090,8 @@ template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTree<GenericKey<32>, RID, SerializedComparator<32>>;
+
+template class BPlusTree<GenericKey<64>, RID, SerializedComparator<64>>;
+
 }  // namespace bustub
@@ -11,15 +11,36 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include <type_traits>
+
+#include "storage/index/external_sorter.h"
+
 namespace bustub {
 /*
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                                     bool compress_keys)
     : Index(std::move(metadata)), comparator_(GetMetadata()->GetKeySchema()) {
   page_id_t header_page_id;
   buffer_pool_manager->NewPage(&header_page_id);
+  if constexpr (std::is_same_v<KeyComparator, SerializedComparator<sizeof(KeyType)>>) {
+    container_ = std::make_shared<BPlusTree<KeyType, ValueType, KeyComparator>>(
+        GetMetadata()->GetName(), header_page_id, buffer_pool_manager, comparator_,
+        BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>::VARIABLE_LENGTH_MAX_SIZE,
+        BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>::VARIABLE_LENGTH_MAX_SIZE);
+    container_->SetVariableLengthKeys(true);
+    return;
+  }
+  if (compress_keys) {
+    container_ = std::make_shared<BPlusTree<KeyType, ValueType, KeyComparator>>(
+        GetMetadata()->GetName(), header_page_id, buffer_pool_manager, comparator_,
+        BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>::COMPRESSED_MAX_SIZE,
+        BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>::COMPRESSED_MAX_SIZE);
+    container_->SetKeyCompression(true);
+    return;
+  }
   container_ = std::make_shared<BPlusTree<KeyType, ValueType, KeyComparator>>(GetMetadata()->GetName(), header_page_id,
                                                                               buffer_pool_manager, comparator_);
 }
@@ -51,19 +72,44 @@ void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, T
   container_->GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::BulkLoad(const std::function<bool(Tuple *, RID *)> &next) -> size_t {
+  ExternalSorter<KeyType, ValueType, KeyComparator> sorter(comparator_);
+  Tuple key;
+  RID rid;
+  KeyType index_key;
+  while (next(&key, &rid)) {
+    index_key.SetFromKey(key);
+    sorter.Add(index_key, rid);
+  }
+  sorter.Finish();
+  return container_->BulkLoad([&sorter](MappingType *entry) { return sorter.Next(entry); });
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_->Begin(); }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE { return container_->Begin(key); }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key, const KeyType &upper_bound) -> INDEXITERATOR_TYPE {
+  return container_->Begin(key, upper_bound);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetEndIterator() -> INDEXITERATOR_TYPE { return container_->End(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator() -> INDEXITERATOR_TYPE { return container_->RBegin(); }
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTreeIndex<GenericKey<32>, RID, SerializedComparator<32>>;
+template class BPlusTreeIndex<GenericKey<64>, RID, SerializedComparator<64>>;
+
 }  // namespace bustub
@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter.cpp
+//
+// Identification: src/storage/index/external_sorter.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/external_sorter.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORTER_TYPE::ExternalSorter(const KeyComparator &comparator, size_t run_size)
+    : comparator_(comparator), run_size_(std::max<size_t>(run_size, 1)) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORTER_TYPE::~ExternalSorter() {
+  for (auto &run : runs_) {
+    fclose(run.file_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::Add(const KeyType &key, const ValueType &value) {
+  BUSTUB_ASSERT(!finished_, "cannot add entries to a finished sort");
+  buffer_.emplace_back(key, value);
+  if (buffer_.size() == run_size_) {
+    SpillRun();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::SortBuffer() {
+  std::stable_sort(buffer_.begin(), buffer_.end(), [this](const MappingType &a, const MappingType &b) {
+    return comparator_(a.first, b.first) < 0;
+  });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::SpillRun() {
+  SortBuffer();
+  // tmpfile() unlinks the file right away; it goes away with the handle.
+  FILE *file = tmpfile();
+  if (file == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot create a temporary file for an external sort");
+  }
+  for (const auto &entry : buffer_) {
+    if (fwrite(&entry.first, sizeof(KeyType), 1, file) != 1 || fwrite(&entry.second, sizeof(ValueType), 1, file) != 1) {
+      fclose(file);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot write a sorted run of an external sort");
+    }
+  }
+  rewind(file);
+  runs_.push_back(Run{file, {}, 0});
+  buffer_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::Finish() {
+  BUSTUB_ASSERT(!finished_, "a sort can only be finished once");
+  finished_ = true;
+  if (runs_.empty()) {
+    SortBuffer();
+    return;
+  }
+  if (!buffer_.empty()) {
+    SpillRun();
+  }
+  buffer_.shrink_to_fit();
+  auto after = [this](size_t a, size_t b) { return MergeAfter(a, b); };
+  for (size_t i = 0; i < runs_.size(); i++) {
+    if (RefillRun(&runs_[i])) {
+      heap_.push_back(i);
+      std::push_heap(heap_.begin(), heap_.end(), after);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORTER_TYPE::RefillRun(Run *run) -> bool {
+  run->block_.clear();
+  run->pos_ = 0;
+  MappingType entry;
+  while (run->block_.size() < RUN_BLOCK_SIZE && fread(&entry.first, sizeof(KeyType), 1, run->file_) == 1 &&
+         fread(&entry.second, sizeof(ValueType), 1, run->file_) == 1) {
+    run->block_.push_back(entry);
+  }
+  return !run->block_.empty();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORTER_TYPE::MergeAfter(size_t a, size_t b) const -> bool {
+  const auto &run_a = runs_[a];
+  const auto &run_b = runs_[b];
+  int cmp = comparator_(run_a.block_[run_a.pos_].first, run_b.block_[run_b.pos_].first);
+  // Runs were spilled in the order their entries were added, so ties go to the earlier run to keep the sort stable.
+  return cmp > 0 || (cmp == 0 && a > b);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORTER_TYPE::Next(MappingType *entry) -> bool {
+  BUSTUB_ASSERT(finished_, "a sort has to be finished before reading it");
+  if (runs_.empty()) {
+    if (buffer_pos_ == buffer_.size()) {
+      return false;
+    }
+    *entry = buffer_[buffer_pos_++];
+    return true;
+  }
+  if (heap_.empty()) {
+    return false;
+  }
+  auto after = [this](size_t a, size_t b) { return MergeAfter(a, b); };
+  std::pop_heap(heap_.begin(), heap_.end(), after);
+  auto &run = runs_[heap_.back()];
+  *entry = run.block_[run.pos_++];
+  if (run.pos_ < run.block_.size() || RefillRun(&run)) {
+    std::push_heap(heap_.begin(), heap_.end(), after);
+  } else {
+    heap_.pop_back();
+  }
+  return true;
+}
+
+template class ExternalSorter<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExternalSorter<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExternalSorter<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExternalSorter<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExternalSorter<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class ExternalSorter<GenericKey<32>, RID, SerializedComparator<32>>;
+template class ExternalSorter<GenericKey<64>, RID, SerializedComparator<64>>;
+
+}  // namespace bustub
@@ -1,6 +1,7 @@
 /**
  * index_iterator.cpp
  */
+#include <algorithm>
 #include <cassert>
 
 #include "common/exception.h"
@@ -19,20 +20,26 @@ INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bufferPoolManager, page_id_t pid, int index, MappingType &entry)
-    : bpm_(bufferPoolManager), pid_(pid), index_(index) {
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bufferPoolManager, page_id_t pid, int index, MappingType &entry,
+                                  const KeyComparator *comparator)
+    : bpm_(bufferPoolManager), pid_(pid), index_(index), comparator_(comparator) {
   entry_ = entry;
 }
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *buffer_pool_manager, page_id_t page_id, int index)
     : bpm_(buffer_pool_manager), pid_(page_id), index_(index) {}
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, page_id_t pid, int index,
+                                  MappingType &entry)
+    : bpm_(tree->bpm_), pid_(pid), index_(index), entry_(entry), comparator_(&tree->comparator_), tree_(tree) {}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::IsEnd() -> bool {
-  ReadPageGuard guard = bpm_->FetchPageRead(pid_);
+  ReadPageGuard guard = bpm_->FetchPageRead(pid_, AccessType::Scan);
   auto node = guard.As<LeafPage>();
   return node->GetNextPageId() == INVALID_PAGE_ID && index_ == node->GetSize() - 1;
 }
@@ -46,14 +53,44 @@ auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
     index_ = 0;
     return *this;
   }
-  ReadPageGuard guard = bpm_->FetchPageRead(pid_);
+  if (tree_ != nullptr) {
+    StepBack(bpm_->FetchPageRead(pid_, AccessType::Scan));
+    return *this;
+  }
+  Step(bpm_->FetchPageRead(pid_, AccessType::Scan));
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::StepBack(ReadPageGuard guard) {
+  auto node = guard.As<LeafPage>();
+  ValueType value;
+  int index = node->FindValue(entry_.first, value, *comparator_);
+  // With a key no smaller than entry_ in it, the leaf still covers the keys right below entry_. Otherwise, entry_ may
+  // have been removed or moved to a new right sibling, and the tree finds its predecessor.
+  if (index > 0) {
+    index_ = index - 1;
+    entry_.first = node->KeyAt(index_);
+    entry_.second = node->ValueAt(index_);
+    return;
+  }
+  guard.Drop();
+  KeyType key = entry_.first;
+  *this = tree_->SeekBefore(&key, false);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Step(ReadPageGuard guard) {
+  page_id_t pid = pid_;
   auto node = guard.As<LeafPage>();
-  if (index_ + 1 < node->GetSize()) {
+  if (comparator_ != nullptr) {
+    SeekPast(std::move(guard));
+  } else if (index_ + 1 < node->GetSize()) {
     index_++;
     entry_.first = node->KeyAt(index_);
     entry_.second = node->ValueAt(index_);
   } else if (node->GetNextPageId() != -1) {
-    guard = bpm_->FetchPageRead(node->GetNextPageId());
+    guard = bpm_->FetchPageRead(node->GetNextPageId(), AccessType::Scan);
     node = guard.As<LeafPage>();
     pid_ = guard.PageId();
     index_ = 0;
@@ -63,7 +100,153 @@ auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
     pid_ = -1;
     index_ = 0;
   }
+  guard.Drop();
+
+  if (pid_ != -1 && upper_bound_.has_value() && (*bound_comparator_)(entry_.first, *upper_bound_) > 0) {
+    pid_ = -1;
+    index_ = 0;
+  }
+  if (pid_ != -1 && pid_ != pid) {
+    if (!read_ahead_.empty() && read_ahead_.front() == pid_) {
+      read_ahead_.pop_front();
+    } else {
+      read_ahead_.clear();
+    }
+    ReadAhead();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::NextBatch(size_t n) -> std::vector<MappingType> {
+  std::vector<MappingType> batch;
+  if (pid_ == -1 || n == 0) {
+    return batch;
+  }
+  if (tree_ != nullptr) {
+    ReadPageGuard guard = bpm_->FetchPageRead(pid_, AccessType::Scan);
+    auto node = guard.As<LeafPage>();
+    batch.push_back(entry_);
+    ValueType value;
+    int index = node->FindValue(entry_.first, value, *comparator_);
+    for (index--; index >= 0 && batch.size() < n; index--) {
+      batch.emplace_back(node->KeyAt(index), node->ValueAt(index));
+    }
+    index_ = index + 1;
+    entry_ = batch.back();
+    StepBack(std::move(guard));
+    return batch;
+  }
+  if (read_ahead_.empty()) {
+    ReadAhead();
+  }
+  ReadPageGuard guard = bpm_->FetchPageRead(pid_, AccessType::Scan);
+  auto node = guard.As<LeafPage>();
+  batch.reserve(std::min<size_t>(n, node->GetSize()));
+  batch.push_back(entry_);
+  // The entries that follow entry_ in its leaf, found again by key if the leaf may have changed since the last step.
+  int index = index_ + 1;
+  if (comparator_ != nullptr && (index_ >= node->GetSize() || (*comparator_)(node->KeyAt(index_), entry_.first) != 0)) {
+    ValueType value;
+    index = node->FindValue(entry_.first, value, *comparator_);
+    if (index == -1) {
+      index = node->GetSize();
+    } else if ((*comparator_)(node->KeyAt(index), entry_.first) == 0) {
+      index++;
+    }
+  }
+  for (; index < node->GetSize() && batch.size() < n; index++) {
+    KeyType key = node->KeyAt(index);
+    if (upper_bound_.has_value() && (*bound_comparator_)(key, *upper_bound_) > 0) {
+      // The bound ends the iteration past the batch.
+      pid_ = -1;
+      index_ = 0;
+      return batch;
+    }
+    batch.emplace_back(key, node->ValueAt(index));
+  }
+  // Step past the last entry of the batch, on to the next leaf if it was the last one of this leaf.
+  index_ = index - 1;
+  entry_ = batch.back();
+  Step(std::move(guard));
+  return batch;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SetUpperBound(const KeyType &upper_bound, const KeyComparator *comparator) {
+  BUSTUB_ASSERT(tree_ == nullptr, "reverse iterators have no upper bound");
+  upper_bound_ = upper_bound;
+  bound_comparator_ = comparator;
+  if (pid_ != -1 && (*bound_comparator_)(entry_.first, *upper_bound_) > 0) {
+    pid_ = -1;
+    index_ = 0;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::ReadAhead() {
+  std::vector<page_id_t> page_ids;
+  page_id_t frontier = read_ahead_.empty() ? pid_ : read_ahead_.back();
+  while (read_ahead_.size() < prefetch_distance_) {
+    // Only resident leaves are followed, so that this never waits on the disk; a later call picks up the rest.
+    Page *frontier_page = bpm_->FetchPageIfResident(frontier, AccessType::Scan);
+    if (frontier_page == nullptr) {
+      break;
+    }
+    frontier_page->RLatch();
+    ReadPageGuard guard{bpm_, frontier_page};
+    auto node = guard.As<LeafPage>();
+    if (upper_bound_.has_value() && node->GetSize() > 0 &&
+        (*bound_comparator_)(node->KeyAt(node->GetSize() - 1), *upper_bound_) > 0) {
+      break;
+    }
+    frontier = node->GetNextPageId();
+    guard.Drop();
+    if (frontier == INVALID_PAGE_ID) {
+      break;
+    }
+    read_ahead_.push_back(frontier);
+    page_ids.push_back(frontier);
+  }
+  if (!page_ids.empty()) {
+    bpm_->PrefetchPages(page_ids, AccessType::Scan);
+  }
+}
 
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::SeekPast(ReadPageGuard guard) -> INDEXITERATOR_TYPE & {
+  auto node = guard.As<LeafPage>();
+  // Usually nothing moved, and the entry we returned last is still where we left it.
+  int index = 0;
+  if (index_ < node->GetSize() && (*comparator_)(node->KeyAt(index_), entry_.first) == 0) {
+    index = index_ + 1;
+  } else {
+    ValueType value;
+    index = node->FindValue(entry_.first, value, *comparator_);
+    if (index == -1) {
+      index = node->GetSize();
+    } else if ((*comparator_)(node->KeyAt(index), entry_.first) == 0) {
+      index++;
+    }
+  }
+  // Past the end of the leaf, the following entries are on the right: a split moves entries there, never to the left.
+  // Leaves may also have run empty.
+  while (index == node->GetSize()) {
+    if (node->GetNextPageId() == INVALID_PAGE_ID) {
+      pid_ = -1;
+      index_ = 0;
+      return *this;
+    }
+    guard = bpm_->FetchPageRead(node->GetNextPageId(), AccessType::Scan);
+    node = guard.As<LeafPage>();
+    index = 0;
+    while (index < node->GetSize() && (*comparator_)(node->KeyAt(index), entry_.first) <= 0) {
+      index++;
+    }
+  }
+  pid_ = guard.PageId();
+  index_ = index;
+  entry_.first = node->KeyAt(index_);
+  entry_.second = node->ValueAt(index_);
   return *this;
 }
 
@@ -88,4 +271,7 @@ template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class IndexIterator<GenericKey<32>, RID, SerializedComparator<32>>;
+template class IndexIterator<GenericKey<64>, RID, SerializedComparator<64>>;
+
 }  // namespace bustub
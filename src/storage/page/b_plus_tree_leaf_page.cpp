@@ -10,7 +10,10 @@
 //===----------------------------------------------------------------------===//
 
 #include <algorithm>
+#include <cstring>
 #include <sstream>
+#include <type_traits>
+#include <vector>
 
 #include "common/config.h"
 #include "common/exception.h"
@@ -29,11 +32,20 @@ namespace bustub {
  * Including set page type, set current size to zero, set next page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(int max_size) {
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(int max_size, KeyFormat key_format) {
+  BUSTUB_ASSERT(key_format != KeyFormat::COMPRESSED || max_size <= COMPRESSED_MAX_SIZE,
+                "max size too large for a compressed leaf");
+  BUSTUB_ASSERT(key_format != KeyFormat::VARIABLE_LENGTH || max_size <= VARIABLE_LENGTH_MAX_SIZE,
+                "max size too large for a leaf with variable-length keys");
   SetPageType(IndexPageType::LEAF_PAGE);
   SetMaxSize(max_size);
   SetSize(0);
   SetNextPageId(INVALID_PAGE_ID);
+  key_format_ = key_format;
+  has_reference_ = false;
+  prefix_len_ = sizeof(KeyType);
+  suffix_len_ = sizeof(KeyType);
+  Entries().Init();
 }
 
 /**
@@ -45,6 +57,12 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return nex
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetHighKey() const -> KeyType { return high_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetHighKey(const KeyType &high_key) { high_key_ = high_key; }
+
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
@@ -54,31 +72,92 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
   // replace with your own code
   KeyType key{};
   if (index < 0 || index >= GetSize()) {
-    std::cout << "index :" << index << " -- ";
-    throw Exception("1index不在范围内");
+    // Optimistic readers get here on torn pages and just retry, so the exception does not print.
+    throw Exception("1index不在范围内", false);
+  }
+  if (key_format_ == KeyFormat::PLAIN) {
+    key = array_[index].first;
+    return key;
   }
-  key = array_[index].first;
+  if (key_format_ == KeyFormat::VARIABLE_LENGTH) {
+    return Entries().KeyAt(index);
+  }
+  // An optimistic reader may see the size and the slot size of different versions of the page; stay in bounds.
+  if ((index + 1) * SlotSize(prefix_len_, suffix_len_) > static_cast<int>(LEAF_PAGE_SLOT_AREA_SIZE)) {
+    throw Exception("1index不在范围内", false);
+  }
+  // The bytes outside of the slot are the reference key's.
+  memcpy(&key, reinterpret_cast<const char *>(array_), sizeof(KeyType));
+  memcpy(reinterpret_cast<char *>(&key) + prefix_len_, Slot(index),
+         SlotSize(prefix_len_, suffix_len_) - sizeof(ValueType));
   return key;
 }
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) { array_[index].first = key; }
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  if (key_format_ == KeyFormat::PLAIN) {
+    array_[index].first = key;
+    return;
+  }
+  if (key_format_ == KeyFormat::VARIABLE_LENGTH) {
+    Entries().SetKeyAt(index, key, GetSize());
+    return;
+  }
+  Widen(key);
+  memcpy(Slot(index), reinterpret_cast<const char *>(&key) + prefix_len_,
+         SlotSize(prefix_len_, suffix_len_) - sizeof(ValueType));
+}
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::SetValueAt(int index, const ValueType &value) { array_[index].second = value; }
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  if (key_format_ == KeyFormat::PLAIN) {
+    array_[index].second = value;
+    return;
+  }
+  if (key_format_ == KeyFormat::VARIABLE_LENGTH) {
+    Entries().SetValueAt(index, value, GetSize());
+    return;
+  }
+  memcpy(Slot(index + 1) - sizeof(ValueType), &value, sizeof(ValueType));
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const -> ValueType {
   // replace with your own code
   ValueType value{};
   if (index < 0 || index >= GetSize()) {
-    std::cout << "index = " << index << std::endl;
-    throw Exception("index不在范围内");
+    throw Exception("index不在范围内", false);
   }
-  value = array_[index].second;
+  if (key_format_ == KeyFormat::PLAIN) {
+    value = array_[index].second;
+    return value;
+  }
+  if (key_format_ == KeyFormat::VARIABLE_LENGTH) {
+    return Entries().ValueAt(index);
+  }
+  if ((index + 1) * SlotSize(prefix_len_, suffix_len_) > static_cast<int>(LEAF_PAGE_SLOT_AREA_SIZE)) {
+    throw Exception("index不在范围内", false);
+  }
+  memcpy(&value, Slot(index + 1) - sizeof(ValueType), sizeof(ValueType));
   return value;
 }
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::FindValue(const KeyType &key, ValueType &value, const KeyComparator &comparator) const
     -> int {
+  // Only GenericComparator knows the key schema, and so whether the keys are integers. IntComparator compares bare
+  // ints for the hash table pages; B+ tree pages hold GenericKeys and are never instantiated with it.
+  if constexpr (std::is_same_v<KeyComparator, GenericComparator<sizeof(KeyType)>>) {
+    if (key_format_ == KeyFormat::PLAIN && comparator.HasIntegerCodes()) {
+      // Integer keys are searched by their codes, without calling the comparator.
+      int index = CountIntegerKeys<false>(
+          reinterpret_cast<const char *>(array_), sizeof(MappingType), GetSize(), comparator.IntegerCode(key),
+          comparator.HasInt64Keys(),
+          [&](const char *entry) { return comparator.IntegerCode(*reinterpret_cast<const KeyType *>(entry)); });
+      if (index == GetSize()) {
+        return -1;
+      }
+      value = array_[index].second;
+      return index;
+    }
+  }
   int l = 0;
   int r = GetSize() - 1;
   int ans_index = -1;
@@ -96,9 +175,153 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::FindValue(const KeyType &key, ValueType &value,
   return ans_index;
 }
 
+/*****************************************************************************
+ * COMPRESSION
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::IsCompressed() const -> bool { return key_format_ == KeyFormat::COMPRESSED; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetKeyFormat() const -> KeyFormat { return key_format_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Entries() const -> SlottedEntries<KeyType, ValueType> {
+  return {reinterpret_cast<const char *>(array_), static_cast<int>(LEAF_PAGE_BODY_SIZE), &num_slots_, &heap_begin_};
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::SlotSize(int prefix_len, int suffix_len) -> int {
+  return std::max(0, static_cast<int>(sizeof(KeyType)) - prefix_len - suffix_len) + static_cast<int>(sizeof(ValueType));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Slot(int index) const -> const char * {
+  return reinterpret_cast<const char *>(array_) + sizeof(KeyType) + index * SlotSize(prefix_len_, suffix_len_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Slot(int index) -> char * {
+  return reinterpret_cast<char *>(array_) + sizeof(KeyType) + index * SlotSize(prefix_len_, suffix_len_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Fits(int size, const KeyType &key) const -> bool {
+  if (key_format_ == KeyFormat::PLAIN) {
+    return true;
+  }
+  if (key_format_ == KeyFormat::VARIABLE_LENGTH) {
+    return Entries().Fits(size, GetSize(), key);
+  }
+  int prefix_len = prefix_len_;
+  int suffix_len = suffix_len_;
+  if (has_reference_) {
+    auto reference = reinterpret_cast<const char *>(array_);
+    auto bytes = reinterpret_cast<const char *>(&key);
+    prefix_len = std::min(prefix_len, SharedPrefixLength(reference, bytes, sizeof(KeyType)));
+    suffix_len = std::min(suffix_len, SharedSuffixLength(reference, bytes, sizeof(KeyType)));
+  }
+  return size * SlotSize(prefix_len, suffix_len) <= static_cast<int>(LEAF_PAGE_SLOT_AREA_SIZE);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Fits(int size, const std::vector<KeyType> &keys) const -> bool {
+  if (key_format_ == KeyFormat::PLAIN) {
+    return true;
+  }
+  if (key_format_ == KeyFormat::VARIABLE_LENGTH) {
+    return Entries().Fits(size, GetSize(), keys);
+  }
+  // An empty page takes the first key written to it as its reference.
+  if (!has_reference_ && keys.empty()) {
+    return true;
+  }
+  auto reference = has_reference_ ? reinterpret_cast<const char *>(array_) : reinterpret_cast<const char *>(&keys[0]);
+  int prefix_len = prefix_len_;
+  int suffix_len = suffix_len_;
+  for (const auto &key : keys) {
+    auto bytes = reinterpret_cast<const char *>(&key);
+    prefix_len = std::min(prefix_len, SharedPrefixLength(reference, bytes, sizeof(KeyType)));
+    suffix_len = std::min(suffix_len, SharedSuffixLength(reference, bytes, sizeof(KeyType)));
+  }
+  return size * SlotSize(prefix_len, suffix_len) <= static_cast<int>(LEAF_PAGE_SLOT_AREA_SIZE);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Widen(const KeyType &key) {
+  auto reference = reinterpret_cast<char *>(array_);
+  auto bytes = reinterpret_cast<const char *>(&key);
+  if (!has_reference_) {
+    memcpy(reference, bytes, sizeof(KeyType));
+    has_reference_ = true;
+    return;
+  }
+  int prefix_len = std::min<int>(prefix_len_, SharedPrefixLength(reference, bytes, sizeof(KeyType)));
+  int suffix_len = std::min<int>(suffix_len_, SharedSuffixLength(reference, bytes, sizeof(KeyType)));
+  if (prefix_len == prefix_len_ && suffix_len == suffix_len_) {
+    return;
+  }
+  // Callers may fill slots before growing the size to cover them, so every slot that still fits is moved. Slots only
+  // grow, so moving them from the last one down never overwrites one that has yet to move.
+  int old_slot_size = SlotSize(prefix_len_, suffix_len_);
+  int new_slot_size = SlotSize(prefix_len, suffix_len);
+  int num_slots = LEAF_PAGE_SLOT_AREA_SIZE / new_slot_size;
+  char *slots = reference + sizeof(KeyType);
+  KeyType slot_key;
+  for (int i = num_slots - 1; i >= 0; i--) {
+    memcpy(&slot_key, reference, sizeof(KeyType));
+    memcpy(reinterpret_cast<char *>(&slot_key) + prefix_len_, slots + i * old_slot_size,
+           old_slot_size - sizeof(ValueType));
+    char value[sizeof(ValueType)];
+    memcpy(value, slots + (i + 1) * old_slot_size - sizeof(ValueType), sizeof(ValueType));
+    memcpy(slots + i * new_slot_size, reinterpret_cast<const char *>(&slot_key) + prefix_len,
+           new_slot_size - sizeof(ValueType));
+    memcpy(slots + (i + 1) * new_slot_size - sizeof(ValueType), value, sizeof(ValueType));
+  }
+  prefix_len_ = prefix_len;
+  suffix_len_ = suffix_len;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Compact() {
+  if (key_format_ == KeyFormat::PLAIN) {
+    return;
+  }
+  if (key_format_ == KeyFormat::VARIABLE_LENGTH) {
+    Entries().Compact(GetSize());
+    return;
+  }
+  std::vector<MappingType> entries;
+  entries.reserve(GetSize());
+  for (int i = 0; i < GetSize(); i++) {
+    entries.emplace_back(KeyAt(i), ValueAt(i));
+  }
+  has_reference_ = false;
+  prefix_len_ = sizeof(KeyType);
+  suffix_len_ = sizeof(KeyType);
+  if (entries.empty()) {
+    return;
+  }
+  // Take the first key as the reference, and the window all keys fit in, before writing any slot.
+  auto reference = reinterpret_cast<const char *>(&entries[0].first);
+  for (const auto &entry : entries) {
+    auto bytes = reinterpret_cast<const char *>(&entry.first);
+    prefix_len_ = std::min<int>(prefix_len_, SharedPrefixLength(reference, bytes, sizeof(KeyType)));
+    suffix_len_ = std::min<int>(suffix_len_, SharedSuffixLength(reference, bytes, sizeof(KeyType)));
+  }
+  memcpy(reinterpret_cast<char *>(array_), reference, sizeof(KeyType));
+  has_reference_ = true;
+  for (int i = 0; i < GetSize(); i++) {
+    SetKeyAt(i, entries[i].first);
+    SetValueAt(i, entries[i].second);
+  }
+}
+
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class BPlusTreeLeafPage<GenericKey<32>, RID, SerializedComparator<32>>;
+template class BPlusTreeLeafPage<GenericKey<64>, RID, SerializedComparator<64>>;
 }  // namespace bustub
@@ -10,6 +10,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/page/b_plus_tree_page.h"
+#include "common/exception.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 namespace bustub {
 
@@ -53,4 +58,38 @@ auto BPlusTreePage::IsInsertSafe() const -> bool {
 
 auto BPlusTreePage::IsDeleteSafe() const -> bool { return GetSize() - 1 >= GetMinSize(); }
 
+auto HasAvx2() -> bool {
+#if defined(__x86_64__)
+  static const bool HAS_AVX2 = __builtin_cpu_supports("avx2");
+  return HAS_AVX2;
+#else
+  return false;
+#endif
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx2"))) auto CountInt64KeysAvx2(const char *entries, size_t stride, int n, int64_t key,
+                                                         bool inclusive) -> int {
+  const __m256i offsets = _mm256_set_epi64x(3 * stride, 2 * stride, stride, 0);
+  const __m256i lanes = _mm256_set_epi64x(3, 2, 1, 0);
+  const __m256i target = _mm256_set1_epi64x(key);
+  int count = 0;
+  for (int i = 0; i < n; i += 4) {
+    // Lanes past the last entry are not loaded, and take the target key, which counts either way.
+    __m256i valid = _mm256_cmpgt_epi64(_mm256_set1_epi64x(n - i), lanes);
+    auto base = reinterpret_cast<const long long *>(entries + i * stride);  // NOLINT
+    __m256i keys = _mm256_mask_i64gather_epi64(target, base, offsets, valid, 1);
+    __m256i counted = inclusive ? _mm256_cmpgt_epi64(keys, target) : _mm256_cmpgt_epi64(target, keys);
+    count += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(counted)));
+  }
+  // Inclusive counts the keys greater than key.
+  return inclusive ? n - count : count;
+}
+#else
+auto CountInt64KeysAvx2(const char * /*entries*/, size_t /*stride*/, int /*n*/, int64_t /*key*/, bool /*inclusive*/)
+    -> int {
+  throw NotImplementedException("AVX2 is not available");
+}
+#endif
+
 }  // namespace bustub
@@ -1,5 +1,7 @@
 #include "storage/page/page_guard.h"
+#include <atomic>
 #include <cstddef>
+#include <thread>  // NOLINT
 #include "buffer/buffer_pool_manager.h"
 
 namespace bustub {
@@ -77,6 +79,58 @@ void WritePageGuard::Drop() {
 
 WritePageGuard::~WritePageGuard() { Drop(); }  // NOLINT
 
+OptimisticReadGuard::OptimisticReadGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {
+  if (page == nullptr) {
+    return;
+  }
+  while (((version_ = page->GetVersion()) & 1) != 0) {
+    std::this_thread::yield();
+  }
+}
+
+OptimisticReadGuard::OptimisticReadGuard(OptimisticReadGuard &&that) noexcept
+    : guard_(std::move(that.guard_)), version_(that.version_) {}
+
+auto OptimisticReadGuard::operator=(OptimisticReadGuard &&that) noexcept -> OptimisticReadGuard & {
+  if (this != &that) {
+    Drop();
+    guard_ = std::move(that.guard_);
+    version_ = that.version_;
+  }
+  return *this;
+}
+
+void OptimisticReadGuard::Drop() { guard_.Drop(); }
+
+OptimisticReadGuard::~OptimisticReadGuard() { Drop(); }  // NOLINT
+
+auto OptimisticReadGuard::Validate() const -> bool {
+  if (guard_.page_ == nullptr) {
+    return false;
+  }
+  // Keep the reads of the page data from moving past the second look at the version.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return guard_.page_->GetVersion() == version_;
+}
+
+auto OptimisticReadGuard::UpgradeWrite() -> std::optional<WritePageGuard> {
+  Page *page = guard_.page_;
+  if (page == nullptr) {
+    return std::nullopt;
+  }
+  page->WLatch();
+  // Our own latch accounts for exactly one bump; anything more means another writer got in first.
+  if (page->GetVersion() != version_ + 1) {
+    page->WUnlatch();
+    Drop();
+    return std::nullopt;
+  }
+  BufferPoolManager *bpm = guard_.bpm_;
+  guard_.bpm_ = nullptr;
+  guard_.page_ = nullptr;
+  return WritePageGuard(bpm, page);
+}
+
 /*
 $ make page_guard_test -j$(nproc)
 $ ./test/page_guard_test
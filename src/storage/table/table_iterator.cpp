@@ -12,6 +12,7 @@
 
 #include <cassert>
 #include <optional>
+#include <vector>
 
 #include "common/config.h"
 #include "common/exception.h"
@@ -24,21 +25,25 @@ TableIterator::TableIterator(TableHeap *table_heap, RID rid, RID stop_at_rid)
     : table_heap_(table_heap), rid_(rid), stop_at_rid_(stop_at_rid) {
   // If the rid doesn't correspond to a tuple (i.e., the table has just been initialized), then
   // we set rid_ to invalid.
-  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
+  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId(), AccessType::Scan);
   auto page = page_guard.As<TablePage>();
   if (rid_.GetSlotNum() >= page->GetNumTuples()) {
     rid_ = RID{INVALID_PAGE_ID, 0};
   }
+  page_guard.Drop();
+  if (!IsEnd()) {
+    ReadAhead();
+  }
 }
 
-auto TableIterator::GetTuple() -> std::pair<TupleMeta, Tuple> { return table_heap_->GetTuple(rid_); }
+auto TableIterator::GetTuple() -> std::pair<TupleMeta, Tuple> { return table_heap_->GetTuple(rid_, AccessType::Scan); }
 
 auto TableIterator::GetRID() -> RID { return rid_; }
 
 auto TableIterator::IsEnd() -> bool { return rid_.GetPageId() == INVALID_PAGE_ID; }
 
 auto TableIterator::operator++() -> TableIterator & {
-  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
+  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId(), AccessType::Scan);
   auto page = page_guard.As<TablePage>();
   auto next_tuple_id = rid_.GetSlotNum() + 1;
 
@@ -50,7 +55,8 @@ auto TableIterator::operator++() -> TableIterator & {
         "iterate out of bound");
   }
 
-  rid_ = RID{rid_.GetPageId(), next_tuple_id};
+  page_id_t page_id = rid_.GetPageId();
+  rid_ = RID{page_id, next_tuple_id};
 
   if (rid_ == stop_at_rid_) {
     rid_ = RID{INVALID_PAGE_ID, 0};
@@ -60,11 +66,45 @@ auto TableIterator::operator++() -> TableIterator & {
     auto next_page_id = page->GetNextPageId();
     // if next page is invalid, RID is set to invalid page; otherwise, it's the first tuple in that page.
     rid_ = RID{next_page_id, 0};
+    if (!read_ahead_.empty() && read_ahead_.front() == next_page_id) {
+      read_ahead_.pop_front();
+    } else {
+      read_ahead_.clear();
+    }
   }
 
   page_guard.Drop();
 
+  // The window only moves when the cursor moves on to the next page.
+  if (!IsEnd() && rid_.GetPageId() != page_id) {
+    ReadAhead();
+  }
+
   return *this;
 }
 
+void TableIterator::ReadAhead() {
+  auto *bpm = table_heap_->bpm_;
+  std::vector<page_id_t> page_ids;
+  page_id_t frontier = read_ahead_.empty() ? rid_.GetPageId() : read_ahead_.back();
+  while (read_ahead_.size() < table_heap_->prefetch_distance_ && frontier != stop_at_rid_.GetPageId()) {
+    Page *frontier_page = bpm->FetchPageIfResident(frontier, AccessType::Scan);
+    if (frontier_page == nullptr) {
+      break;
+    }
+    frontier_page->RLatch();
+    ReadPageGuard guard{bpm, frontier_page};
+    frontier = guard.As<TablePage>()->GetNextPageId();
+    guard.Drop();
+    if (frontier == INVALID_PAGE_ID) {
+      break;
+    }
+    read_ahead_.push_back(frontier);
+    page_ids.push_back(frontier);
+  }
+  if (!page_ids.empty()) {
+    bpm->PrefetchPages(page_ids, AccessType::Scan);
+  }
+}
+
 }  // namespace bustub
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+
+#include "buffer/arc_replacer.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer arc_replacer(4);
+
+  // Scenario: load pages 10..13 into frames 0..3. They are all seen once, so they all go to T1.
+  for (frame_id_t fid = 0; fid < 4; fid++) {
+    arc_replacer.RecordAccess(fid, AccessType::Get, 10 + fid);
+    arc_replacer.SetEvictable(fid, true);
+  }
+  ASSERT_EQ(4, arc_replacer.Size());
+  ASSERT_EQ(0, arc_replacer.GetTargetT1Size());
+
+  // Scenario: a second access moves frame 0 to T2. T1 = [1, 2, 3], T2 = [0].
+  arc_replacer.RecordAccess(0, AccessType::Get, 10);
+
+  // Scenario: T1 is larger than its target, so its LRU frame goes. Page 11 is remembered in B1.
+  frame_id_t value;
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: page 11 comes back into frame 1. The B1 hit grows the target of T1 and puts the page in T2.
+  arc_replacer.RecordAccess(1, AccessType::Get, 11);
+  arc_replacer.SetEvictable(1, true);
+  ASSERT_EQ(1, arc_replacer.GetTargetT1Size());
+
+  // Scenario: T1 = [2, 3] is still larger than the target, so frame 2 (page 12) goes to B1.
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+
+  // Scenario: with frame 3 pinned and T1 at its target, the LRU frame of T2 is next. Page 10 goes to B2.
+  arc_replacer.SetEvictable(3, false);
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Scenario: page 10 comes back. The B2 hit shrinks the target of T1 again.
+  arc_replacer.RecordAccess(0, AccessType::Get, 10);
+  ASSERT_EQ(0, arc_replacer.GetTargetT1Size());
+  ASSERT_EQ(1, arc_replacer.Size());
+
+  // Scenario: T1 only holds the pinned frame 3, so the victim comes from T2.
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+  ASSERT_FALSE(arc_replacer.Evict(&value));
+  ASSERT_EQ(0, arc_replacer.Size());
+
+  // Scenario: pinned frames cannot be removed, and frame ids are checked.
+  ASSERT_THROW(arc_replacer.Remove(3), Exception);
+  arc_replacer.SetEvictable(3, true);
+  arc_replacer.Remove(3);
+  ASSERT_EQ(0, arc_replacer.Size());
+  ASSERT_THROW(arc_replacer.RecordAccess(4), Exception);
+
+  // Scenario: the pool shrinks to one frame. Frame ids keep their range, and page 12 still fits in B1, so its return is
+  // a ghost hit.
+  arc_replacer.SetCapacity(1);
+  arc_replacer.RecordAccess(3, AccessType::Get, 12);
+  ASSERT_EQ(1, arc_replacer.GetTargetT1Size());
+  arc_replacer.SetEvictable(3, true);
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+}
+
+}  // namespace bustub
@@ -12,11 +12,22 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_pro_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/two_queue_replacer.h"
 #include "gtest/gtest.h"
+#include "storage/disk/async_disk_manager.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
@@ -82,6 +93,7 @@ TEST(BufferPoolManagerTest, DISABLED_BinaryDataTest) {
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
+  remove("test.fsm");
 
   delete bpm;
   delete disk_manager;
@@ -139,9 +151,674 @@ TEST(BufferPoolManagerTest, DISABLED_SampleTest) {
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
+  remove("test.fsm");
 
   delete bpm;
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ShardedConcurrentTest) {
+  const size_t buffer_pool_size = 16;
+  const size_t num_shards = 4;
+  const size_t num_pages = 64;
+  const size_t num_threads = 4;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2, nullptr, num_shards);
+  EXPECT_EQ(num_shards, bpm->GetNumShards());
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: every shard holds buffer_pool_size / num_shards frames, so a shard fills up on its own.
+  std::vector<page_id_t> pinned;
+  for (page_id_t page_id : page_ids) {
+    if (page_id % num_shards == 0) {
+      auto *page = bpm->FetchPage(page_id);
+      if (pinned.size() < buffer_pool_size / num_shards) {
+        ASSERT_NE(nullptr, page);
+        pinned.push_back(page_id);
+      } else {
+        EXPECT_EQ(nullptr, page);
+      }
+    }
+  }
+  // The other shards are unaffected.
+  auto *page = bpm->FetchPage(page_ids[1]);
+  ASSERT_NE(nullptr, page);
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[1], false));
+  for (page_id_t page_id : pinned) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: concurrent readers always observe the contents written for the page they fetched.
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&bpm, &page_ids, tid] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<size_t> dist(0, num_pages - 1);
+      for (size_t i = 0; i < 1000; ++i) {
+        page_id_t page_id = page_ids[dist(rng)];
+        auto guard = bpm->FetchPageRead(page_id);
+        EXPECT_EQ(std::string("page ") + std::to_string(page_id), std::string(guard.GetData()));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, LatchFreeHitTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t num_threads = 4;
+  const size_t num_rounds = 2000;
+
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2);
+
+  // Two hot pages that are updated under write guards, and a cold set that keeps evicting frames underneath.
+  std::vector<page_id_t> hot_pages(2);
+  std::vector<page_id_t> cold_pages(16);
+  for (auto *ids : {&hot_pages, &cold_pages}) {
+    for (auto &page_id : *ids) {
+      auto guard = bpm->NewPageGuarded(&page_id);
+      ASSERT_NE(INVALID_PAGE_ID, page_id);
+      *reinterpret_cast<uint64_t *>(guard.GetDataMut()) = 0;
+    }
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      for (size_t i = 0; i < num_rounds; ++i) {
+        {
+          auto guard = bpm->FetchPageWrite(hot_pages[i % hot_pages.size()]);
+          ++*guard.AsMut<uint64_t>();
+        }
+        if (i % 4 == tid) {
+          auto guard = bpm->FetchPageRead(cold_pages[(i / 4) % cold_pages.size()]);
+          EXPECT_EQ(0, *guard.As<uint64_t>());
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (page_id_t page_id : hot_pages) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(num_threads * num_rounds / hot_pages.size(), *reinterpret_cast<uint64_t *>(page->GetData()));
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    EXPECT_FALSE(bpm->UnpinPage(page_id, false));
+  }
+  // Every frame has been released, so the whole pool can be filled with fresh pages.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ReplacerPolicyTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = 32;
+  std::vector<ReplacerFactory> factories{
+      [](size_t num_frames) { return std::make_unique<LRUKReplacer>(num_frames, 2); },
+      [](size_t num_frames) { return std::make_unique<LRUReplacer>(num_frames); },
+      [](size_t num_frames) { return std::make_unique<ClockReplacer>(num_frames); },
+      [](size_t num_frames) { return std::make_unique<ARCReplacer>(num_frames); },
+      [](size_t num_frames) { return std::make_unique<TwoQueueReplacer>(num_frames); },
+      [](size_t num_frames) { return std::make_unique<ClockProReplacer>(num_frames); },
+  };
+
+  for (const auto &factory : factories) {
+    auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), factory, nullptr, 2);
+
+    std::vector<page_id_t> page_ids(num_pages);
+    for (auto &page_id : page_ids) {
+      auto guard = bpm->NewPageGuarded(&page_id);
+      ASSERT_NE(INVALID_PAGE_ID, page_id);
+      snprintf(guard.GetDataMut(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    }
+
+    // Scenario: whatever the policy, every page survives eviction, and pinned pages are never evicted.
+    std::default_random_engine rng(15445);
+    std::uniform_int_distribution<size_t> dist(0, num_pages - 1);
+    auto pinned = bpm->FetchPageBasic(page_ids[0]);
+    for (size_t i = 0; i < 1000; ++i) {
+      page_id_t page_id = page_ids[dist(rng)];
+      auto guard = bpm->FetchPageRead(page_id);
+      EXPECT_EQ(std::string("page ") + std::to_string(page_id), std::string(guard.GetData()));
+      EXPECT_EQ(std::string("page ") + std::to_string(page_ids[0]), std::string(pinned.GetData()));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ScanRingTest) {
+  // Counts page reads so that the test can tell which pages stayed resident.
+  class CountingDiskManager : public DiskManagerUnlimitedMemory {
+   public:
+    void ReadPage(page_id_t page_id, char *page_data) override {
+      reads_++;
+      DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+    }
+    size_t reads_{0};
+  };
+
+  const size_t buffer_pool_size = 16;
+  const size_t num_hot_pages = 8;
+  const size_t num_pages = 64;
+  auto disk_manager = std::make_shared<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2);
+
+  std::vector<page_id_t> page_ids(num_pages);
+  for (auto &page_id : page_ids) {
+    auto guard = bpm->NewPageGuarded(&page_id);
+    ASSERT_NE(INVALID_PAGE_ID, page_id);
+    snprintf(guard.GetDataMut(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+  }
+
+  // Scenario: the hot pages are accessed twice, which gives them a finite backward k-distance.
+  for (int round = 0; round < 2; ++round) {
+    for (size_t i = 0; i < num_hot_pages; ++i) {
+      auto guard = bpm->FetchPageRead(page_ids[i]);
+      EXPECT_EQ(std::string("page ") + std::to_string(page_ids[i]), std::string(guard.GetData()));
+    }
+  }
+
+  // Scenario: a scan over all the other pages, twice as many as the pool holds, recycles its own frames.
+  for (int round = 0; round < 2; ++round) {
+    for (size_t i = num_hot_pages; i < num_pages; ++i) {
+      auto guard = bpm->FetchPageRead(page_ids[i], AccessType::Scan);
+      EXPECT_EQ(std::string("page ") + std::to_string(page_ids[i]), std::string(guard.GetData()));
+    }
+  }
+
+  // Scenario: the working set is still resident.
+  size_t reads = disk_manager->reads_;
+  for (size_t i = 0; i < num_hot_pages; ++i) {
+    auto guard = bpm->FetchPageRead(page_ids[i]);
+    EXPECT_EQ(std::string("page ") + std::to_string(page_ids[i]), std::string(guard.GetData()));
+  }
+  EXPECT_EQ(reads, disk_manager->reads_);
+
+  // Scenario: the scan only ever used a quarter of the pool, so the other pages it touched are mostly gone.
+  reads = disk_manager->reads_;
+  for (size_t i = num_hot_pages; i < num_pages; ++i) {
+    auto guard = bpm->FetchPageRead(page_ids[i]);
+  }
+  EXPECT_LE(num_pages - num_hot_pages - buffer_pool_size, disk_manager->reads_ - reads);
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  // Counts page reads so that the test can tell which pages were read by the prefetcher.
+  class CountingDiskManager : public DiskManagerUnlimitedMemory {
+   public:
+    void ReadPage(page_id_t page_id, char *page_data) override {
+      reads_++;
+      std::this_thread::sleep_for(read_delay_.load());
+      DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+    }
+    std::atomic<size_t> reads_{0};
+    std::atomic<std::chrono::milliseconds> read_delay_{std::chrono::milliseconds(0)};
+  };
+
+  const size_t buffer_pool_size = 10;
+  const size_t num_prefetched = 4;
+  auto disk_manager = std::make_shared<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2);
+
+  // Scenario: create twice as many pages as the pool holds, so that the first ones are evicted.
+  std::vector<page_id_t> page_ids(2 * buffer_pool_size);
+  for (auto &page_id : page_ids) {
+    auto guard = bpm->NewPageGuarded(&page_id);
+    ASSERT_NE(INVALID_PAGE_ID, page_id);
+    snprintf(guard.GetDataMut(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPageIfResident(page_ids[0]));
+
+  // Scenario: prefetched pages show up in the pool in the background, while they are still being read. A fetch that
+  // finds one waits for its read, so the content is in place even without the page latch.
+  disk_manager->read_delay_ = std::chrono::milliseconds(10);
+  std::vector<page_id_t> prefetched(page_ids.begin(), page_ids.begin() + num_prefetched);
+  bpm->PrefetchPages(prefetched);
+  for (page_id_t page_id : prefetched) {
+    Page *page;
+    while ((page = bpm->FetchPageIfResident(page_id)) == nullptr) {
+      std::this_thread::yield();
+    }
+    BasicPageGuard guard{bpm.get(), page};
+    EXPECT_EQ(std::string("page ") + std::to_string(page_id), std::string(guard.GetData()));
+  }
+  EXPECT_EQ(num_prefetched, disk_manager->reads_);
+  disk_manager->read_delay_ = std::chrono::milliseconds(0);
+
+  // Scenario: fetching them now is a hit, and prefetching resident pages does not read them again.
+  bpm->PrefetchPages(prefetched);
+  for (page_id_t page_id : prefetched) {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(std::string("page ") + std::to_string(page_id), std::string(guard.GetData()));
+  }
+  EXPECT_EQ(num_prefetched, disk_manager->reads_);
+
+  // Scenario: prefetched pages are not pinned, so every frame can still be taken over.
+  std::vector<BasicPageGuard> guards;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    guards.emplace_back(bpm->NewPageGuarded(&page_id));
+    EXPECT_NE(INVALID_PAGE_ID, page_id);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, HotPagesTest) {
+  // Counts page reads so that the test can tell which pages were preloaded.
+  class CountingDiskManager : public DiskManagerUnlimitedMemory {
+   public:
+    void ReadPage(page_id_t page_id, char *page_data) override {
+      reads_++;
+      DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+    }
+    std::atomic<size_t> reads_{0};
+  };
+
+  const std::string hot_file = "test.hot";
+  const size_t buffer_pool_size = 10;
+  const size_t num_hot_pages = 4;
+  auto disk_manager = std::make_shared<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2, nullptr, 2);
+
+  // Scenario: twice as many pages as the pool holds, the last ones of which are accessed again.
+  std::vector<page_id_t> page_ids(2 * buffer_pool_size);
+  for (auto &page_id : page_ids) {
+    auto guard = bpm->NewPageGuarded(&page_id);
+    ASSERT_NE(INVALID_PAGE_ID, page_id);
+    snprintf(guard.GetDataMut(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+  }
+  std::vector<page_id_t> hot_pages(page_ids.end() - num_hot_pages, page_ids.end());
+  for (page_id_t page_id : hot_pages) {
+    auto guard = bpm->FetchPageRead(page_id);
+  }
+  ASSERT_TRUE(bpm->SaveHotPages(hot_file));
+  bpm->FlushAllPages();
+
+  // Scenario: a restarted pool reads back everything that was resident, without a miss afterwards.
+  bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2, nullptr, 2);
+  disk_manager->reads_ = 0;
+  EXPECT_EQ(buffer_pool_size, bpm->LoadHotPages(hot_file));
+  EXPECT_EQ(buffer_pool_size, disk_manager->reads_);
+  for (auto it = page_ids.end() - buffer_pool_size; it != page_ids.end(); ++it) {
+    auto guard = bpm->FetchPageRead(*it);
+    EXPECT_EQ(std::string("page ") + std::to_string(*it), std::string(guard.GetData()));
+  }
+  EXPECT_EQ(buffer_pool_size, disk_manager->reads_);
+
+  // Scenario: loading again finds every page resident, and never evicts anything.
+  EXPECT_EQ(0, bpm->LoadHotPages(hot_file));
+  EXPECT_EQ(buffer_pool_size, disk_manager->reads_);
+
+  // Scenario: a smaller pool keeps the hottest pages.
+  bpm = std::make_unique<BufferPoolManager>(num_hot_pages, disk_manager.get(), 2);
+  EXPECT_EQ(num_hot_pages, bpm->LoadHotPages(hot_file, 2));
+  for (page_id_t page_id : hot_pages) {
+    Page *page = bpm->FetchPageIfResident(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a missing file loads nothing.
+  EXPECT_EQ(0, bpm->LoadHotPages("missing.hot"));
+  remove(hot_file.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, StatsTest) {
+  const size_t buffer_pool_size = 4;
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2, nullptr, 2);
+
+  // Scenario: every page of a pool that overflows once is evicted; the ones written to are evicted dirty.
+  std::vector<page_id_t> page_ids(2 * buffer_pool_size);
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    auto guard = bpm->NewPageGuarded(&page_ids[i]);
+    ASSERT_NE(INVALID_PAGE_ID, page_ids[i]);
+    if (i % 2 == 0) {
+      snprintf(guard.GetDataMut(), BUSTUB_PAGE_SIZE, "page %d", page_ids[i]);
+    }
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size / 2, stats.clean_evictions_);
+  EXPECT_EQ(buffer_pool_size / 2, stats.dirty_evictions_);
+  EXPECT_EQ(buffer_pool_size / 2, stats.write_latency_.Count());
+  EXPECT_EQ(2 * buffer_pool_size, stats.latch_wait_.Count());
+
+  // Scenario: hits and misses, each miss being one read.
+  bpm->ResetStats();
+  for (page_id_t page_id : page_ids) {
+    auto guard = bpm->FetchPageRead(page_id);
+  }
+  for (auto it = page_ids.end() - buffer_pool_size; it != page_ids.end(); ++it) {
+    auto guard = bpm->FetchPageRead(*it);
+  }
+  stats = bpm->GetStats();
+  EXPECT_EQ(2 * buffer_pool_size, stats.misses_);
+  EXPECT_EQ(buffer_pool_size, stats.hits_);
+  EXPECT_DOUBLE_EQ(1.0 / 3, stats.HitRatio());
+  EXPECT_EQ(stats.misses_, stats.read_latency_.Count());
+  EXPECT_EQ(0, stats.pin_wait_failures_);
+
+  // Scenario: with every frame pinned, fetches and page creations fail.
+  std::vector<BasicPageGuard> guards;
+  for (auto it = page_ids.end() - buffer_pool_size; it != page_ids.end(); ++it) {
+    guards.emplace_back(bpm->FetchPageBasic(*it));
+  }
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->FetchPage(page_ids[0]));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(2, bpm->GetStats().pin_wait_failures_);
+
+  // Scenario: counters are summed up over the threads that updated them.
+  guards.clear();
+  bpm->ResetStats();
+  const size_t num_threads = 8;
+  const size_t num_fetches = 1000;
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&] {
+      for (size_t i = 0; i < num_fetches; ++i) {
+        // More threads than frames: a fetch may find every frame of its shard pinned.
+        auto guard = bpm->FetchPageBasic(page_ids[i % page_ids.size()]);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  stats = bpm->GetStats();
+  EXPECT_EQ(num_threads * num_fetches, stats.hits_ + stats.misses_ + stats.pin_wait_failures_);
+  // The pool was full from the start, so every miss evicted a page.
+  EXPECT_EQ(stats.misses_, stats.clean_evictions_ + stats.dirty_evictions_);
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, LatencyHistogramTest) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(0, histogram.Percentile(50));
+
+  // Scenario: small values are exact, larger ones are known within one eighth.
+  for (uint64_t value : {0, 1, 7, 8, 15, 16, 1000, 123456789}) {
+    size_t bucket = LatencyHistogram::BucketOf(value);
+    EXPECT_LE(value, LatencyHistogram::BucketUpperBound(bucket));
+    EXPECT_LE(LatencyHistogram::BucketUpperBound(bucket) - value, value / LatencyHistogram::SUB_BUCKETS);
+    if (bucket > 0) {
+      EXPECT_LT(LatencyHistogram::BucketUpperBound(bucket - 1), value);
+    }
+  }
+  EXPECT_EQ(LatencyHistogram::NUM_BUCKETS - 1, LatencyHistogram::BucketOf(~static_cast<uint64_t>(0)));
+
+  // Scenario: percentiles of 1..1000.
+  for (uint64_t value = 1; value <= 1000; ++value) {
+    histogram.Record(value);
+  }
+  EXPECT_EQ(1000, histogram.Count());
+  EXPECT_DOUBLE_EQ(500.5, histogram.Mean());
+  EXPECT_NEAR(500, histogram.Percentile(50), 500 / LatencyHistogram::SUB_BUCKETS);
+  EXPECT_NEAR(990, histogram.Percentile(99), 990 / LatencyHistogram::SUB_BUCKETS);
+  EXPECT_LE(1000, histogram.Max());
+
+  LatencyHistogram other;
+  other.Record(1000000);
+  histogram.Merge(other);
+  EXPECT_EQ(1001, histogram.Count());
+  EXPECT_LE(1000000, histogram.Max());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PageCleanerTest) {
+  const size_t buffer_pool_size = 10;
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2, nullptr, 2);
+
+  // Scenario: fill the pool with dirty pages and let the cleaner write all of them back.
+  std::vector<page_id_t> page_ids(buffer_pool_size);
+  for (auto &page_id : page_ids) {
+    auto guard = bpm->NewPageGuarded(&page_id);
+    ASSERT_NE(INVALID_PAGE_ID, page_id);
+    snprintf(guard.GetDataMut(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+  }
+  bpm->StartPageCleaner(1.0);
+  while (bpm->GetBackgroundWrites() < buffer_pool_size) {
+    std::this_thread::yield();
+  }
+  bpm->StopPageCleaner();
+  EXPECT_EQ(buffer_pool_size, bpm->GetBackgroundWrites());
+
+  // Scenario: the content is on disk, so evicting the pages does not write anything in the foreground.
+  char data[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id : page_ids) {
+    disk_manager->ReadPage(page_id, data);
+    EXPECT_EQ(std::string("page ") + std::to_string(page_id), std::string(data));
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto guard = bpm->NewPageGuarded(&page_id);
+    EXPECT_NE(INVALID_PAGE_ID, page_id);
+  }
+  EXPECT_EQ(0, bpm->GetForegroundWrites());
+
+  // Scenario: without the cleaner, dirty victims are written back by the eviction itself.
+  for (page_id_t page_id : page_ids) {
+    auto guard = bpm->FetchPageBasic(page_id);
+    guard.GetDataMut()[0] = 'P';
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto guard = bpm->NewPageGuarded(&page_id);
+    EXPECT_NE(INVALID_PAGE_ID, page_id);
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetForegroundWrites());
+  EXPECT_EQ(buffer_pool_size, bpm->GetBackgroundWrites());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DirectIOTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  auto disk_manager = std::make_shared<AsyncDiskManager>(db_name, 8, true, true);
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2);
+
+  // Scenario: frames can be the targets of direct I/O.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(bpm->GetPages()[i].GetData()) % BUSTUB_PAGE_SIZE);
+  }
+
+  // Scenario: pages survive a round trip through the disk.
+  std::vector<page_id_t> page_ids(2 * buffer_pool_size);
+  for (auto &page_id : page_ids) {
+    auto guard = bpm->NewPageGuarded(&page_id);
+    ASSERT_NE(INVALID_PAGE_ID, page_id);
+    snprintf(guard.GetDataMut(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+  }
+  for (page_id_t page_id : page_ids) {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(std::string("page ") + std::to_string(page_id), std::string(guard.GetData()));
+  }
+
+  bpm.reset();
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm");
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FlushAllPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  auto disk_manager = std::make_shared<DiskManager>(db_name);
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2, nullptr, 2);
+
+  std::vector<page_id_t> page_ids(buffer_pool_size);
+  for (auto &page_id : page_ids) {
+    auto guard = bpm->NewPageGuarded(&page_id);
+    ASSERT_NE(INVALID_PAGE_ID, page_id);
+    snprintf(guard.GetDataMut(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+  }
+
+  // Scenario: the pages are spread over both shards, but their ids are consecutive, so one write covers them all.
+  bpm->FlushAllPages();
+  EXPECT_EQ(buffer_pool_size, disk_manager->GetNumWrites());
+  EXPECT_EQ(buffer_pool_size - 1, bpm->GetSavedWriteCalls());
+  char data[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id : page_ids) {
+    disk_manager->ReadPage(page_id, data);
+    EXPECT_EQ(std::string("page ") + std::to_string(page_id), std::string(data));
+  }
+
+  // Scenario: a hole in the ids splits the pages in two runs. Pinned pages are written too.
+  EXPECT_TRUE(bpm->DeletePage(page_ids[4]));
+  auto guard = bpm->FetchPageBasic(page_ids[0]);
+  bpm->FlushAllPages();
+  EXPECT_EQ(2 * buffer_pool_size - 1, disk_manager->GetNumWrites());
+  EXPECT_EQ(2 * buffer_pool_size - 4, bpm->GetSavedWriteCalls());
+
+  guard.Drop();
+  bpm.reset();
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm");
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t max_pool_size = 16;
+  const size_t num_pages = 32;
+  std::vector<ReplacerFactory> factories{
+      [](size_t num_frames) { return std::make_unique<LRUKReplacer>(num_frames, 2); },
+      [](size_t num_frames) { return std::make_unique<ARCReplacer>(num_frames); },
+      [](size_t num_frames) { return std::make_unique<TwoQueueReplacer>(num_frames); },
+      [](size_t num_frames) { return std::make_unique<ClockProReplacer>(num_frames); },
+  };
+
+  for (const auto &factory : factories) {
+    auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), factory, nullptr, 2,
+                                                   max_pool_size);
+    EXPECT_EQ(max_pool_size, bpm->GetMaxPoolSize());
+
+    // Scenario: growing the pool makes room for more pinned pages.
+    std::vector<BasicPageGuard> guards;
+    std::vector<page_id_t> page_ids(num_pages);
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      guards.push_back(bpm->NewPageGuarded(&page_ids[i]));
+    }
+    page_id_t page_id;
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->Resize(max_pool_size));
+    EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+    for (size_t i = buffer_pool_size; i < max_pool_size; ++i) {
+      guards.push_back(bpm->NewPageGuarded(&page_ids[i]));
+      ASSERT_NE(INVALID_PAGE_ID, page_ids[i]);
+    }
+    for (size_t i = 0; i < max_pool_size; ++i) {
+      snprintf(guards[i].GetDataMut(), BUSTUB_PAGE_SIZE, "page %d", page_ids[i]);
+    }
+
+    // Scenario: pinned frames cannot be retired.
+    EXPECT_FALSE(bpm->Resize(2));
+    EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+    EXPECT_FALSE(bpm->Resize(1));
+    EXPECT_FALSE(bpm->Resize(max_pool_size + 1));
+
+    // Scenario: shrinking writes back the dirty pages it evicts, and the smaller pool keeps working.
+    guards.clear();
+    EXPECT_TRUE(bpm->Resize(2));
+    EXPECT_EQ(2, bpm->GetPoolSize());
+    for (size_t i = max_pool_size; i < num_pages; ++i) {
+      auto guard = bpm->NewPageGuarded(&page_ids[i]);
+      ASSERT_NE(INVALID_PAGE_ID, page_ids[i]);
+      snprintf(guard.GetDataMut(), BUSTUB_PAGE_SIZE, "page %d", page_ids[i]);
+    }
+    for (page_id_t page_id : page_ids) {
+      auto guard = bpm->FetchPageRead(page_id);
+      EXPECT_EQ(std::string("page ") + std::to_string(page_id), std::string(guard.GetData()));
+    }
+    auto guard0 = bpm->FetchPageBasic(page_ids[0]);
+    auto guard1 = bpm->FetchPageBasic(page_ids[1]);
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+    guard0.Drop();
+    guard1.Drop();
+
+    // Scenario: the pool grows back while pages are being fetched concurrently.
+    std::atomic<bool> stop{false};
+    std::thread reader([&] {
+      std::default_random_engine rng(15445);
+      std::uniform_int_distribution<size_t> dist(0, num_pages - 1);
+      while (!stop) {
+        page_id_t page_id = page_ids[dist(rng)];
+        auto guard = bpm->FetchPageRead(page_id);
+        if (guard.GetData() != nullptr) {
+          EXPECT_EQ(std::string("page ") + std::to_string(page_id), std::string(guard.GetData()));
+        }
+      }
+    });
+    for (size_t size : {8, 16, 3, 12, 2}) {
+      while (!bpm->Resize(size)) {
+        std::this_thread::yield();
+      }
+      EXPECT_EQ(size, bpm->GetPoolSize());
+    }
+    stop = true;
+    reader.join();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PageReuseTest) {
+  const size_t buffer_pool_size = 10;
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2, nullptr, 2);
+
+  std::vector<page_id_t> page_ids(2 * buffer_pool_size);
+  for (auto &page_id : page_ids) {
+    bpm->NewPageGuarded(&page_id);
+    ASSERT_NE(INVALID_PAGE_ID, page_id);
+  }
+
+  // Scenario: deleted pages, resident or not, are handed out again instead of new ones.
+  EXPECT_TRUE(bpm->DeletePage(page_ids[2]));
+  EXPECT_TRUE(bpm->DeletePage(page_ids.back()));
+  EXPECT_EQ(2, disk_manager->GetNumFreePages());
+  page_id_t page_id;
+  bpm->NewPageGuarded(&page_id);
+  EXPECT_EQ(page_ids[2], page_id);
+  bpm->NewPageGuarded(&page_id);
+  EXPECT_EQ(page_ids.back(), page_id);
+  bpm->NewPageGuarded(&page_id);
+  EXPECT_EQ(static_cast<page_id_t>(page_ids.size()), page_id);
+
+  // Scenario: a pinned page is neither deleted nor deallocated.
+  auto guard = bpm->FetchPageBasic(page_ids[0]);
+  EXPECT_FALSE(bpm->DeletePage(page_ids[0]));
+  EXPECT_EQ(0, disk_manager->GetNumFreePages());
+}
+
 }  // namespace bustub
@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer_test.cpp
+//
+// Identification: test/buffer/clock_pro_replacer_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "buffer/clock_pro_replacer.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ClockProReplacerTest, SampleTest) {
+  ClockProReplacer clock_pro_replacer(4);
+
+  // Scenario: load pages 100..103 into frames 0..3. They all start as cold pages in their test period.
+  for (frame_id_t fid = 0; fid < 4; fid++) {
+    clock_pro_replacer.RecordAccess(fid, AccessType::Get, 100 + fid);
+    clock_pro_replacer.SetEvictable(fid, true);
+  }
+  ASSERT_EQ(4, clock_pro_replacer.Size());
+  ASSERT_EQ(1, clock_pro_replacer.GetColdTarget());
+
+  // Scenario: the cold hand evicts in load order. Page 100 stays on the clock as a non-resident page.
+  frame_id_t value;
+  ASSERT_TRUE(clock_pro_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Scenario: page 100 faults in again during its test period, so it becomes hot and cold pages get more room.
+  clock_pro_replacer.RecordAccess(0, AccessType::Get, 100);
+  clock_pro_replacer.SetEvictable(0, true);
+  ASSERT_EQ(2, clock_pro_replacer.GetColdTarget());
+
+  // Scenario: a stream of pages that are used once only ever replaces cold pages; the hot page survives.
+  for (page_id_t page_id = 200; page_id < 220; page_id++) {
+    ASSERT_TRUE(clock_pro_replacer.Evict(&value));
+    ASSERT_NE(0, value);
+    clock_pro_replacer.RecordAccess(value, AccessType::Get, page_id);
+    clock_pro_replacer.SetEvictable(value, true);
+  }
+  ASSERT_EQ(4, clock_pro_replacer.Size());
+
+  // Scenario: pinned frames are never evicted nor removed, and frame ids are checked.
+  clock_pro_replacer.SetEvictable(1, false);
+  clock_pro_replacer.SetEvictable(2, false);
+  clock_pro_replacer.SetEvictable(3, false);
+  ASSERT_TRUE(clock_pro_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_FALSE(clock_pro_replacer.Evict(&value));
+  ASSERT_THROW(clock_pro_replacer.Remove(1), Exception);
+  ASSERT_THROW(clock_pro_replacer.RecordAccess(4), Exception);
+}
+
+TEST(ClockProReplacerTest, RandomizedInvariantTest) {
+  const size_t num_frames = 16;
+  ClockProReplacer clock_pro_replacer(num_frames);
+  std::vector<bool> tracked(num_frames, false);
+  std::vector<bool> evictable(num_frames, false);
+  std::default_random_engine rng(15445);
+  std::uniform_int_distribution<frame_id_t> frame_dist(0, num_frames - 1);
+  std::uniform_int_distribution<page_id_t> page_dist(0, 63);
+  std::uniform_int_distribution<int> op_dist(0, 3);
+
+  for (size_t step = 0; step < 20000; step++) {
+    frame_id_t fid = frame_dist(rng);
+    switch (op_dist(rng)) {
+      case 0:
+        // Only (re)load a frame that the replacer gave up, like the buffer pool does.
+        if (!tracked[fid]) {
+          clock_pro_replacer.RecordAccess(fid, AccessType::Get, page_dist(rng));
+          tracked[fid] = true;
+        } else {
+          clock_pro_replacer.RecordAccess(fid, AccessType::Get, INVALID_PAGE_ID);
+        }
+        break;
+      case 1:
+        clock_pro_replacer.SetEvictable(fid, tracked[fid] && !evictable[fid]);
+        evictable[fid] = tracked[fid] && !evictable[fid];
+        break;
+      case 2: {
+        frame_id_t victim;
+        bool any = std::count(evictable.begin(), evictable.end(), true) > 0;
+        ASSERT_EQ(any, clock_pro_replacer.Evict(&victim));
+        if (any) {
+          ASSERT_TRUE(evictable[victim]);
+          tracked[victim] = false;
+          evictable[victim] = false;
+        }
+        break;
+      }
+      default:
+        if (evictable[fid]) {
+          clock_pro_replacer.Remove(fid);
+          tracked[fid] = false;
+          evictable[fid] = false;
+        }
+        break;
+    }
+    ASSERT_EQ(static_cast<size_t>(std::count(evictable.begin(), evictable.end(), true)), clock_pro_replacer.Size());
+  }
+}
+
+}  // namespace bustub
@@ -95,4 +95,122 @@ TEST(LRUKReplacerTest, DISABLED_SampleTest) {
   ASSERT_EQ(false, lru_replacer.Evict(&value));
   ASSERT_EQ(0, lru_replacer.Size());
 }
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, RandomizedAgainstReferenceTest) {
+  const size_t num_frames = 64;
+  const size_t k = 3;
+  LRUKReplacer lru_replacer(num_frames, k);
+
+  // A straightforward reference: full access histories and a linear scan for the victim.
+  std::vector<std::vector<size_t>> history(num_frames);
+  std::vector<bool> evictable(num_frames, false);
+  size_t timestamp = 0;
+  auto reference_evict = [&]() -> frame_id_t {
+    frame_id_t victim = -1;
+    bool victim_inf = false;
+    size_t victim_key = 0;
+    for (size_t fid = 0; fid < num_frames; fid++) {
+      if (history[fid].empty() || !evictable[fid]) {
+        continue;
+      }
+      bool inf = history[fid].size() < k;
+      size_t key = inf ? history[fid].front() : history[fid][history[fid].size() - k];
+      if (victim == -1 || (inf && !victim_inf) || (inf == victim_inf && key < victim_key)) {
+        victim = static_cast<frame_id_t>(fid);
+        victim_inf = inf;
+        victim_key = key;
+      }
+    }
+    return victim;
+  };
+
+  std::default_random_engine rng(15445);
+  std::uniform_int_distribution<frame_id_t> frame_dist(0, num_frames - 1);
+  std::uniform_int_distribution<int> op_dist(0, 9);
+  for (size_t step = 0; step < 20000; step++) {
+    frame_id_t fid = frame_dist(rng);
+    int op = op_dist(rng);
+    if (op < 5) {
+      lru_replacer.RecordAccess(fid);
+      history[fid].push_back(++timestamp);
+    } else if (op < 8) {
+      bool set_evictable = op != 7;
+      lru_replacer.SetEvictable(fid, set_evictable);
+      if (!history[fid].empty()) {
+        evictable[fid] = set_evictable;
+      }
+    } else if (op == 8) {
+      frame_id_t expected = reference_evict();
+      frame_id_t victim = -1;
+      ASSERT_EQ(expected != -1, lru_replacer.Evict(&victim));
+      ASSERT_EQ(expected, victim);
+      if (victim != -1) {
+        history[victim].clear();
+        evictable[victim] = false;
+      }
+    } else if (evictable[fid] || history[fid].empty()) {
+      lru_replacer.Remove(fid);
+      history[fid].clear();
+      evictable[fid] = false;
+    }
+    ASSERT_EQ(static_cast<size_t>(std::count(evictable.begin(), evictable.end(), true)), lru_replacer.Size());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, LargePoolTest) {
+  const size_t num_frames = 1 << 20;
+  LRUKReplacer lru_replacer(num_frames, 2);
+
+  // Every frame is accessed once in order, and the even frames a second time, so the odd frames (+inf backward
+  // k-distance) go first in LRU order, followed by the even frames ordered by their first access.
+  for (size_t fid = 0; fid < num_frames; fid++) {
+    lru_replacer.RecordAccess(static_cast<frame_id_t>(fid));
+    lru_replacer.SetEvictable(static_cast<frame_id_t>(fid), true);
+  }
+  for (size_t fid = 0; fid < num_frames; fid += 2) {
+    lru_replacer.RecordAccess(static_cast<frame_id_t>(fid));
+  }
+  ASSERT_EQ(num_frames, lru_replacer.Size());
+
+  frame_id_t victim;
+  for (size_t fid = 1; fid < num_frames; fid += 2) {
+    ASSERT_TRUE(lru_replacer.Evict(&victim));
+    ASSERT_EQ(static_cast<frame_id_t>(fid), victim);
+  }
+  for (size_t fid = 0; fid < num_frames; fid += 2) {
+    ASSERT_TRUE(lru_replacer.Evict(&victim));
+    ASSERT_EQ(static_cast<frame_id_t>(fid), victim);
+  }
+  ASSERT_FALSE(lru_replacer.Evict(&victim));
+  ASSERT_EQ(0, lru_replacer.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, ClaimTest) {
+  LRUKReplacer lru_replacer(4, 2);
+  for (frame_id_t fid = 0; fid < 3; fid++) {
+    lru_replacer.RecordAccess(fid);
+    lru_replacer.SetEvictable(fid, true);
+  }
+  lru_replacer.RecordAccess(0);
+
+  // Frame 1 is the first victim but refuses: it stays tracked with its history and is skipped until made evictable.
+  frame_id_t victim;
+  ASSERT_TRUE(lru_replacer.Evict(&victim, [](frame_id_t fid) { return fid != 1; }));
+  ASSERT_EQ(2, victim);
+  ASSERT_EQ(1, lru_replacer.Size());
+  ASSERT_EQ(1, lru_replacer.GetAccessCount(1));
+  ASSERT_FALSE(lru_replacer.Evict(&victim, [](frame_id_t) { return false; }));
+  ASSERT_EQ(0, lru_replacer.Size());
+
+  lru_replacer.SetEvictable(0, true);
+  lru_replacer.SetEvictable(1, true);
+  ASSERT_TRUE(lru_replacer.Evict(&victim));
+  ASSERT_EQ(1, victim);
+  ASSERT_TRUE(lru_replacer.Evict(&victim));
+  ASSERT_EQ(0, victim);
+}
+
 }  // namespace bustub
@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer_test.cpp
+//
+// Identification: test/buffer/two_queue_replacer_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+
+#include "buffer/two_queue_replacer.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(TwoQueueReplacerTest, SampleTest) {
+  // Kin = 1 frame, Kout = 2 remembered pages.
+  TwoQueueReplacer two_queue_replacer(4);
+
+  // Scenario: load pages 10..13 into frames 0..3. A1in = [0, 1, 2, 3].
+  for (frame_id_t fid = 0; fid < 4; fid++) {
+    two_queue_replacer.RecordAccess(fid, AccessType::Get, 10 + fid);
+    two_queue_replacer.SetEvictable(fid, true);
+  }
+  ASSERT_EQ(4, two_queue_replacer.Size());
+
+  // Scenario: a correlated second access does not promote frame 0, which is still the oldest in A1in.
+  two_queue_replacer.RecordAccess(0, AccessType::Get, 10);
+  frame_id_t value;
+  ASSERT_TRUE(two_queue_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Scenario: page 10 is remembered in A1out, so loading it again puts it straight into Am.
+  two_queue_replacer.RecordAccess(0, AccessType::Get, 10);
+  two_queue_replacer.SetEvictable(0, true);
+
+  // Scenario: A1in = [1, 2, 3] exceeds Kin, so it is drained first even though Am holds an older load.
+  ASSERT_TRUE(two_queue_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+  ASSERT_TRUE(two_queue_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+
+  // Scenario: A1in = [3] is within Kin, so Am gives up its LRU frame.
+  ASSERT_TRUE(two_queue_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_TRUE(two_queue_replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+  ASSERT_FALSE(two_queue_replacer.Evict(&value));
+
+  // Scenario: A1out only keeps the last Kout pages leaving A1in: 12 and 13 are remembered, 11 is forgotten and page 10
+  // was not remembered at all because it left from Am.
+  two_queue_replacer.RecordAccess(0, AccessType::Get, 11);
+  two_queue_replacer.RecordAccess(1, AccessType::Get, 12);
+  two_queue_replacer.RecordAccess(2, AccessType::Get, 10);
+  for (frame_id_t fid = 0; fid < 3; fid++) {
+    two_queue_replacer.SetEvictable(fid, true);
+  }
+  // A1in = [0, 2] exceeds Kin; Am = [1].
+  ASSERT_TRUE(two_queue_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_TRUE(two_queue_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+  ASSERT_EQ(1, two_queue_replacer.Size());
+
+  // Scenario: pinned frames cannot be removed, and frame ids are checked.
+  two_queue_replacer.SetEvictable(2, false);
+  ASSERT_THROW(two_queue_replacer.Remove(2), Exception);
+  ASSERT_THROW(two_queue_replacer.SetEvictable(-1, true), Exception);
+}
+
+}  // namespace bustub
@@ -51,6 +51,7 @@ TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
   bpm->UnpinPage(directory_page_id, true);
   disk_manager->ShutDown();
   remove("test.db");
+  remove("test.fsm");
   delete disk_manager;
   delete bpm;
 }
@@ -109,6 +110,7 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
   bpm->UnpinPage(bucket_page_id, true);
   disk_manager->ShutDown();
   remove("test.db");
+  remove("test.fsm");
   delete disk_manager;
   delete bpm;
 }
@@ -113,6 +113,7 @@ TEST(HashTableTest, DISABLED_SampleTest) {
 
   disk_manager->ShutDown();
   remove("test.db");
+  remove("test.fsm");
   delete disk_manager;
   delete bpm;
 }
@@ -0,0 +1,249 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bulk_load_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bulk_load_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sorter.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using BulkLoadTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using BulkLoadLeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+using BulkLoadInternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+
+// Feeds keys[0..] to BulkLoad(), with a RID derived from the key.
+auto EntriesOf(const std::vector<int64_t> &keys) -> std::function<bool(std::pair<GenericKey<8>, RID> *)> {
+  auto pos = std::make_shared<size_t>(0);
+  return [&keys, pos](std::pair<GenericKey<8>, RID> *entry) {
+    if (*pos == keys.size()) {
+      return false;
+    }
+    int64_t key = keys[(*pos)++];
+    entry->first.SetFromInteger(key);
+    entry->second.Set(static_cast<int32_t>(key >> 32), static_cast<uint32_t>(key & 0xFFFFFFFF));
+    return true;
+  };
+}
+
+// Checks that non-root pages are at least half full, and returns the sizes of the leaves from left to right.
+auto LeafSizes(BufferPoolManager *bpm, page_id_t root_page_id) -> std::vector<int> {
+  page_id_t page_id = root_page_id;
+  while (true) {
+    auto guard = bpm->FetchPageRead(page_id);
+    if (guard.As<BPlusTreePage>()->IsLeafPage()) {
+      break;
+    }
+    auto internal_page = guard.As<BulkLoadInternalPage>();
+    if (page_id != root_page_id) {
+      EXPECT_GE(internal_page->GetSize(), internal_page->GetMinSize());
+    }
+    page_id = internal_page->ValueAt(0);
+  }
+  std::vector<int> sizes;
+  while (page_id != INVALID_PAGE_ID) {
+    auto guard = bpm->FetchPageRead(page_id);
+    auto leaf_page = guard.As<BulkLoadLeafPage>();
+    if (page_id != root_page_id) {
+      EXPECT_GE(leaf_page->GetSize(), leaf_page->GetMinSize());
+    }
+    sizes.push_back(leaf_page->GetSize());
+    page_id = leaf_page->GetNextPageId();
+  }
+  return sizes;
+}
+
+TEST(BPlusTreeBulkLoadTest, BulkLoadTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  // Every size of the last leaf, from a leaf of its own to being merged into the one before it.
+  for (int64_t num_keys = 0; num_keys <= 60; num_keys++) {
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    BulkLoadTree tree("foo_pk", page_id, bpm, comparator, 6, 4);
+    std::vector<int64_t> keys;
+    for (int64_t key = 1; key <= num_keys; key++) {
+      keys.push_back(key * 2);
+    }
+    ASSERT_EQ(num_keys, tree.BulkLoad(EntriesOf(keys), 1.0));
+    bpm->UnpinPage(page_id, true);
+    if (num_keys == 0) {
+      ASSERT_TRUE(tree.IsEmpty());
+      continue;
+    }
+
+    // Leaves hold 5 entries at most; only the last two may hold fewer.
+    auto sizes = LeafSizes(bpm, tree.GetRootPageId());
+    for (size_t i = 0; i + 2 < sizes.size(); i++) {
+      ASSERT_EQ(5, sizes[i]);
+    }
+
+    std::vector<RID> result;
+    GenericKey<8> index_key;
+    for (auto key : keys) {
+      result.clear();
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.GetValue(index_key, &result));
+      ASSERT_EQ(key, static_cast<int64_t>(result[0].GetSlotNum()));
+      index_key.SetFromInteger(key + 1);
+      ASSERT_FALSE(tree.GetValue(index_key, &result));
+    }
+    int64_t expected = 2;
+    for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+      ASSERT_EQ(expected, (*iter).first.ToString());
+      expected += 2;
+    }
+    ASSERT_EQ(num_keys * 2 + 2, expected);
+
+    // The loaded tree takes inserts and removals like any other.
+    RID rid;
+    for (auto key : keys) {
+      index_key.SetFromInteger(key + 1);
+      rid.Set(0, key + 1);
+      ASSERT_TRUE(tree.Insert(index_key, rid));
+    }
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, nullptr);
+    }
+    expected = 3;
+    for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+      ASSERT_EQ(expected, (*iter).first.ToString());
+      expected += 2;
+    }
+    ASSERT_EQ(num_keys * 2 + 3, expected);
+  }
+
+  delete bpm;
+}
+
+TEST(BPlusTreeBulkLoadTest, FillFactorTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BulkLoadTree tree("foo_pk", page_id, bpm, comparator, 21, 10);
+
+  // Half full leaves leave room for inserts; duplicate keys are skipped, and unsorted keys are refused.
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 1000; key++) {
+    keys.push_back(key);
+    if (key % 100 == 0) {
+      keys.push_back(key);
+    }
+  }
+  ASSERT_EQ(1000, tree.BulkLoad(EntriesOf(keys), 0.5));
+  auto sizes = LeafSizes(bpm, tree.GetRootPageId());
+  ASSERT_EQ(100, sizes.size());
+  ASSERT_TRUE(std::all_of(sizes.begin(), sizes.end(), [](int size) { return size == 10; }));
+
+  page_id_t other_page_id;
+  bpm->NewPage(&other_page_id);
+  BulkLoadTree other_tree("bar_pk", other_page_id, bpm, comparator, 21, 10);
+  std::vector<int64_t> unsorted_keys{1, 3, 2};
+  ASSERT_THROW(other_tree.BulkLoad(EntriesOf(unsorted_keys)), Exception);
+
+  bpm->UnpinPage(page_id, true);
+  bpm->UnpinPage(other_page_id, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeBulkLoadTest, BLinkBulkLoadTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BulkLoadTree tree("foo_pk", page_id, bpm, comparator, 4, 4);
+  tree.SetBLink(true);
+
+  // Bulk loaded pages carry high keys and right links, so concurrent inserts can split them B-link style.
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 2000; key += 2) {
+    keys.push_back(key);
+  }
+  ASSERT_EQ(1000, tree.BulkLoad(EntriesOf(keys)));
+  std::vector<std::thread> threads;
+  for (int64_t t = 0; t < 4; t++) {
+    threads.emplace_back([&tree, t]() {
+      GenericKey<8> index_key;
+      RID rid;
+      for (int64_t key = 1 + 2 * t; key < 2000; key += 8) {
+        index_key.SetFromInteger(key);
+        rid.Set(0, key);
+        tree.Insert(index_key, rid);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  int64_t expected = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ(expected, (*iter).first.ToString());
+    expected++;
+  }
+  ASSERT_EQ(2000, expected);
+
+  bpm->UnpinPage(page_id, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeBulkLoadTest, ExternalSorterTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  for (size_t run_size : {7, 100000}) {
+    // Keys repeat; the slot numbers record the order entries were added in, which ties have to keep.
+    ExternalSorter<GenericKey<8>, RID, GenericComparator<8>> sorter(comparator, run_size);
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int64_t> dist(0, 200);
+    std::vector<std::pair<int64_t, uint32_t>> expected;
+    GenericKey<8> index_key;
+    for (uint32_t i = 0; i < 1000; i++) {
+      int64_t key = dist(gen);
+      index_key.SetFromInteger(key);
+      sorter.Add(index_key, RID(0, i));
+      expected.emplace_back(key, i);
+    }
+    sorter.Finish();
+    ASSERT_EQ(run_size == 7 ? 143 : 0, sorter.NumSpilledRuns());
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    std::pair<GenericKey<8>, RID> entry;
+    for (const auto &[key, slot] : expected) {
+      ASSERT_TRUE(sorter.Next(&entry));
+      ASSERT_EQ(key, entry.first.ToString());
+      ASSERT_EQ(slot, entry.second.GetSlotNum());
+    }
+    ASSERT_FALSE(sorter.Next(&entry));
+  }
+}
+
+}  // namespace bustub
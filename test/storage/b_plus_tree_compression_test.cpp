@@ -0,0 +1,228 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_compression_test.cpp
+//
+// Identification: test/storage/b_plus_tree_compression_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <thread>  // NOLINT
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using CompositeTree = BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
+using CompositeLeafPage = BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
+using CompositeInternalPage = BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
+
+// Builds the key (a, b) of the schema "a bigint,b bigint".
+auto CompositeKey(Schema *key_schema, int64_t a, int64_t b) -> GenericKey<16> {
+  GenericKey<16> key;
+  key.SetFromKey(Tuple({ValueFactory::GetBigIntValue(a), ValueFactory::GetBigIntValue(b)}, key_schema));
+  return key;
+}
+
+// Returns the height of a tree and its number of leaves.
+auto TreeShape(BufferPoolManager *bpm, page_id_t root_page_id) -> std::pair<int, int> {
+  int height = 1;
+  auto guard = bpm->FetchPageRead(root_page_id);
+  while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+    guard = bpm->FetchPageRead(guard.As<CompositeInternalPage>()->ValueAt(0));
+    height++;
+  }
+  int num_leaves = 1;
+  while (guard.As<CompositeLeafPage>()->GetNextPageId() != INVALID_PAGE_ID) {
+    guard = bpm->FetchPageRead(guard.As<CompositeLeafPage>()->GetNextPageId());
+    num_leaves++;
+  }
+  return {height, num_leaves};
+}
+
+TEST(BPlusTreeCompressionTest, ShortestSeparatorTest) {
+  auto key_schema = ParseCreateStatement("a bigint,b bigint");
+  GenericComparator<16> comparator(key_schema.get());
+
+  // Past the first column that differs, the separator takes zero, or the smallest value below zero.
+  auto left = CompositeKey(key_schema.get(), 1, 5);
+  auto separator = comparator.ShortestSeparator(left, CompositeKey(key_schema.get(), 2, 3));
+  ASSERT_EQ(0, comparator(CompositeKey(key_schema.get(), 2, 0), separator));
+  separator = comparator.ShortestSeparator(left, CompositeKey(key_schema.get(), 2, -3));
+  ASSERT_EQ(0, comparator(CompositeKey(key_schema.get(), 2, BUSTUB_INT64_MIN), separator));
+  separator = comparator.ShortestSeparator(left, CompositeKey(key_schema.get(), 1, 9));
+  ASSERT_EQ(0, comparator(CompositeKey(key_schema.get(), 1, 9), separator));
+}
+
+TEST(BPlusTreeCompressionTest, CompressionTest) {
+  auto key_schema = ParseCreateStatement("a bigint,b bigint");
+  GenericComparator<16> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(100, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  CompositeTree tree("foo_pk", page_id, bpm, comparator, CompositeLeafPage::COMPRESSED_MAX_SIZE,
+                     CompositeInternalPage::COMPRESSED_MAX_SIZE);
+  tree.SetKeyCompression(true);
+  page_id_t plain_page_id;
+  bpm->NewPage(&plain_page_id);
+  CompositeTree plain_tree("bar_pk", plain_page_id, bpm, comparator);
+
+  // Keys that differ in their low bytes only, inserted in random order.
+  const int64_t num_keys = 20000;
+  std::vector<int64_t> keys(num_keys);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+  for (auto key : keys) {
+    ASSERT_TRUE(tree.Insert(CompositeKey(key_schema.get(), key / 16, key % 16), RID(0, key)));
+    ASSERT_TRUE(plain_tree.Insert(CompositeKey(key_schema.get(), key / 16, key % 16), RID(0, key)));
+  }
+  ASSERT_FALSE(tree.Insert(CompositeKey(key_schema.get(), 0, 0), RID(0, 0)));
+
+  // Compressed pages hold more entries: the tree is no higher, and has fewer leaves.
+  auto [height, num_leaves] = TreeShape(bpm, tree.GetRootPageId());
+  auto [plain_height, plain_num_leaves] = TreeShape(bpm, plain_tree.GetRootPageId());
+  ASSERT_LE(height, plain_height);
+  ASSERT_LT(num_leaves * 5, plain_num_leaves * 4);
+
+  std::vector<RID> result;
+  for (int64_t key = 0; key < num_keys; key++) {
+    result.clear();
+    ASSERT_TRUE(tree.GetValue(CompositeKey(key_schema.get(), key / 16, key % 16), &result));
+    ASSERT_EQ(key, result[0].GetSlotNum());
+  }
+  ASSERT_FALSE(tree.GetValue(CompositeKey(key_schema.get(), num_keys, 0), &result));
+
+  // Remove every other key; leaves that run less than half full merge or borrow, and take the keys back.
+  for (int64_t key = 0; key < num_keys; key += 2) {
+    tree.Remove(CompositeKey(key_schema.get(), key / 16, key % 16), nullptr);
+  }
+  ASSERT_LT(TreeShape(bpm, tree.GetRootPageId()).second, num_leaves);
+  int64_t expected = 1;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ(expected, (*iter).second.GetSlotNum());
+    expected += 2;
+  }
+  ASSERT_EQ(num_keys + 1, expected);
+  expected = 101;
+  for (auto iter = tree.Begin(CompositeKey(key_schema.get(), 6, 4)); iter != tree.End(); ++iter) {
+    ASSERT_EQ(expected, (*iter).second.GetSlotNum());
+    expected += 2;
+  }
+  for (int64_t key = 0; key < num_keys; key += 2) {
+    ASSERT_TRUE(tree.Insert(CompositeKey(key_schema.get(), key / 16, key % 16), RID(0, key)));
+  }
+  expected = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ(expected, (*iter).second.GetSlotNum());
+    expected++;
+  }
+  ASSERT_EQ(num_keys, expected);
+
+  // A tree that runs empty is empty.
+  for (int64_t key = 0; key < num_keys; key++) {
+    tree.Remove(CompositeKey(key_schema.get(), key / 16, key % 16), nullptr);
+  }
+  ASSERT_TRUE(tree.IsEmpty());
+  ASSERT_TRUE(tree.Begin() == tree.End());
+
+  bpm->UnpinPage(page_id, true);
+  bpm->UnpinPage(plain_page_id, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeCompressionTest, BLinkCompressionTest) {
+  auto key_schema = ParseCreateStatement("a bigint,b bigint");
+  GenericComparator<16> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(100, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  CompositeTree tree("foo_pk", page_id, bpm, comparator, CompositeLeafPage::COMPRESSED_MAX_SIZE,
+                     CompositeInternalPage::COMPRESSED_MAX_SIZE);
+  tree.SetBLink(true);
+  tree.SetKeyCompression(true);
+
+  const int64_t num_keys = 20000;
+  std::vector<std::thread> threads;
+  for (int64_t t = 0; t < 4; t++) {
+    threads.emplace_back([&, t]() {
+      for (int64_t key = t; key < num_keys; key += 4) {
+        tree.Insert(CompositeKey(key_schema.get(), key / 16, key % 16), RID(0, key));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  int64_t expected = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ(expected, (*iter).second.GetSlotNum());
+    expected++;
+  }
+  ASSERT_EQ(num_keys, expected);
+
+  bpm->UnpinPage(page_id, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeCompressionTest, BulkLoadCompressionTest) {
+  auto key_schema = ParseCreateStatement("a bigint,b bigint");
+  GenericComparator<16> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(100, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  CompositeTree tree("foo_pk", page_id, bpm, comparator, CompositeLeafPage::COMPRESSED_MAX_SIZE,
+                     CompositeInternalPage::COMPRESSED_MAX_SIZE);
+  tree.SetKeyCompression(true);
+
+  // Full leaves end where the next key does not fit rather than at a count.
+  const int64_t num_keys = 20000;
+  int64_t next_key = 0;
+  auto next = [&](std::pair<GenericKey<16>, RID> *entry) {
+    if (next_key == num_keys) {
+      return false;
+    }
+    entry->first = CompositeKey(key_schema.get(), next_key / 16, next_key % 16);
+    entry->second = RID(0, next_key);
+    next_key++;
+    return true;
+  };
+  ASSERT_EQ(num_keys, tree.BulkLoad(next, 1.0));
+
+  std::vector<RID> result;
+  for (int64_t key = 0; key < num_keys; key++) {
+    result.clear();
+    ASSERT_TRUE(tree.GetValue(CompositeKey(key_schema.get(), key / 16, key % 16), &result));
+    ASSERT_EQ(key, result[0].GetSlotNum());
+  }
+  for (int64_t key = 0; key < num_keys; key++) {
+    ASSERT_TRUE(tree.Insert(CompositeKey(key_schema.get(), key / 16, 16 + key % 16), RID(1, key)));
+  }
+  int64_t expected = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ(expected % 32 < 16 ? 0 : 1, (*iter).second.GetPageId());
+    expected++;
+  }
+  ASSERT_EQ(num_keys * 2, expected);
+
+  bpm->UnpinPage(page_id, true);
+  delete bpm;
+}
+
+}  // namespace bustub
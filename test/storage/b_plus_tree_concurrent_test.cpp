@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
@@ -336,6 +337,128 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest1) {
   delete bpm;
 }
 
+TEST(BPlusTreeConcurrentTest, BLinkTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 3, 3);
+  tree.SetBLink(true);
+
+  // Insert out of order so that splits happen all over the tree.
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 1000; key++) {
+    keys.push_back((key * 7919) % 1000 + 1);
+  }
+  InsertHelper(&tree, keys);
+  std::vector<int64_t> all_keys(keys);
+  std::sort(all_keys.begin(), all_keys.end());
+  LookupHelper(&tree, all_keys, 1);
+  int64_t expected = 1;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ(expected, (*iter).first.ToString());
+    expected++;
+  }
+  ASSERT_EQ(1001, expected);
+
+  // Removals leave pages underfull or empty; lookups and scans skip them.
+  std::vector<int64_t> remove_keys;
+  std::vector<int64_t> remaining_keys;
+  for (auto key : all_keys) {
+    (key % 10 < 7 ? remove_keys : remaining_keys).push_back(key);
+  }
+  DeleteHelper(&tree, remove_keys);
+  LookupHelper(&tree, remaining_keys, 1);
+  std::vector<RID> result;
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(remove_keys[0]);
+  ASSERT_FALSE(tree.GetValue(index_key, &result));
+  size_t size = 0;
+  index_key.SetFromInteger(remove_keys[0]);
+  for (auto iter = tree.Begin(index_key); iter != tree.End(); ++iter) {
+    ASSERT_EQ(remaining_keys[size], (*iter).first.ToString());
+    size++;
+  }
+  ASSERT_EQ(remaining_keys.size(), size);
+
+  DeleteHelper(&tree, remaining_keys);
+  ASSERT_TRUE(tree.IsEmpty());
+  ASSERT_TRUE(tree.Begin() == tree.End());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeConcurrentTest, BLinkMixTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 3, 3);
+  tree.SetBLink(true);
+
+  std::vector<int64_t> perserved_keys;
+  std::vector<int64_t> dynamic_keys;
+  int64_t total_keys = 5000;
+  int64_t sieve = 5;
+  for (int64_t i = 1; i <= total_keys; i++) {
+    if (i % sieve == 0) {
+      perserved_keys.push_back(i);
+    } else {
+      dynamic_keys.push_back(i);
+    }
+  }
+  InsertHelper(&tree, perserved_keys, 1);
+
+  // Scans race with the splits of the inserters, and must still see every preserved key once and in order.
+  auto insert_task = [&](int tid) { InsertHelperSplit(&tree, dynamic_keys, 2, tid / 4); };
+  auto delete_task = [&](int tid) { DeleteHelper(&tree, dynamic_keys, tid); };
+  auto lookup_task = [&](int tid) { LookupHelper(&tree, perserved_keys, tid); };
+  auto scan_task = [&](int tid) {
+    size_t size = 0;
+    int64_t last = 0;
+    for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+      int64_t key = (*iter).first.ToString();
+      ASSERT_LT(last, key);
+      last = key;
+      if (key % sieve == 0) {
+        size++;
+      }
+    }
+    ASSERT_EQ(size, perserved_keys.size());
+  };
+
+  std::vector<std::thread> threads;
+  std::vector<std::function<void(int)>> tasks{insert_task, delete_task, lookup_task, scan_task};
+  size_t num_threads = 8;
+  for (size_t i = 0; i < num_threads; i++) {
+    threads.emplace_back(std::thread{tasks[i % tasks.size()], i});
+  }
+  for (size_t i = 0; i < num_threads; i++) {
+    threads[i].join();
+  }
+
+  LookupHelper(&tree, perserved_keys, 1);
+  size_t size = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    if ((*iter).first.ToString() % sieve == 0) {
+      size++;
+    }
+  }
+  ASSERT_EQ(size, perserved_keys.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
 TEST(BPlusTreeConcurrentTest, MixTest2) {
   while (1) {
     // create KeyComparator and index schema
@@ -3,6 +3,7 @@
  */
 
 #include <chrono>  // NOLINT
+#include <atomic>
 #include <cstdio>
 #include <functional>
 #include <future>  // NOLINT
@@ -76,6 +77,197 @@ bool BPlusTreeLockBenchmarkCall(size_t num_threads, int leaf_node_size, bool wit
   return success;
 }
 
+auto BPlusTreeReadBenchmarkCall(size_t num_threads, bool optimistic_reads) -> bool {
+  std::atomic<bool> success = true;
+
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManagerMemory(256 << 10);  // 1GB
+  auto *bpm = new BufferPoolManager(1024, disk_manager);
+
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 32, 32);
+  tree.SetOptimisticReads(optimistic_reads);
+
+  const int64_t num_keys = 5000;
+  const int lookups_per_thread = 5000;
+  GenericKey<8> index_key;
+  RID rid;
+  for (int64_t key = 0; key < num_keys; key++) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid);
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_threads; i++) {
+    threads.emplace_back([&tree, &success, i, num_keys, lookups_per_thread]() {
+      GenericKey<8> index_key;
+      std::vector<RID> result;
+      for (int j = 0; j < lookups_per_thread; j++) {
+        int64_t key = (i * 7919 + j * 104729) % num_keys;
+        index_key.SetFromInteger(key);
+        result.clear();
+        if (!tree.GetValue(index_key, &result) || result[0].GetSlotNum() != key) {
+          success = false;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+
+  return success;
+}
+
+auto BPlusTreeWriteBenchmarkCall(size_t num_threads, bool optimistic_writes) -> bool {
+  bool success = true;
+
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManagerMemory(256 << 10);  // 1GB
+  auto *bpm = new BufferPoolManager(1024, disk_manager);
+
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator);
+  tree.SetOptimisticWrites(optimistic_writes);
+
+  // Threads interleave their keys, so that they all insert into and remove from the same leaves.
+  const int64_t keys_per_thread = 1000;
+  std::vector<std::thread> threads;
+  std::atomic<bool> all_found{true};
+  for (size_t i = 0; i < num_threads; i++) {
+    threads.emplace_back([&tree, &all_found, i, num_threads, keys_per_thread]() {
+      GenericKey<8> index_key;
+      RID rid;
+      auto *transaction = new Transaction(static_cast<txn_id_t>(i + 1));
+      for (int64_t j = 0; j < keys_per_thread; j++) {
+        int64_t key = j * static_cast<int64_t>(num_threads) + static_cast<int64_t>(i);
+        rid.Set(static_cast<int32_t>(key >> 32), static_cast<uint32_t>(key & 0xFFFFFFFF));
+        index_key.SetFromInteger(key);
+        tree.Insert(index_key, rid, transaction);
+      }
+      // Remove every other key again, and check that the others survived everybody's changes.
+      for (int64_t j = 0; j < keys_per_thread; j++) {
+        int64_t key = j * static_cast<int64_t>(num_threads) + static_cast<int64_t>(i);
+        index_key.SetFromInteger(key);
+        if (j % 2 == 1) {
+          tree.Remove(index_key, transaction);
+        }
+      }
+      std::vector<RID> result;
+      for (int64_t j = 0; j < keys_per_thread; j += 2) {
+        int64_t key = j * static_cast<int64_t>(num_threads) + static_cast<int64_t>(i);
+        index_key.SetFromInteger(key);
+        result.clear();
+        if (!tree.GetValue(index_key, &result) || result.size() != 1 || result[0].GetSlotNum() != key) {
+          all_found = false;
+        }
+      }
+      delete transaction;
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  success = all_found;
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+
+  return success;
+}
+
+TEST(BPlusTreeContentionTest, BPlusTreeWriteContentionBenchmark) {  // NOLINT
+  std::cout << "This test compares inserts and removes from 32 threads with optimistic and pessimistic latch crabbing."
+            << std::endl;
+
+  std::vector<size_t> time_ms_optimistic;
+  std::vector<size_t> time_ms_pessimistic;
+  for (size_t iter = 0; iter < 10; iter++) {
+    bool optimistic = iter % 2 == 0;
+    auto clock_start = std::chrono::system_clock::now();
+    ASSERT_TRUE(BPlusTreeWriteBenchmarkCall(32, optimistic));
+    auto clock_end = std::chrono::system_clock::now();
+    auto dur = std::chrono::duration_cast<std::chrono::milliseconds>(clock_end - clock_start);
+    if (optimistic) {
+      time_ms_optimistic.push_back(dur.count());
+    } else {
+      time_ms_pessimistic.push_back(dur.count());
+    }
+  }
+
+  std::cout << "<<< BEGIN4" << std::endl;
+  double ratio_1 = 0;
+  double ratio_2 = 0;
+  std::cout << "Optimistic Write Time: ";
+  for (auto x : time_ms_optimistic) {
+    std::cout << x << " ";
+    ratio_1 += x;
+  }
+  std::cout << std::endl;
+
+  std::cout << "Pessimistic Write Time: ";
+  for (auto x : time_ms_pessimistic) {
+    std::cout << x << " ";
+    ratio_2 += x;
+  }
+  std::cout << std::endl;
+  std::cout << "Ratio: " << ratio_1 / ratio_2 << std::endl;
+  std::cout << ">>> END4" << std::endl;
+}
+
+TEST(BPlusTreeContentionTest, BPlusTreeReadContentionBenchmark) {  // NOLINT
+  std::cout << "This test compares point lookups from 32 threads with optimistic reads and with read latches."
+            << std::endl;
+
+  std::vector<size_t> time_ms_optimistic;
+  std::vector<size_t> time_ms_latched;
+  for (size_t iter = 0; iter < 10; iter++) {
+    bool optimistic = iter % 2 == 0;
+    auto clock_start = std::chrono::system_clock::now();
+    ASSERT_TRUE(BPlusTreeReadBenchmarkCall(32, optimistic));
+    auto clock_end = std::chrono::system_clock::now();
+    auto dur = std::chrono::duration_cast<std::chrono::milliseconds>(clock_end - clock_start);
+    if (optimistic) {
+      time_ms_optimistic.push_back(dur.count());
+    } else {
+      time_ms_latched.push_back(dur.count());
+    }
+  }
+
+  std::cout << "<<< BEGIN3" << std::endl;
+  double ratio_1 = 0;
+  double ratio_2 = 0;
+  std::cout << "Optimistic Read Time: ";
+  for (auto x : time_ms_optimistic) {
+    std::cout << x << " ";
+    ratio_1 += x;
+  }
+  std::cout << std::endl;
+
+  std::cout << "Latched Read Time: ";
+  for (auto x : time_ms_latched) {
+    std::cout << x << " ";
+    ratio_2 += x;
+  }
+  std::cout << std::endl;
+  std::cout << "Ratio: " << ratio_1 / ratio_2 << std::endl;
+  std::cout << ">>> END3" << std::endl;
+}
+
 TEST(BPlusTreeContentionTest, BPlusTreeContentionBenchmark) {  // NOLINT
   std::cout << "This test will see how your B+ tree performance differs with and without contention." << std::endl;
   std::cout << "If your submission timeout, segfault, or didn't implement lock crabbing, we will manually deduct all "
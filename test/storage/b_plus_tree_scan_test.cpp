@@ -0,0 +1,204 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_scan_test.cpp
+//
+// Identification: test/storage/b_plus_tree_scan_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using Iterator = IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
+
+auto IntegerKey(int64_t key) -> GenericKey<8> {
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(key);
+  return index_key;
+}
+
+// Inserts the even keys below 2 * num_keys, in random order.
+void InsertEvenKeys(Tree *tree, int64_t num_keys) {
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; key++) {
+    keys.push_back(key * 2);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+  for (auto key : keys) {
+    ASSERT_TRUE(tree->Insert(IntegerKey(key), RID(0, key)));
+  }
+}
+
+// Drains the iterator in batches of up to n, checking that none is larger, and returns the slots of the entries.
+auto ScanBatches(Iterator iter, size_t n) -> std::vector<int64_t> {
+  std::vector<int64_t> slots;
+  for (auto batch = iter.NextBatch(n); !batch.empty(); batch = iter.NextBatch(n)) {
+    EXPECT_LE(batch.size(), n);
+    for (const auto &entry : batch) {
+      slots.push_back(entry.second.GetSlotNum());
+    }
+  }
+  return slots;
+}
+
+// Returns the even keys from lower to upper, inclusive.
+auto EvenKeys(int64_t lower, int64_t upper) -> std::vector<int64_t> {
+  std::vector<int64_t> keys;
+  for (int64_t key = lower + (lower % 2); key <= upper; key += 2) {
+    keys.push_back(key);
+  }
+  return keys;
+}
+
+void CheckScans(Tree *tree, int64_t num_keys) {
+  const int64_t max_key = num_keys * 2 - 2;
+  for (size_t n : {1, 3, 7, 1000}) {
+    ASSERT_EQ(EvenKeys(0, max_key), ScanBatches(tree->Begin(), n));
+    // Keys past the last one of a leaf start on the next leaf.
+    for (int64_t lower = 0; lower <= max_key + 1; lower += 17) {
+      ASSERT_EQ(EvenKeys(lower, max_key), ScanBatches(tree->Begin(IntegerKey(lower)), n));
+      for (int64_t upper : {lower - 1, lower, lower + 1, lower + 40, max_key, max_key + 5}) {
+        ASSERT_EQ(EvenKeys(lower, std::min(upper, max_key)),
+                  ScanBatches(tree->Begin(IntegerKey(lower), IntegerKey(upper)), n));
+      }
+    }
+  }
+
+  // Batches and single steps mix, and the upper bound ends both.
+  auto iter = tree->Begin(IntegerKey(10), IntegerKey(300));
+  std::vector<int64_t> slots;
+  while (iter != tree->End()) {
+    slots.push_back((*iter).second.GetSlotNum());
+    ++iter;
+    for (const auto &entry : iter.NextBatch(5)) {
+      slots.push_back(entry.second.GetSlotNum());
+    }
+  }
+  ASSERT_EQ(EvenKeys(10, 300), slots);
+  ASSERT_TRUE(iter.NextBatch(5).empty());
+}
+
+// Returns the slots of the entries from iter to the end, stepping one at a time.
+auto ScanSteps(Tree *tree, Iterator iter) -> std::vector<int64_t> {
+  std::vector<int64_t> slots;
+  for (; iter != tree->End(); ++iter) {
+    slots.push_back((*iter).second.GetSlotNum());
+  }
+  return slots;
+}
+
+// Checks reverse scans of a tree holding exactly the given keys.
+void CheckReverseScans(Tree *tree, std::vector<int64_t> keys) {
+  std::sort(keys.rbegin(), keys.rend());
+  ASSERT_EQ(keys, ScanSteps(tree, tree->RBegin()));
+  for (size_t n : {1, 3, 1000}) {
+    ASSERT_EQ(keys, ScanBatches(tree->RBegin(), n));
+  }
+  int64_t max_key = keys.empty() ? 0 : keys.front();
+  for (int64_t upper = -1; upper <= max_key + 1; upper += 13) {
+    std::vector<int64_t> expected;
+    std::copy_if(keys.begin(), keys.end(), std::back_inserter(expected), [&](int64_t key) { return key <= upper; });
+    ASSERT_EQ(expected, ScanSteps(tree, tree->RBegin(IntegerKey(upper))));
+    ASSERT_EQ(expected, ScanBatches(tree->RBegin(IntegerKey(upper)), 4));
+  }
+}
+
+TEST(BPlusTreeScanTest, BatchScanTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", page_id, bpm, comparator, 8, 8);
+
+  ASSERT_TRUE(tree.Begin().NextBatch(10).empty());
+  InsertEvenKeys(&tree, 500);
+  CheckScans(&tree, 500);
+
+  bpm->UnpinPage(page_id, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeScanTest, ReverseScanTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  for (bool blink : {false, true}) {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto *bpm = new BufferPoolManager(50, disk_manager.get());
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    Tree tree("foo_pk", page_id, bpm, comparator, 8, 8);
+    tree.SetBLink(blink);
+
+    ASSERT_TRUE(tree.RBegin() == tree.End());
+    InsertEvenKeys(&tree, 500);
+    CheckReverseScans(&tree, EvenKeys(0, 998));
+
+    // Remove runs of keys long enough to leave leaves empty in B-link mode, which does not merge them.
+    std::vector<int64_t> keys;
+    for (auto key : EvenKeys(0, 998)) {
+      if (key % 200 < 100 || key >= 900) {
+        keys.push_back(key);
+      } else {
+        tree.Remove(IntegerKey(key), nullptr);
+      }
+    }
+    CheckReverseScans(&tree, keys);
+
+    bpm->UnpinPage(page_id, true);
+    delete bpm;
+  }
+}
+
+TEST(BPlusTreeScanTest, BLinkBatchScanTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", page_id, bpm, comparator, 8, 8);
+  tree.SetBLink(true);
+
+  InsertEvenKeys(&tree, 500);
+  CheckScans(&tree, 500);
+
+  // Leaves that split under a scan still yield each entry once, in order.
+  auto iter = tree.Begin();
+  std::vector<int64_t> slots;
+  for (auto batch = iter.NextBatch(3); !batch.empty(); batch = iter.NextBatch(3)) {
+    for (const auto &entry : batch) {
+      slots.push_back(entry.second.GetSlotNum());
+    }
+    int64_t odd_key = batch.back().second.GetSlotNum() + 101;
+    tree.Insert(IntegerKey(odd_key), RID(0, odd_key));
+  }
+  ASSERT_TRUE(std::is_sorted(slots.begin(), slots.end()));
+  ASSERT_TRUE(std::adjacent_find(slots.begin(), slots.end()) == slots.end());
+  ASSERT_EQ(0, slots.front());
+  ASSERT_LE(998, slots.back());
+
+  bpm->UnpinPage(page_id, true);
+  delete bpm;
+}
+
+}  // namespace bustub
@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_search_test.cpp
+//
+// Identification: test/storage/b_plus_tree_search_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <random>
+#include <set>
+
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+
+// Fills a leaf and an internal page with the keys, and checks that searching them by integer codes finds what the
+// comparator does, for each probe.
+void CheckSearch(Schema *key_schema, const std::vector<std::vector<Value>> &keys,
+                 const std::vector<std::vector<Value>> &probes) {
+  GenericComparator<8> comparator(key_schema);
+  GenericComparator<8> generic_comparator(key_schema);
+  generic_comparator.SetIntegerSearch(false);
+  ASSERT_TRUE(comparator.HasIntegerCodes());
+  ASSERT_FALSE(generic_comparator.HasIntegerCodes());
+
+  auto to_key = [&](const std::vector<Value> &values) {
+    GenericKey<8> key;
+    key.SetFromKey(Tuple(values, key_schema));
+    return key;
+  };
+  std::vector<GenericKey<8>> sorted;
+  for (const auto &values : keys) {
+    sorted.push_back(to_key(values));
+  }
+  std::sort(sorted.begin(), sorted.end(), [&](const auto &a, const auto &b) { return comparator(a, b) < 0; });
+
+  alignas(8) char leaf_data[BUSTUB_PAGE_SIZE];
+  alignas(8) char internal_data[BUSTUB_PAGE_SIZE];
+  auto leaf = reinterpret_cast<LeafPage *>(leaf_data);
+  auto internal = reinterpret_cast<InternalPage *>(internal_data);
+  leaf->Init();
+  internal->Init();
+  leaf->SetSize(sorted.size());
+  internal->SetSize(sorted.size());
+  for (size_t i = 0; i < sorted.size(); i++) {
+    leaf->SetKeyAt(i, sorted[i]);
+    leaf->SetValueAt(i, RID(0, i));
+    internal->SetKeyAt(i, sorted[i]);
+    internal->SetValueAt(i, i);
+  }
+
+  for (const auto &values : probes) {
+    auto probe = to_key(values);
+    RID rid;
+    RID expected_rid;
+    ASSERT_EQ(leaf->FindValue(probe, expected_rid, generic_comparator), leaf->FindValue(probe, rid, comparator));
+    ASSERT_EQ(expected_rid, rid);
+    page_id_t child;
+    page_id_t expected_child;
+    ASSERT_EQ(internal->FindValue(probe, expected_child, generic_comparator),
+              internal->FindValue(probe, child, comparator));
+    ASSERT_EQ(expected_child, child);
+  }
+}
+
+TEST(BPlusTreeSearchTest, BigIntSearchTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int64_t> dis(-1000000, 1000000);
+  std::set<int64_t> values{BUSTUB_INT64_MIN, BUSTUB_INT64_MAX, -1, 0};
+  while (values.size() < 200) {
+    values.insert(dis(gen));
+  }
+  std::vector<std::vector<Value>> keys;
+  for (auto value : values) {
+    keys.push_back({ValueFactory::GetBigIntValue(value)});
+  }
+  std::vector<std::vector<Value>> probes = keys;
+  for (int i = 0; i < 1000; i++) {
+    probes.push_back({ValueFactory::GetBigIntValue(dis(gen))});
+  }
+  probes.push_back({ValueFactory::GetBigIntValue(BUSTUB_INT64_MIN)});
+  probes.push_back({ValueFactory::GetBigIntValue(BUSTUB_INT64_MAX)});
+
+  // Every size, so that the search ends on windows of each length.
+  for (size_t size = 1; size <= 40; size++) {
+    CheckSearch(key_schema.get(), std::vector<std::vector<Value>>(keys.begin(), keys.begin() + size), probes);
+  }
+  CheckSearch(key_schema.get(), keys, probes);
+}
+
+TEST(BPlusTreeSearchTest, CompositeSearchTest) {
+  auto key_schema = ParseCreateStatement("a integer,b smallint,c tinyint");
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int32_t> dis(-5, 5);
+  std::vector<std::vector<Value>> keys;
+  for (int32_t a = -3; a <= 3; a++) {
+    for (int16_t b = -3; b <= 3; b += 2) {
+      for (int8_t c = -1; c <= 1; c++) {
+        keys.push_back({ValueFactory::GetIntegerValue(a * 100000), ValueFactory::GetSmallIntValue(b),
+                        ValueFactory::GetTinyIntValue(c)});
+      }
+    }
+  }
+  std::vector<std::vector<Value>> probes;
+  for (int i = 0; i < 1000; i++) {
+    probes.push_back({ValueFactory::GetIntegerValue(dis(gen) * 100000), ValueFactory::GetSmallIntValue(dis(gen)),
+                      ValueFactory::GetTinyIntValue(dis(gen))});
+  }
+  CheckSearch(key_schema.get(), keys, probes);
+}
+
+TEST(BPlusTreeSearchTest, NonIntegerKeysTest) {
+  auto key_schema = ParseCreateStatement("a bigint,b integer");
+  ASSERT_FALSE(GenericComparator<16>(key_schema.get()).HasIntegerCodes());
+  key_schema = ParseCreateStatement("a varchar");
+  ASSERT_FALSE(GenericComparator<8>(key_schema.get()).HasIntegerCodes());
+}
+
+}  // namespace bustub
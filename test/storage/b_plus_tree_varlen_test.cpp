@@ -0,0 +1,252 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_varlen_test.cpp
+//
+// Identification: test/storage/b_plus_tree_varlen_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using VarlenTree = BPlusTree<GenericKey<64>, RID, SerializedComparator<64>>;
+using VarlenLeafPage = BPlusTreeLeafPage<GenericKey<64>, RID, SerializedComparator<64>>;
+using VarlenInternalPage = BPlusTreeInternalPage<GenericKey<64>, page_id_t, SerializedComparator<64>>;
+using PlainTree = BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+
+auto StringKey(Schema *key_schema, const std::string &value) -> GenericKey<64> {
+  GenericKey<64> key;
+  key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(value)}, key_schema));
+  return key;
+}
+
+// Returns count distinct strings of 4 to 24 lowercase letters, sorted.
+auto RandomStrings(size_t count) -> std::vector<std::string> {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> length_dis(4, 24);
+  std::uniform_int_distribution<int> char_dis('a', 'z');
+  std::set<std::string> strings;
+  while (strings.size() < count) {
+    std::string value(length_dis(gen), ' ');
+    for (auto &c : value) {
+      c = static_cast<char>(char_dis(gen));
+    }
+    strings.insert(value);
+  }
+  return {strings.begin(), strings.end()};
+}
+
+// Returns the number of leaves of a tree.
+auto NumLeaves(BufferPoolManager *bpm, page_id_t root_page_id) -> int {
+  auto guard = bpm->FetchPageRead(root_page_id);
+  while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+    guard = bpm->FetchPageRead(guard.As<VarlenInternalPage>()->ValueAt(0));
+  }
+  int num_leaves = 1;
+  while (guard.As<VarlenLeafPage>()->GetNextPageId() != INVALID_PAGE_ID) {
+    guard = bpm->FetchPageRead(guard.As<VarlenLeafPage>()->GetNextPageId());
+    num_leaves++;
+  }
+  return num_leaves;
+}
+
+TEST(BPlusTreeVarlenTest, SerializedComparatorTest) {
+  auto key_schema = ParseCreateStatement("a varchar,b integer,c varchar");
+  SerializedComparator<64> comparator(key_schema.get());
+  GenericComparator<64> generic_comparator(key_schema.get());
+
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> int_dis(-3, 3);
+  std::uniform_int_distribution<int> string_dis(0, 5);
+  const std::vector<std::string> strings{"", "a", "ab", "abc", "b", "ba"};
+  std::vector<GenericKey<64>> keys;
+  for (int i = 0; i < 300; i++) {
+    GenericKey<64> key;
+    key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(strings[string_dis(gen)]),
+                          ValueFactory::GetIntegerValue(int_dis(gen)),
+                          ValueFactory::GetVarcharValue(strings[string_dis(gen)])},
+                         key_schema.get()));
+    keys.push_back(key);
+  }
+
+  // Both comparators order the keys the same way, and the separators of adjacent keys fall between them.
+  for (const auto &lhs : keys) {
+    for (const auto &rhs : keys) {
+      ASSERT_EQ(generic_comparator(lhs, rhs), comparator(lhs, rhs));
+      if (comparator(lhs, rhs) < 0) {
+        auto separator = comparator.ShortestSeparator(lhs, rhs);
+        ASSERT_LT(comparator(lhs, separator), 0);
+        ASSERT_LE(comparator(separator, rhs), 0);
+      }
+    }
+  }
+
+  // A string stored last is cut down to one byte past what it shares with the key below it.
+  key_schema = ParseCreateStatement("a varchar");
+  SerializedComparator<64> string_comparator(key_schema.get());
+  auto separator = string_comparator.ShortestSeparator(StringKey(key_schema.get(), "apple"),
+                                                       StringKey(key_schema.get(), "apricot"));
+  ASSERT_EQ(0, string_comparator(StringKey(key_schema.get(), "apr"), separator));
+  ASSERT_EQ(StringKey(key_schema.get(), "apr").ToValue(key_schema.get(), 0).ToString(),
+            separator.ToValue(key_schema.get(), 0).ToString());
+
+  // Strings cut short by the end of the key compare by the bytes that fit.
+  std::string long_string(100, 'x');
+  auto long_key = StringKey(key_schema.get(), long_string);
+  ASSERT_EQ(0, string_comparator(long_key, StringKey(key_schema.get(), long_string + "y")));
+  ASSERT_LT(string_comparator(StringKey(key_schema.get(), "x"), long_key), 0);
+}
+
+TEST(BPlusTreeVarlenTest, VariableLengthKeysTest) {
+  auto key_schema = ParseCreateStatement("a varchar");
+  SerializedComparator<64> comparator(key_schema.get());
+  GenericComparator<64> generic_comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(100, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  VarlenTree tree("foo_pk", page_id, bpm, comparator, VarlenLeafPage::VARIABLE_LENGTH_MAX_SIZE,
+                  VarlenInternalPage::VARIABLE_LENGTH_MAX_SIZE);
+  tree.SetVariableLengthKeys(true);
+  page_id_t plain_page_id;
+  bpm->NewPage(&plain_page_id);
+  PlainTree plain_tree("bar_pk", plain_page_id, bpm, generic_comparator);
+
+  const auto strings = RandomStrings(5000);
+  std::vector<size_t> order(strings.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), std::mt19937(42));
+  for (auto i : order) {
+    ASSERT_TRUE(tree.Insert(StringKey(key_schema.get(), strings[i]), RID(0, i)));
+    ASSERT_TRUE(plain_tree.Insert(StringKey(key_schema.get(), strings[i]), RID(0, i)));
+  }
+  ASSERT_FALSE(tree.Insert(StringKey(key_schema.get(), strings[0]), RID(0, 0)));
+
+  // Short strings leave most of each key empty, which pages with variable-length keys do not store.
+  ASSERT_LT(NumLeaves(bpm, tree.GetRootPageId()) * 3, NumLeaves(bpm, plain_tree.GetRootPageId()) * 2);
+
+  std::vector<RID> result;
+  for (size_t i = 0; i < strings.size(); i++) {
+    result.clear();
+    ASSERT_TRUE(tree.GetValue(StringKey(key_schema.get(), strings[i]), &result));
+    ASSERT_EQ(i, result[0].GetSlotNum());
+  }
+  ASSERT_FALSE(tree.GetValue(StringKey(key_schema.get(), "0"), &result));
+
+  // Remove every other key, which merges leaves, and put them back with keys of other lengths in between.
+  int num_leaves = NumLeaves(bpm, tree.GetRootPageId());
+  for (size_t i = 0; i < strings.size(); i += 2) {
+    tree.Remove(StringKey(key_schema.get(), strings[i]), nullptr);
+  }
+  ASSERT_LT(NumLeaves(bpm, tree.GetRootPageId()), num_leaves);
+  size_t expected = 1;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ(expected, (*iter).second.GetSlotNum());
+    expected += 2;
+  }
+  ASSERT_EQ(strings.size() + 1, expected);
+  for (size_t i = 0; i < strings.size(); i += 2) {
+    ASSERT_TRUE(tree.Insert(StringKey(key_schema.get(), strings[i]), RID(0, i)));
+    ASSERT_TRUE(tree.Insert(StringKey(key_schema.get(), strings[i] + std::string(30, 'a')), RID(1, i)));
+  }
+  std::vector<std::string> values;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    values.push_back((*iter).first.ToValue(key_schema.get(), 0).ToString());
+  }
+  ASSERT_EQ(strings.size() * 3 / 2, values.size());
+  ASSERT_TRUE(std::is_sorted(values.begin(), values.end()));
+
+  bpm->UnpinPage(page_id, true);
+  bpm->UnpinPage(plain_page_id, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeVarlenTest, BLinkVariableLengthKeysTest) {
+  auto key_schema = ParseCreateStatement("a varchar");
+  SerializedComparator<64> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(100, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  VarlenTree tree("foo_pk", page_id, bpm, comparator, VarlenLeafPage::VARIABLE_LENGTH_MAX_SIZE,
+                  VarlenInternalPage::VARIABLE_LENGTH_MAX_SIZE);
+  tree.SetBLink(true);
+  tree.SetVariableLengthKeys(true);
+
+  const auto strings = RandomStrings(5000);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; t++) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = t; i < strings.size(); i += 4) {
+        tree.Insert(StringKey(key_schema.get(), strings[i]), RID(0, i));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  size_t expected = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ(expected, (*iter).second.GetSlotNum());
+    expected++;
+  }
+  ASSERT_EQ(strings.size(), expected);
+
+  bpm->UnpinPage(page_id, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeVarlenTest, VarcharIndexTest) {
+  auto schema = ParseCreateStatement("a varchar,b integer");
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(100, disk_manager.get());
+
+  BPlusTreeIndexForVarcharColumns index(std::make_unique<IndexMetadata>("foo_pk", "foo", schema.get(),
+                                                                        std::vector<uint32_t>{0}),
+                                        bpm);
+  auto key_schema = index.GetKeySchema();
+  const auto strings = RandomStrings(1000);
+  size_t next = 0;
+  index.BulkLoad([&](Tuple *key, RID *rid) {
+    if (next == strings.size()) {
+      return false;
+    }
+    *key = Tuple({ValueFactory::GetVarcharValue(strings[next])}, key_schema);
+    *rid = RID(0, next++);
+    return true;
+  });
+  for (size_t i = 0; i < strings.size(); i++) {
+    std::vector<RID> result;
+    index.ScanKey(Tuple({ValueFactory::GetVarcharValue(strings[i])}, key_schema), &result, nullptr);
+    ASSERT_EQ(1U, result.size());
+    ASSERT_EQ(i, result[0].GetSlotNum());
+  }
+  ASSERT_TRUE(index.InsertEntry(Tuple({ValueFactory::GetVarcharValue("0")}, key_schema), RID(1, 0), nullptr));
+  ASSERT_EQ(RID(1, 0), (*index.GetBeginIterator()).second);
+
+  delete bpm;
+}
+
+}  // namespace bustub
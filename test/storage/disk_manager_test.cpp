@@ -10,11 +10,21 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstring>
+#include <future>  // NOLINT
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
+#include "storage/disk/async_disk_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/mmap_disk_manager.h"
 
 namespace bustub {
 
@@ -24,12 +34,14 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
   };
 };
 
@@ -72,6 +84,224 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AsyncReadWritePageTest) {
+  const size_t num_pages = 100;
+  for (int mode = 0; mode < 4; ++mode) {
+    bool use_io_uring = (mode & 1) != 0;
+    bool direct_io = (mode & 2) != 0;
+    std::string db_file("test.db");
+    auto dm = AsyncDiskManager(db_file, 8, use_io_uring, direct_io);
+    if (!use_io_uring) {
+      EXPECT_FALSE(dm.UsesIoUring());
+    }
+    if (!direct_io) {
+      EXPECT_FALSE(dm.UsesDirectIO());
+    }
+
+    char buf[BUSTUB_PAGE_SIZE] = {0};
+    dm.ReadPage(0, buf);  // tolerate empty read
+    EXPECT_EQ(0, buf[0]);
+
+    // Many more writes than the queue depth, all in flight together.
+    std::vector<std::vector<char>> pages(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+    std::vector<std::future<void>> writes;
+    for (size_t i = 0; i < num_pages; ++i) {
+      snprintf(pages[i].data(), BUSTUB_PAGE_SIZE, "page %zu", i);
+      writes.push_back(dm.WritePageAsync(static_cast<page_id_t>(i), pages[i].data()));
+    }
+    for (auto &write : writes) {
+      write.wait();
+    }
+    EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+    std::vector<std::vector<char>> reads(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+    std::atomic<size_t> num_done{0};
+    for (size_t i = 0; i < num_pages; ++i) {
+      dm.ReadPageAsync(static_cast<page_id_t>(i), reads[i].data(), [&num_done] { num_done++; });
+    }
+    while (num_done < num_pages) {
+      std::this_thread::yield();
+    }
+    for (size_t i = 0; i < num_pages; ++i) {
+      EXPECT_EQ(0, std::memcmp(pages[i].data(), reads[i].data(), BUSTUB_PAGE_SIZE));
+    }
+
+    dm.ShutDown();
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WritePagesTest) {
+  const size_t num_pages = 10;
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<const char *> pages_data;
+  for (size_t i = 0; i < num_pages; ++i) {
+    snprintf(pages[i].data(), BUSTUB_PAGE_SIZE, "page %zu", i + 2);
+    pages_data.push_back(pages[i].data());
+  }
+  std::string db_file("test.db");
+  for (int mode = 0; mode < 4; ++mode) {
+    std::unique_ptr<DiskManager> dm;
+    if (mode == 0) {
+      dm = std::make_unique<DiskManager>(db_file);
+    } else if (mode < 3) {
+      // The vectors are not page aligned, so with O_DIRECT the pages are written one by one.
+      dm = std::make_unique<AsyncDiskManager>(db_file, 8, true, mode == 2);
+    } else {
+      dm = std::make_unique<DiskManagerMemory>(2 + num_pages);
+    }
+
+    // The run of pages 2..11 is written in one call, unless each page needs a bounce buffer or the disk manager
+    // writes the pages one by one.
+    size_t calls = dm->WritePages(2, pages_data);
+    auto *async_dm = dynamic_cast<AsyncDiskManager *>(dm.get());
+    bool one_by_one = mode == 3 || (async_dm != nullptr && async_dm->UsesDirectIO());
+    EXPECT_EQ(one_by_one ? num_pages : 1, calls);
+    EXPECT_EQ(num_pages, dm->GetNumWrites());
+    EXPECT_EQ(0, dm->WritePages(0, {}));
+
+    char buf[BUSTUB_PAGE_SIZE] = {0};
+    for (size_t i = 0; i < num_pages; ++i) {
+      dm->ReadPage(static_cast<page_id_t>(i + 2), buf);
+      EXPECT_EQ(0, std::memcmp(pages[i].data(), buf, BUSTUB_PAGE_SIZE));
+    }
+
+    dm->ShutDown();
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, MmapReadPageTest) {
+  const size_t num_pages = 2 * MMAP_SCAN_READAHEAD + 3;
+  std::string db_file("test.db");
+  EXPECT_THROW(MmapDiskManager(db_file, true), Exception);
+
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  {
+    auto dm = DiskManager(db_file);
+    for (size_t i = 0; i < num_pages; ++i) {
+      snprintf(data, BUSTUB_PAGE_SIZE, "page %zu", i);
+      dm.WritePage(static_cast<page_id_t>(i), data);
+    }
+    dm.ShutDown();
+  }
+
+  // Scenario: a read-only replica reads the pages out of the mapping, whatever the access type.
+  {
+    auto dm = MmapDiskManager(db_file);
+    EXPECT_TRUE(dm.IsReadOnly());
+    for (size_t i = 0; i < num_pages; ++i) {
+      auto page_id = static_cast<page_id_t>(i);
+      dm.AdviseAccess(page_id, i % 2 == 0 ? AccessType::Scan : AccessType::Get);
+      dm.ReadPage(page_id, buf);
+      EXPECT_EQ(std::string("page ") + std::to_string(i), std::string(buf));
+    }
+    dm.ReadPage(static_cast<page_id_t>(num_pages), buf);  // past the end of the file
+    EXPECT_EQ(0, buf[0]);
+    EXPECT_THROW(dm.WritePage(0, data), Exception);
+    EXPECT_EQ(static_cast<page_id_t>(num_pages), dm.AllocatePage());
+  }
+
+  // Scenario: in read-write mode, the mapping follows the file as it grows.
+  auto dm = MmapDiskManager(db_file, false);
+  auto page_id = dm.AllocatePage();
+  EXPECT_EQ(static_cast<page_id_t>(num_pages), page_id);
+  strncpy(data, "new page", BUSTUB_PAGE_SIZE);
+  dm.WritePage(page_id, data);
+  dm.WritePage(0, data);
+  dm.ReadPage(page_id, buf);
+  EXPECT_EQ(0, std::memcmp(data, buf, BUSTUB_PAGE_SIZE));
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(0, std::memcmp(data, buf, BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(2, dm.GetNumWrites());
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DeviceModelTest) {
+  auto model = DeviceModel::FromString("read=80,write=20,read-stddev=40,bandwidth=2000,queue-depth=32");
+  EXPECT_EQ(80, model.read_.mean_.count());
+  EXPECT_EQ(40, model.read_.stddev_.count());
+  EXPECT_EQ(20, model.write_.mean_.count());
+  EXPECT_EQ(0, model.write_.stddev_.count());
+  EXPECT_EQ(2000UL * 1000 * 1000, model.bandwidth_);
+  EXPECT_EQ(32, model.queue_depth_);
+  EXPECT_THROW(DeviceModel::FromString("read=fast"), Exception);
+  EXPECT_THROW(DeviceModel::FromString("seek=10"), Exception);
+
+  DiskManagerUnlimitedMemory dm;
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  dm.WritePage(0, data);
+  auto time_reads = [&](size_t num_threads, size_t reads_per_thread) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_threads; ++i) {
+      threads.emplace_back([&] {
+        char buf[BUSTUB_PAGE_SIZE];
+        for (size_t j = 0; j < reads_per_thread; ++j) {
+          dm.ReadPage(0, buf);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    return std::chrono::steady_clock::now() - start;
+  };
+
+  // Scenario: with a queue depth of one, concurrent reads are served one after the other.
+  dm.SetDeviceModel(DeviceModel::FromString("read=5000,queue-depth=1"));
+  EXPECT_GE(time_reads(4, 2), std::chrono::milliseconds(40));
+
+  // Scenario: writes have their own cost.
+  dm.SetDeviceModel(DeviceModel::FromString("write=20000"));
+  auto start = std::chrono::steady_clock::now();
+  dm.WritePage(0, data);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+  EXPECT_LT(time_reads(1, 100), std::chrono::milliseconds(20));
+
+  // Scenario: the bandwidth caps concurrent reads too; 4 MB/s is about 1ms per page.
+  dm.SetDeviceModel(DeviceModel::FromString("bandwidth=4"));
+  EXPECT_GE(time_reads(4, 5), std::chrono::milliseconds(20));
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreeSpaceTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  {
+    auto dm = DiskManager(db_file);
+    for (page_id_t i = 0; i < 5; ++i) {
+      EXPECT_EQ(i, dm.AllocatePage());
+      dm.WritePage(i, data);
+    }
+    dm.DeallocatePage(3);
+    dm.DeallocatePage(1);
+    dm.DeallocatePage(1);
+    EXPECT_EQ(2, dm.GetNumFreePages());
+
+    // Freed pages are reused lowest first, before the file grows.
+    EXPECT_EQ(1, dm.AllocatePage());
+    dm.DeallocatePage(1);
+    dm.ShutDown();
+  }
+
+  // The free pages are recovered on restart.
+  auto dm = DiskManager(db_file);
+  EXPECT_EQ(2, dm.GetNumFreePages());
+  EXPECT_EQ(1, dm.AllocatePage());
+  EXPECT_EQ(3, dm.AllocatePage());
+  EXPECT_EQ(5, dm.AllocatePage());
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
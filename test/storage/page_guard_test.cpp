@@ -10,9 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
 
 #include "buffer/buffer_pool_manager.h"
 #include "storage/disk/disk_manager_memory.h"
@@ -48,4 +50,80 @@ TEST(PageGuardTest, DISABLED_SampleTest) {
   disk_manager->ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST(PageGuardTest, OptimisticReadTest) {
+  const size_t buffer_pool_size = 5;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_shared<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  page_id_t page_id;
+  {
+    auto guard = bpm->NewPageGuarded(&page_id);
+    snprintf(guard.GetDataMut(), BUSTUB_PAGE_SIZE, "version 0");
+  }
+
+  // Scenario: the guard pins the page without latching it, so a writer can still get in, and readers sharing the page
+  // validate as long as no writer did.
+  auto reader = bpm->FetchPageOptimistic(page_id);
+  auto other_reader = bpm->FetchPageOptimistic(page_id);
+  EXPECT_EQ(std::string("version 0"), std::string(reader.GetData()));
+  EXPECT_TRUE(reader.Validate());
+  EXPECT_TRUE(other_reader.Validate());
+  {
+    auto read_guard = bpm->FetchPageRead(page_id);
+    EXPECT_TRUE(reader.Validate());
+  }
+  {
+    auto writer = bpm->FetchPageWrite(page_id);
+    snprintf(writer.GetDataMut(), BUSTUB_PAGE_SIZE, "version 1");
+    EXPECT_FALSE(reader.Validate());
+  }
+  EXPECT_FALSE(reader.Validate());
+
+  // Scenario: a new guard sees the new content; moving it keeps its snapshot.
+  reader = bpm->FetchPageOptimistic(page_id);
+  EXPECT_EQ(std::string("version 1"), std::string(reader.GetData()));
+  auto moved = std::move(reader);
+  EXPECT_TRUE(moved.Validate());
+  EXPECT_FALSE(reader.Validate());
+
+  // Scenario: a guard created while a writer holds the page waits for it to finish.
+  std::thread writer_thread;
+  {
+    auto writer = bpm->FetchPageWrite(page_id);
+    writer_thread = std::thread([&] {
+      auto guard = bpm->FetchPageOptimistic(page_id);
+      EXPECT_EQ(std::string("version 2"), std::string(guard.GetData()));
+      EXPECT_TRUE(guard.Validate());
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    snprintf(writer.GetDataMut(), BUSTUB_PAGE_SIZE, "version 2");
+  }
+  writer_thread.join();
+
+  // Scenario: upgrading to a write guard succeeds only if no writer got in since the snapshot.
+  auto stale = bpm->FetchPageOptimistic(page_id);
+  auto fresh = bpm->FetchPageOptimistic(page_id);
+  {
+    auto writer = fresh.UpgradeWrite();
+    ASSERT_TRUE(writer.has_value());
+    snprintf(writer->GetDataMut(), BUSTUB_PAGE_SIZE, "version 3");
+  }
+  EXPECT_FALSE(fresh.Validate());
+  EXPECT_FALSE(stale.UpgradeWrite().has_value());
+  EXPECT_FALSE(stale.Validate());
+  EXPECT_EQ(std::string("version 3"), std::string(bpm->FetchPageRead(page_id).GetData()));
+
+  // Scenario: optimistic guards pin the page like the other guards do.
+  moved.Drop();
+  other_reader.Drop();
+  auto *page = bpm->FetchPageIfResident(page_id);
+  EXPECT_EQ(1, page->GetPinCount());
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  disk_manager->ShutDown();
+}
+
 }  // namespace bustub
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <memory>
@@ -12,8 +14,13 @@
 
 #include "argparse/argparse.hpp"
 #include "binder/binder.h"
+#include "buffer/arc_replacer.h"
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/clock_pro_replacer.h"
+#include "buffer/clock_replacer.h"
 #include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/two_queue_replacer.h"
 #include "common/config.h"
 #include "common/exception.h"
 #include "common/util/string_util.h"
@@ -100,16 +107,54 @@ struct BpmMetrics {
   }
 };
 
+/** Counts page reads, i.e. buffer pool misses, to report the hit rate of the replacement policy. */
+class CountingDiskManager : public bustub::DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(bustub::page_id_t page_id, char *page_data) override {
+    reads_++;
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  std::atomic<uint64_t> reads_{0};
+};
+
+auto MakeReplacerFactory(const std::string &name) -> bustub::ReplacerFactory {
+  if (name == "lru-k") {
+    return [](size_t num_frames) { return std::make_unique<bustub::LRUKReplacer>(num_frames, LRU_K_SIZE); };
+  }
+  if (name == "lru") {
+    return [](size_t num_frames) { return std::make_unique<bustub::LRUReplacer>(num_frames); };
+  }
+  if (name == "clock") {
+    return [](size_t num_frames) { return std::make_unique<bustub::ClockReplacer>(num_frames); };
+  }
+  if (name == "arc") {
+    return [](size_t num_frames) { return std::make_unique<bustub::ARCReplacer>(num_frames); };
+  }
+  if (name == "2q") {
+    return [](size_t num_frames) { return std::make_unique<bustub::TwoQueueReplacer>(num_frames); };
+  }
+  if (name == "clock-pro") {
+    return [](size_t num_frames) { return std::make_unique<bustub::ClockProReplacer>(num_frames); };
+  }
+  throw std::runtime_error("unknown replacer " + name);
+}
+
 // NOLINTNEXTLINE
 auto main(int argc, char **argv) -> int {
   using bustub::AccessType;
   using bustub::BufferPoolManager;
-  using bustub::DiskManagerUnlimitedMemory;
   using bustub::page_id_t;
 
   argparse::ArgumentParser program("bustub-bpm-bench");
   program.add_argument("--duration").help("run bpm bench for n milliseconds");
   program.add_argument("--latency").help("set disk latency to n milliseconds");
+  program.add_argument("--device").help(
+      "simulate a device, e.g. read=80,write=20,read-stddev=40,bandwidth=2000,queue-depth=32 (us, MB/s)");
+  program.add_argument("--shards").help("partition the buffer pool into n latched shards (1 = single latch)");
+  program.add_argument("--bpm-size").help("number of frames in the buffer pool (up to 1M)");
+  program.add_argument("--replacer").help("replacement policy: lru-k (default), lru, clock, arc, 2q, clock-pro");
+  program.add_argument("--page-cnt").help("number of pages in the working set (default: max(6400, 2 * bpm-size))");
 
   try {
     program.parse_args(argc, argv);
@@ -129,14 +174,44 @@ auto main(int argc, char **argv) -> int {
     latency_ms = std::stoi(program.get("--latency"));
   }
 
-  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+  size_t num_shards = 1;
+  if (program.present("--shards")) {
+    num_shards = std::stoi(program.get("--shards"));
+  }
+
+  size_t bpm_size = BUSTUB_BPM_SIZE;
+  if (program.present("--bpm-size")) {
+    bpm_size = std::stoul(program.get("--bpm-size"));
+  }
+
+  size_t page_cnt = std::max(BUSTUB_PAGE_CNT, 2 * bpm_size);
+  if (program.present("--page-cnt")) {
+    page_cnt = std::stoul(program.get("--page-cnt"));
+  }
+
+  bustub::DeviceModel device;
+  device.read_.mean_ = std::chrono::milliseconds(latency_ms);
+  device.write_.mean_ = device.read_.mean_;
+  if (program.present("--device")) {
+    device = bustub::DeviceModel::FromString(program.get("--device"));
+  }
+
+  std::string replacer = "lru-k";
+  if (program.present("--replacer")) {
+    replacer = program.get("--replacer");
+  }
+
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(bpm_size, disk_manager.get(), MakeReplacerFactory(replacer), nullptr,
+                                                 num_shards);
   std::vector<page_id_t> page_ids;
 
-  fmt::print(stderr, "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}\n",
-             BUSTUB_PAGE_CNT, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  fmt::print(stderr,
+             "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}, shards={}, "
+             "replacer={}\n",
+             page_cnt, duration_ms, latency_ms, LRU_K_SIZE, bpm_size, bpm->GetNumShards(), replacer);
 
-  for (size_t i = 0; i < BUSTUB_PAGE_CNT; i++) {
+  for (size_t i = 0; i < page_cnt; i++) {
     page_id_t page_id;
     auto *page = bpm->NewPage(&page_id);
     if (page == nullptr) {
@@ -150,7 +225,9 @@ auto main(int argc, char **argv) -> int {
   }
 
   // enable disk latency after creating all pages
-  disk_manager->SetLatency(latency_ms);
+  disk_manager->SetDeviceModel(device);
+  disk_manager->reads_ = 0;
+  bpm->ResetStats();
 
   fmt::print(stderr, "[info] benchmark start\n");
 
@@ -160,11 +237,11 @@ auto main(int argc, char **argv) -> int {
   std::vector<std::thread> threads;
 
   for (size_t thread_id = 0; thread_id < BUSTUB_SCAN_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics] {
+    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, page_cnt, duration_ms, &total_metrics] {
       BpmMetrics metrics(fmt::format("scan {:>2}", thread_id), duration_ms);
       metrics.Begin();
 
-      size_t page_idx = BUSTUB_PAGE_CNT * thread_id / BUSTUB_SCAN_THREAD;
+      size_t page_idx = page_cnt * thread_id / BUSTUB_SCAN_THREAD;
 
       while (!metrics.ShouldFinish()) {
         auto *page = bpm->FetchPage(page_ids[page_idx], AccessType::Scan);
@@ -181,7 +258,7 @@ auto main(int argc, char **argv) -> int {
         page->WUnlatch();
 
         bpm->UnpinPage(page->GetPageId(), true, AccessType::Scan);
-        page_idx = (page_idx + 1) % BUSTUB_PAGE_CNT;
+        page_idx = (page_idx + 1) % page_cnt;
         metrics.Tick();
         metrics.Report();
       }
@@ -191,10 +268,10 @@ auto main(int argc, char **argv) -> int {
   }
 
   for (size_t thread_id = 0; thread_id < BUSTUB_GET_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics] {
+    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, page_cnt, duration_ms, &total_metrics] {
       std::random_device r;
       std::default_random_engine gen(r());
-      zipfian_int_distribution<size_t> dist(0, BUSTUB_PAGE_CNT - 1, 0.8);
+      zipfian_int_distribution<size_t> dist(0, page_cnt - 1, 0.8);
 
       BpmMetrics metrics(fmt::format("get  {:>2}", thread_id), duration_ms);
       metrics.Begin();
@@ -228,5 +305,11 @@ auto main(int argc, char **argv) -> int {
 
   total_metrics.Report();
 
+  uint64_t fetches = total_metrics.scan_cnt_ + total_metrics.get_cnt_;
+  uint64_t misses = disk_manager->reads_;
+  fmt::print(stderr, "[info] fetches={}, misses={}, hit_rate={:.4f}\n", fetches, misses,
+             fetches == 0 ? 0.0 : 1.0 - static_cast<double>(misses) / static_cast<double>(fetches));
+  fmt::print(stderr, "[info] buffer pool stats:\n{}", bpm->GetStats().ToString());
+
   return 0;
 }
@@ -119,6 +119,16 @@ auto main(int argc, char **argv) -> int {
 
   argparse::ArgumentParser program("bustub-btree-bench");
   program.add_argument("--duration").help("run btree bench for n milliseconds");
+  program.add_argument("--device").help(
+      "simulate a device, e.g. read=80,write=20,read-stddev=40,bandwidth=2000,queue-depth=32 (us, MB/s)");
+  program.add_argument("--pessimistic")
+      .help("latch every page on the way down instead of crabbing optimistically")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--blink")
+      .help("use the B-link protocol, where splits do not hold the parent")
+      .default_value(false)
+      .implicit_value(true);
 
   try {
     program.parse_args(argc, argv);
@@ -133,11 +143,16 @@ auto main(int argc, char **argv) -> int {
     duration_ms = std::stoi(program.get("--duration"));
   }
 
+  bustub::DeviceModel device;
+  if (program.present("--device")) {
+    device = bustub::DeviceModel::FromString(program.get("--device"));
+  }
+
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
   auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
 
-  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, lru_k_size={}, bpm_size={}\n", TOTAL_KEYS, duration_ms,
-             LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, lru_k_size={}, bpm_size={}, pessimistic={}\n", TOTAL_KEYS,
+             duration_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE, program.get<bool>("--pessimistic"));
 
   auto key_schema = bustub::ParseCreateStatement("a bigint");
   bustub::GenericComparator<8> comparator(key_schema.get());
@@ -147,6 +162,10 @@ auto main(int argc, char **argv) -> int {
 
   bustub::BPlusTree<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>> index("foo_pk", page_id,
                                                                                             bpm.get(), comparator);
+  bool pessimistic = program.get<bool>("--pessimistic");
+  index.SetOptimisticReads(!pessimistic);
+  index.SetOptimisticWrites(!pessimistic);
+  index.SetBLink(program.get<bool>("--blink"));
 
   for (size_t key = 0; key < TOTAL_KEYS; key++) {
     bustub::GenericKey<8> index_key;
@@ -157,6 +176,9 @@ auto main(int argc, char **argv) -> int {
     index.Insert(index_key, rid, nullptr);
   }
 
+  // enable the simulated device after loading the index
+  disk_manager->SetDeviceModel(device);
+
   fmt::print(stderr, "[info] benchmark start\n");
 
   BTreeTotalMetrics total_metrics;
@@ -0,0 +1,148 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/rid.h"
+#include "fmt/format.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/generic_key.h"
+#include "test_util.h"
+
+#include <sys/time.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+static const size_t BUSTUB_BPM_SIZE = 8192;
+static const size_t LOOKUP_BATCH = 1024;
+
+using LeafPage = bustub::BPlusTreeLeafPage<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>>;
+using Tree = bustub::BPlusTree<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>>;
+
+/** @return lookups per second of lookup(key), run for random keys below total_keys for duration_ms */
+template <typename Lookup>
+auto LookupsPerSec(size_t total_keys, uint64_t duration_ms, Lookup lookup) -> double {
+  std::default_random_engine gen(42);
+  std::uniform_int_distribution<int64_t> dis(0, total_keys - 1);
+  std::vector<bustub::GenericKey<8>> keys(LOOKUP_BATCH);
+  uint64_t cnt = 0;
+  auto start_time = ClockMs();
+  while (ClockMs() - start_time < duration_ms) {
+    // Draw a batch of keys before looking them up, so that the generator stays out of the lookups' way.
+    for (auto &key : keys) {
+      key.SetFromInteger(dis(gen));
+    }
+    for (const auto &key : keys) {
+      if (!lookup(key)) {
+        throw std::runtime_error(fmt::format("key not found: {}", key.ToString()));
+      }
+    }
+    cnt += LOOKUP_BATCH;
+  }
+  return cnt / static_cast<double>(ClockMs() - start_time) * 1000;
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  using bustub::BufferPoolManager;
+  using bustub::DiskManagerUnlimitedMemory;
+  using bustub::page_id_t;
+
+  argparse::ArgumentParser program("bustub-btree-search-bench");
+  program.add_argument("--duration").help("run each lookup for n milliseconds");
+  program.add_argument("--keys").help("number of keys in the tree");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  uint64_t duration_ms = 5000;
+  if (program.present("--duration")) {
+    duration_ms = std::stoi(program.get("--duration"));
+  }
+  size_t total_keys = 1000000;
+  if (program.present("--keys")) {
+    total_keys = std::stoi(program.get("--keys"));
+  }
+
+  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, bpm_size={}, avx2={}\n", total_keys, duration_ms,
+             BUSTUB_BPM_SIZE, bustub::HasAvx2());
+
+  auto key_schema = bustub::ParseCreateStatement("a bigint");
+  bustub::GenericComparator<8> integer_comparator(key_schema.get());
+  bustub::GenericComparator<8> generic_comparator(key_schema.get());
+  generic_comparator.SetIntegerSearch(false);
+
+  // A full leaf, searched on its own.
+  auto leaf_data = std::make_unique<char[]>(bustub::BUSTUB_PAGE_SIZE);
+  auto leaf = reinterpret_cast<LeafPage *>(leaf_data.get());
+  leaf->Init();
+  leaf->SetSize(leaf->GetMaxSize() - 1);
+  for (int i = 0; i < leaf->GetSize(); i++) {
+    bustub::GenericKey<8> key;
+    key.SetFromInteger(i);
+    leaf->SetKeyAt(i, key);
+    leaf->SetValueAt(i, bustub::RID(i, i));
+  }
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get());
+
+  // The same tree, searched through each comparator.
+  page_id_t page_id;
+  auto header_page = bpm->NewPageGuarded(&page_id);
+  Tree integer_index("foo_pk", page_id, bpm.get(), integer_comparator);
+  Tree generic_index("foo_pk", page_id, bpm.get(), generic_comparator);
+  for (size_t key = 0; key < total_keys; key++) {
+    bustub::GenericKey<8> index_key;
+    bustub::RID rid;
+    uint32_t value = key;
+    rid.Set(value, value);
+    index_key.SetFromInteger(key);
+    integer_index.Insert(index_key, rid, nullptr);
+  }
+
+  fmt::print(stderr, "[info] benchmark start\n");
+
+  std::vector<std::pair<std::string, double>> results;
+  for (auto [name, comparator] : {std::make_pair("integer", &integer_comparator),
+                                  std::make_pair("generic", &generic_comparator)}) {
+    bustub::RID rid;
+    auto page_per_sec = LookupsPerSec(leaf->GetSize(), duration_ms, [&](const bustub::GenericKey<8> &key) {
+      return leaf->FindValue(key, rid, *comparator) != -1;
+    });
+    fmt::print(stderr, "[info] {} page lookups: {:.3f}/s\n", name, page_per_sec);
+    results.emplace_back(fmt::format("page_{}", name), page_per_sec);
+  }
+  std::vector<bustub::RID> rids;
+  for (auto [name, index] : {std::make_pair("integer", &integer_index), std::make_pair("generic", &generic_index)}) {
+    auto tree_per_sec = LookupsPerSec(total_keys, duration_ms, [&](const bustub::GenericKey<8> &key) {
+      rids.clear();
+      return index->GetValue(key, &rids);
+    });
+    fmt::print(stderr, "[info] {} tree lookups: {:.3f}/s\n", name, tree_per_sec);
+    results.emplace_back(fmt::format("tree_{}", name), tree_per_sec);
+  }
+
+  fmt::print("<<< BEGIN\n");
+  for (const auto &[name, per_sec] : results) {
+    fmt::print("{}: {}\n", name, per_sec);
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}
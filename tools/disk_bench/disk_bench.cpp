@@ -0,0 +1,166 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/mmap_disk_manager.h"
+
+#include <sys/time.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+static const size_t BUSTUB_PAGE_CNT = 16384;
+static const size_t BUSTUB_READ_THREAD = 4;
+static const size_t BUSTUB_RANDOM_READ_CNT = 100000;
+
+/**
+ * Read every page once in order with each thread, the way a sequential scan misses the buffer pool, then read random
+ * pages, the way point lookups do. The access type reaches the disk manager through AdviseAccess(), as it does from
+ * the buffer pool. Returns pages read per second for both phases.
+ */
+auto RunBench(bustub::DiskManager *disk_manager, size_t page_cnt, size_t thread_cnt, size_t random_cnt)
+    -> std::pair<double, double> {
+  using bustub::AccessType;
+  using bustub::BUSTUB_PAGE_SIZE;
+  using bustub::page_id_t;
+
+  auto run_threads = [&](auto &&body) {
+    std::vector<std::thread> threads;
+    auto start = ClockMs();
+    for (size_t thread_id = 0; thread_id < thread_cnt; thread_id++) {
+      threads.emplace_back(body, thread_id);
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    return std::max<uint64_t>(ClockMs() - start, 1);
+  };
+
+  std::atomic<uint64_t> checksum{0};
+  auto scan_ms = run_threads([&](size_t thread_id) {
+    char data[BUSTUB_PAGE_SIZE];
+    uint64_t sum = 0;
+    for (size_t i = 0; i < page_cnt; i++) {
+      auto page_id = static_cast<page_id_t>((i + page_cnt * thread_id / thread_cnt) % page_cnt);
+      disk_manager->AdviseAccess(page_id, AccessType::Scan);
+      disk_manager->ReadPage(page_id, data);
+      sum += data[page_id % 1024];
+    }
+    checksum += sum;
+  });
+
+  auto random_ms = run_threads([&](size_t thread_id) {
+    std::default_random_engine gen(thread_id);
+    std::uniform_int_distribution<page_id_t> dist(0, page_cnt - 1);
+    char data[BUSTUB_PAGE_SIZE];
+    uint64_t sum = 0;
+    for (size_t i = 0; i < random_cnt; i++) {
+      page_id_t page_id = dist(gen);
+      disk_manager->AdviseAccess(page_id, AccessType::Get);
+      disk_manager->ReadPage(page_id, data);
+      sum += data[page_id % 1024];
+    }
+    checksum += sum;
+  });
+
+  // Every page has a single 1 at a known offset, so each read adds exactly one to the checksum.
+  if (checksum != thread_cnt * (page_cnt + random_cnt)) {
+    fmt::print(stderr, "[warn] unexpected checksum {}\n", checksum.load());
+  }
+  return {static_cast<double>(thread_cnt * page_cnt) / static_cast<double>(scan_ms) * 1000,
+          static_cast<double>(thread_cnt * random_cnt) / static_cast<double>(random_ms) * 1000};
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  using bustub::BUSTUB_PAGE_SIZE;
+  using bustub::page_id_t;
+
+  argparse::ArgumentParser program("bustub-disk-bench");
+  program.add_argument("--db").help("database file to create for the benchmark (default: disk-bench.db)");
+  program.add_argument("--page-cnt").help("number of pages in the database file");
+  program.add_argument("--threads").help("number of reader threads");
+  program.add_argument("--random-cnt").help("number of random reads per thread");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  std::string db_file = "disk-bench.db";
+  if (program.present("--db")) {
+    db_file = program.get("--db");
+  }
+
+  size_t page_cnt = BUSTUB_PAGE_CNT;
+  if (program.present("--page-cnt")) {
+    page_cnt = std::stoul(program.get("--page-cnt"));
+  }
+
+  size_t thread_cnt = BUSTUB_READ_THREAD;
+  if (program.present("--threads")) {
+    thread_cnt = std::stoul(program.get("--threads"));
+  }
+
+  size_t random_cnt = BUSTUB_RANDOM_READ_CNT;
+  if (program.present("--random-cnt")) {
+    random_cnt = std::stoul(program.get("--random-cnt"));
+  }
+
+  fmt::print(stderr, "[info] db={}, total_page={}, threads={}, random_cnt={}\n", db_file, page_cnt, thread_cnt,
+             random_cnt);
+
+  // The same content goes to the file and to memory, one byte set per page for the checksum.
+  auto memory_disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  {
+    remove(db_file.c_str());
+    auto disk_manager = bustub::DiskManager(db_file);
+    char data[BUSTUB_PAGE_SIZE] = {0};
+    for (size_t i = 0; i < page_cnt; i++) {
+      auto page_id = static_cast<page_id_t>(i);
+      data[i % 1024] = 1;
+      disk_manager.WritePage(page_id, data);
+      memory_disk_manager->WritePage(page_id, data);
+      data[i % 1024] = 0;
+    }
+    disk_manager.ShutDown();
+  }
+
+  std::vector<std::pair<std::string, std::unique_ptr<bustub::DiskManager>>> backends;
+  backends.emplace_back("fstream", std::make_unique<bustub::DiskManager>(db_file));
+  backends.emplace_back("mmap", std::make_unique<bustub::MmapDiskManager>(db_file));
+  backends.emplace_back("memory", std::move(memory_disk_manager));
+
+  fmt::print("<<< BEGIN\n");
+  for (auto &[name, disk_manager] : backends) {
+    auto [scan_per_sec, get_per_sec] = RunBench(disk_manager.get(), page_cnt, thread_cnt, random_cnt);
+    fmt::print("{}: scan={:.0f} get={:.0f}\n", name, scan_per_sec, get_per_sec);
+  }
+  fmt::print(">>> END\n");
+
+  for (auto &[name, disk_manager] : backends) {
+    disk_manager->ShutDown();
+  }
+  std::string base = db_file.substr(0, db_file.rfind('.'));
+  remove(db_file.c_str());
+  remove((base + ".log").c_str());
+  remove((base + ".fsm").c_str());
+  return 0;
+}
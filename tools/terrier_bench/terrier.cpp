@@ -17,6 +17,7 @@
 #include "concurrency/transaction_manager.h"
 #include "fmt/core.h"
 #include "fmt/std.h"
+#include "storage/disk/disk_manager_memory.h"
 #include "terrier_bench_config.h"
 
 #include <sys/time.h>
@@ -141,6 +142,8 @@ auto main(int argc, char **argv) -> int {
   program.add_argument("--force-create-index").help("create index in terrier bench");
   program.add_argument("--force-enable-update").help("use update statement in terrier bench");
   program.add_argument("--nft").help("number of NFTs in the bench");
+  program.add_argument("--device").help(
+      "simulate a device, e.g. read=80,write=20,read-stddev=40,bandwidth=2000,queue-depth=32 (us, MB/s)");
 
   size_t bustub_nft_num = 10;
 
@@ -234,6 +237,14 @@ auto main(int argc, char **argv) -> int {
     }
   }
 
+  if (program.present("--device")) {
+    // enable the simulated device after initializing data
+    auto *disk_manager = dynamic_cast<bustub::DiskManagerUnlimitedMemory *>(bustub->disk_manager_);
+    BUSTUB_ENSURE(disk_manager != nullptr, "the bench instance is not in memory");
+    disk_manager->SetDeviceModel(bustub::DeviceModel::FromString(program.get("--device")));
+    std::cerr << "x: simulate device " << program.get("--device") << std::endl;
+  }
+
   std::cerr << "x: benchmark start" << std::endl;
 
   std::vector<std::thread> threads;